@@ -0,0 +1,82 @@
+//
+//  burst_injector.cc
+//  YCSB-C
+//
+
+#include "burst_injector.h"
+
+using std::string;
+
+namespace ycsbc {
+
+const string BurstInjector::BURST_COUNT_PROPERTY = "burstcount";
+const string BurstInjector::BURST_COUNT_DEFAULT = "0";
+
+const string BurstInjector::BURST_PROPERTY_PREFIX = "burst.";
+
+void BurstInjector::Init(const utils::Properties &p) {
+  size_t count = std::stoul(p.GetProperty(BURST_COUNT_PROPERTY,
+                                          BURST_COUNT_DEFAULT));
+  bursts_ = std::vector<Burst>(count);
+  armed_ = false;
+  first_start_ = UINT64_MAX;
+  last_end_ = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const string prefix = BURST_PROPERTY_PREFIX + std::to_string(i) + ".";
+    Burst &burst = bursts_[i];
+    burst.start = std::stoull(p.GetProperty(prefix + "start", "0"));
+    burst.ops = std::stoull(p.GetProperty(prefix + "ops", "0"));
+    burst.fraction = std::stod(p.GetProperty(prefix + "fraction", "0.1"));
+    if (burst.ops == 0 || !(burst.fraction > 0) || burst.fraction > 1) {
+      throw utils::Exception("Burst " + std::to_string(i) +
+          " needs ops > 0 and a fraction in (0, 1]");
+    }
+    const string key = p.GetProperty(prefix + "key", "new");
+    if (key == "new") {
+      burst.kind = kNewKey;
+    } else if (key == "cold") {
+      burst.kind = kColdKey;
+    } else {
+      burst.kind = kGivenKey;
+      burst.key_num = std::stoull(key);
+    }
+    first_start_ = std::min(first_start_, burst.start);
+    last_end_ = std::max(last_end_, burst.start + burst.ops);
+  }
+  clock_.store(0);
+  pending_.store(0);
+}
+
+void BurstInjector::SetKey(size_t i, uint64_t key_num, uint64_t key_id,
+                           const string &key_name) {
+  bursts_[i].key_num = key_num;
+  bursts_[i].key_id = key_id;
+  bursts_[i].key_name = key_name;
+}
+
+void BurstInjector::MarkDrawn(Burst &burst, uint64_t op) {
+  bool expected = false;
+  if (burst.drawn.compare_exchange_strong(expected, true,
+                                          std::memory_order_acq_rel)) {
+    burst.injected_op.store(op, std::memory_order_release);
+    pending_.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void BurstInjector::MarkInjected(Burst &burst) {
+  int64_t expected = 0;
+  if (burst.injected_ns.compare_exchange_strong(expected, NowNanos(),
+                                                std::memory_order_acq_rel)) {
+    pending_.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+const char *BurstInjector::KindName(KeyKind kind) {
+  switch (kind) {
+    case kNewKey: return "new";
+    case kColdKey: return "cold";
+    default: return "given";
+  }
+}
+
+} // ycsbc
@@ -0,0 +1,143 @@
+//
+//  burst_injector.h
+//  YCSB-C
+//
+//  Overlays hot-key bursts on the transaction keys of any workload: during
+//  a burst, a share of the drawn keys is replaced by one burst key, such as
+//  a key never loaded or a loaded key the base distribution rarely picks.
+//  The moment the first replaced key is issued to the DB is recorded so that
+//  hotspot identification can be scored by how long it takes to notice the
+//  key. Keys are drawn ahead of use in batches, so the draw itself is not
+//  that moment. keystats writes <workload>_burst_stats.csv with each
+//  separator's detection delay, in accesses and in microseconds.
+//
+
+#ifndef YCSB_C_BURST_INJECTOR_H_
+#define YCSB_C_BURST_INJECTOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "properties.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+class BurstInjector {
+ public:
+  ///
+  /// The name of the property for the number of bursts.
+  ///
+  static const std::string BURST_COUNT_PROPERTY;
+  static const std::string BURST_COUNT_DEFAULT;
+
+  ///
+  /// Per-burst properties are named "burst.<i>.<name>": "start" is the index
+  /// of the transaction key the burst begins at, "ops" the number of keys it
+  /// lasts, "fraction" the share of those keys it takes over, and "key" the
+  /// burst key: "new" (never loaded), "cold" (a loaded key the base
+  /// distribution did not draw in a sample) or an explicit key number.
+  ///
+  static const std::string BURST_PROPERTY_PREFIX;
+
+  enum KeyKind { kNewKey, kColdKey, kGivenKey };
+
+  struct Burst {
+    uint64_t start = 0;
+    uint64_t ops = 0;
+    double fraction = 0;
+    KeyKind kind = kNewKey;
+    uint64_t key_num = 0;
+    uint64_t key_id = 0;       /// What the DB sees in integer key mode
+    std::string key_name;      /// What the DB sees in string key mode
+    /// Set once, when the first key the burst replaces is drawn
+    std::atomic<bool> drawn{false};
+    std::atomic<uint64_t> injected_op{0};
+    /// Set once, when a client issues the burst key after it was drawn
+    std::atomic<int64_t> injected_ns{0};
+
+    bool injected() const {
+      return injected_ns.load(std::memory_order_acquire) != 0;
+    }
+  };
+
+  BurstInjector() : armed_(false), first_start_(0), last_end_(0), clock_(0),
+      pending_(0) { }
+
+  ///
+  /// Parses the burst properties. Burst keys are filled in by the workload
+  /// with SetKey(), after which Arm() starts counting transaction keys.
+  ///
+  void Init(const utils::Properties &p);
+  void SetKey(size_t i, uint64_t key_num, uint64_t key_id,
+              const std::string &key_name);
+  void Arm() { armed_ = !bursts_.empty(); }
+
+  ///
+  /// Replaces keys of bursts in progress among n freshly drawn transaction
+  /// keys. Lock-free; a batch takes n consecutive indexes of the key clock.
+  ///
+  void Overlay(uint64_t *key_nums, size_t n);
+
+  ///
+  /// Called by a client right before it issues an operation on key_num;
+  /// stamps the injection time of a drawn burst whose key it is. One atomic
+  /// load when no drawn burst is waiting for its first issue.
+  ///
+  void Issue(uint64_t key_num);
+
+  size_t size() const { return bursts_.size(); }
+  const Burst &burst(size_t i) const { return bursts_[i]; }
+  static const char *KindName(KeyKind kind);
+
+  /// Monotonic clock injection times are taken from, in nanoseconds
+  static int64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+ private:
+  void MarkDrawn(Burst &burst, uint64_t op);
+  void MarkInjected(Burst &burst);
+
+  std::vector<Burst> bursts_;
+  bool armed_;
+  uint64_t first_start_;
+  uint64_t last_end_;
+  std::atomic<uint64_t> clock_;  /// Transaction keys drawn so far
+  std::atomic<size_t> pending_;  /// Bursts drawn but not yet issued
+};
+
+inline void BurstInjector::Overlay(uint64_t *key_nums, size_t n) {
+  if (!armed_) return;
+  uint64_t base = clock_.fetch_add(n, std::memory_order_relaxed);
+  if (base + n <= first_start_ || base >= last_end_) return;
+  for (Burst &burst : bursts_) {
+    uint64_t begin = std::max(base, burst.start);
+    uint64_t end = std::min(base + n, burst.start + burst.ops);
+    for (uint64_t op = begin; op < end; ++op) {
+      if (utils::ThreadLocalRandomDouble() < burst.fraction) {
+        key_nums[op - base] = burst.key_num;
+        if (!burst.drawn.load(std::memory_order_relaxed)) MarkDrawn(burst, op);
+      }
+    }
+  }
+}
+
+inline void BurstInjector::Issue(uint64_t key_num) {
+  if (pending_.load(std::memory_order_acquire) == 0) return;
+  for (Burst &burst : bursts_) {
+    if (burst.key_num == key_num && !burst.injected() &&
+        burst.drawn.load(std::memory_order_acquire)) {
+      MarkInjected(burst);
+    }
+  }
+}
+
+} // ycsbc
+
+#endif // YCSB_C_BURST_INJECTOR_H_
@@ -10,8 +10,11 @@
 #define YCSB_C_CLIENT_H_
 
 #include <string>
+#include <vector>
 #include "db.h"
 #include "core_workload.h"
+#include "op_stream.h"
+#include "payload_arena.h"
 #include "twitter_trace_workload.h"
 #include "utils.h"
 
@@ -19,12 +22,20 @@ namespace ycsbc {
 
 class Client {
  public:
-  Client(DB &db, CoreWorkload *wl) : db_(db), workload_(wl) { }
+  Client(DB &db, CoreWorkload *wl) : db_(db), workload_(wl),
+      key_batch_(std::max<size_t>(1, wl->key_batch_size())),
+      key_batch_pos_(key_batch_.size()) { }
   
   virtual bool DoInsert(const size_t thread_id);
   virtual bool DoTransaction(const size_t thread_id);
+  /// Executes one operation replayed from an operation stream
+  virtual bool DoRecord(const OpRecord &rec);
+#ifdef TWITTER_TRACE
+  /// Inserts one distinct key of a deduplicated trace load
+  virtual bool DoLoadKey(const TraceLoadKey &load_key);
+#endif
   
-  virtual ~Client() { }
+  virtual ~Client() { workload_->ReleaseInsertBlock(insert_block_); }
   
  protected:
   
@@ -33,32 +44,113 @@ class Client {
   virtual int TransactionScan(size_t thread_id);
   virtual int TransactionUpdate(size_t thread_id);
   virtual int TransactionInsert(size_t thread_id);
+  virtual int TransactionDelete(size_t thread_id);
+
+  uint64_t NextTransactionKeyNum();
+
+  template <typename Key>
+  int ReadRecord(const std::string &table, const Key &key);
+  template <typename Key>
+  int ReadModifyWriteRecord(const std::string &table, const Key &key);
+  template <typename Key>
+  int ScanRecords(const std::string &table, const Key &key);
+  template <typename Key>
+  int UpdateRecord(const std::string &table, const Key &key);
+  template <typename Key>
+  int InsertRecord(const std::string &table, const Key &key);
+  template <typename Key>
+  int ReplayRecord(const std::string &table, const Key &key,
+                   const OpRecord &rec);
+  void BuildRecordValues(const OpRecord &rec, bool all_fields,
+                         std::vector<DB::KVPairView> &values);
+#ifdef TWITTER_TRACE
+  /// Takes the thread's next trace request (one trace access per op) and
+  /// tells the DB where it sits in the trace
+  void NextTraceRequest(TwitterTraceWorkload *t_wl, size_t thread_id,
+                        bool loading) {
+    t_wl->NextRequest(thread_id, trace_req_);
+    // The DB takes std::string keys; reusing one buffer avoids allocations
+    trace_key_.assign(trace_req_.key.data(), trace_req_.key.size());
+    DB::OpContext ctx;
+    ctx.sequence = trace_req_.sequence;
+    // read + update
+    ctx.accesses = (!loading && trace_req_.op == READMODIFYWRITE) ? 2 : 1;
+    ctx.timestamp = trace_req_.timestamp;
+    // Loading only prefills the keys, so nothing expires there
+    ctx.ttl = loading ? 0 : trace_req_.ttl;
+    db_.SetOpContext(ctx);
+  }
+#endif
+  /// The per-client value buffer, emptied for the next operation
+  std::vector<DB::KVPairView> &ClearedValues() {
+    values_.clear();
+    return values_;
+  }
   
   DB &db_;
   CoreWorkload *workload_;
+  // Upcoming transaction key numbers, drawn from the workload in batches
+  std::vector<uint64_t> key_batch_;
+  size_t key_batch_pos_;
+  // Insert key numbers reserved for this client
+  InsertKeySequence::Block insert_block_;
+  // Field/value views of the current write, reused across operations
+  std::vector<DB::KVPairView> values_;
+#ifdef TWITTER_TRACE
+  // The trace request being executed and its key
+  TraceRequest trace_req_;
+  std::string trace_key_;
+#endif
 };
 
+inline uint64_t Client::NextTransactionKeyNum() {
+  if (key_batch_pos_ == key_batch_.size()) {
+    workload_->NextTransactionKeyNums(key_batch_.data(), key_batch_.size());
+    key_batch_pos_ = 0;
+  }
+  uint64_t key_num = key_batch_[key_batch_pos_++];
+  workload_->IssueTransactionKeyNum(key_num);
+  return key_num;
+}
+
 inline bool Client::DoInsert(const size_t thread_id) {
 #ifdef TWITTER_TRACE
   TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
-  std::string key = t_wl->NextSequenceKey(thread_id);
-  std::vector<DB::KVPair> pairs;
-  t_wl->BuildValues(pairs, thread_id);
-  return (db_.Insert(workload_->NextTable(), key, pairs) == DB::kOK);
+  NextTraceRequest(t_wl, thread_id, true);
+  std::vector<DB::KVPairView> &pairs = ClearedValues();
+  t_wl->BuildRequestValues(pairs, trace_req_);
+  return (db_.Insert(workload_->NextTable(), trace_key_, pairs) == DB::kOK);
 #else
-  std::string key = workload_->NextSequenceKey();
-  std::vector<DB::KVPair> pairs;
-  workload_->BuildValues(pairs);
-  return (db_.Insert(workload_->NextTable(), key, pairs) == DB::kOK);
+  if (workload_->integer_keys()) {
+    return (InsertRecord(workload_->NextTable(),
+                         workload_->KeyId(workload_->NextSequenceKeyId())) == DB::kOK);
+  }
+  return (InsertRecord(workload_->NextTable(),
+                       workload_->NextSequenceKey()) == DB::kOK);
 #endif
 }
 
+#ifdef TWITTER_TRACE
+inline bool Client::DoLoadKey(const TraceLoadKey &load_key) {
+  TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
+  trace_req_ = TraceRequest();
+  trace_req_.op = INSERT;
+  trace_req_.value_size = load_key.value_size;
+  // The distinct keys are loaded out of trace order, so no sequence
+  db_.SetOpContext(DB::OpContext());
+  std::vector<DB::KVPairView> &pairs = ClearedValues();
+  t_wl->BuildRequestValues(pairs, trace_req_);
+  return (db_.Insert(workload_->NextTable(), load_key.key, pairs) == DB::kOK);
+}
+#endif
+
 inline bool Client::DoTransaction(const size_t thread_id) {
   int status = -1;
   ycsbc::Operation op;
 #ifdef TWITTER_TRACE
-  TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
-  op = t_wl->NextOperation(thread_id);
+  NextTraceRequest(static_cast<TwitterTraceWorkload*>(workload_), thread_id,
+                   false);
+  op = trace_req_.op;
 #else
   op = workload_->NextOperation();
 #endif
@@ -78,6 +170,9 @@ inline bool Client::DoTransaction(const size_t thread_id) {
     case READMODIFYWRITE:
       status = TransactionReadModifyWrite(thread_id);
       break;
+    case DELETE:
+      status = TransactionDelete(thread_id);
+      break;
     default:
       throw utils::Exception("Operation request is not recognized!");
   }
@@ -85,11 +180,71 @@ inline bool Client::DoTransaction(const size_t thread_id) {
   return (status == DB::kOK);
 }
 
+inline bool Client::DoRecord(const OpRecord &rec) {
+  const std::string &table = workload_->NextTable();
+  int status;
+  if (workload_->integer_keys()) {
+    status = ReplayRecord(table, rec.key_id, rec);
+  } else {
+    status = ReplayRecord(table, workload_->BuildKeyName(rec.key_id), rec);
+  }
+  assert(status >= 0);
+  return (status == DB::kOK);
+}
+
+template <typename Key>
+inline int Client::ReplayRecord(const std::string &table, const Key &key,
+                                const OpRecord &rec) {
+  std::vector<std::string> fields;
+  const std::vector<std::string> *read_fields = NULL;
+  if (!workload_->read_all_fields()) {
+    fields.push_back("field" + workload_->FieldName(rec.field));
+    read_fields = &fields;
+  }
+  std::vector<DB::KVPair> result;
+  std::vector<DB::KVPairView> &values = ClearedValues();
+  switch (rec.op) {
+    case READ:
+      return db_.Read(table, key, read_fields, result);
+    case SCAN: {
+      std::vector<std::vector<DB::KVPair>> scan_result;
+      return db_.Scan(table, key, rec.length, read_fields, scan_result);
+    }
+    case UPDATE:
+      BuildRecordValues(rec, workload_->write_all_fields(), values);
+      return db_.Update(table, key, values);
+    case READMODIFYWRITE:
+      db_.Read(table, key, read_fields, result);
+      BuildRecordValues(rec, workload_->write_all_fields(), values);
+      return db_.Update(table, key, values);
+    case INSERT:
+      BuildRecordValues(rec, true, values);
+      return db_.Insert(table, key, values);
+    case DELETE:
+      return db_.Delete(table, key);
+    default:
+      throw utils::Exception("Operation request is not recognized!");
+  }
+}
+
+inline void Client::BuildRecordValues(const OpRecord &rec, bool all_fields,
+                                      std::vector<DB::KVPairView> &values) {
+  PayloadArena &arena = PayloadArena::Default();
+  if (all_fields) {
+    for (int i = 0; i < workload_->field_count(); ++i) {
+      values.emplace_back(workload_->FieldNameView(i), arena.Slice(rec.length));
+    }
+  } else {
+    values.emplace_back(workload_->FieldNameView(rec.field),
+                        arena.Slice(rec.length));
+  }
+}
+
 inline int Client::TransactionRead(size_t thread_id) {
 #ifdef TWITTER_TRACE
   TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
   const std::string &table = t_wl->NextTable();
-  const std::string &key = t_wl->NextTransactionKey(thread_id);
+  const std::string &key = trace_key_;
   std::vector<DB::KVPair> result;
   if (!t_wl->read_all_fields()) {
     std::vector<std::string> fields;
@@ -100,7 +255,16 @@ inline int Client::TransactionRead(size_t thread_id) {
   }
 #else
   const std::string &table = workload_->NextTable();
-  const std::string &key = workload_->NextTransactionKey();
+  uint64_t key_num = NextTransactionKeyNum();
+  if (workload_->integer_keys()) {
+    return ReadRecord(table, workload_->KeyId(key_num));
+  }
+  return ReadRecord(table, workload_->BuildKeyName(key_num));
+#endif
+}
+
+template <typename Key>
+inline int Client::ReadRecord(const std::string &table, const Key &key) {
   std::vector<DB::KVPair> result;
   if (!workload_->read_all_fields()) {
     std::vector<std::string> fields;
@@ -109,14 +273,13 @@ inline int Client::TransactionRead(size_t thread_id) {
   } else {
     return db_.Read(table, key, NULL, result);
   }
-#endif
 }
 
 inline int Client::TransactionReadModifyWrite(size_t thread_id) {
 #ifdef TWITTER_TRACE
   TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
   const std::string &table = t_wl->NextTable();
-  const std::string &key = t_wl->NextTransactionKey(thread_id);
+  const std::string &key = trace_key_;
   std::vector<DB::KVPair> result;
 
   if (!t_wl->read_all_fields()) {
@@ -127,16 +290,26 @@ inline int Client::TransactionReadModifyWrite(size_t thread_id) {
     db_.Read(table, key, NULL, result);
   }
 
-  std::vector<DB::KVPair> values;
+  std::vector<DB::KVPairView> &values = ClearedValues();
   if (t_wl->write_all_fields()) {
-    t_wl->BuildValues(values, thread_id);
+    t_wl->BuildRequestValues(values, trace_req_);
   } else {
-    t_wl->BuildUpdate(values, thread_id);
+    t_wl->BuildRequestUpdate(values, trace_req_);
   }
   return db_.Update(table, key, values);
 #else
   const std::string &table = workload_->NextTable();
-  const std::string &key = workload_->NextTransactionKey();
+  uint64_t key_num = NextTransactionKeyNum();
+  if (workload_->integer_keys()) {
+    return ReadModifyWriteRecord(table, workload_->KeyId(key_num));
+  }
+  return ReadModifyWriteRecord(table, workload_->BuildKeyName(key_num));
+#endif
+}
+
+template <typename Key>
+inline int Client::ReadModifyWriteRecord(const std::string &table,
+                                         const Key &key) {
   std::vector<DB::KVPair> result;
 
   if (!workload_->read_all_fields()) {
@@ -147,21 +320,20 @@ inline int Client::TransactionReadModifyWrite(size_t thread_id) {
     db_.Read(table, key, NULL, result);
   }
 
-  std::vector<DB::KVPair> values;
+  std::vector<DB::KVPairView> &values = ClearedValues();
   if (workload_->write_all_fields()) {
     workload_->BuildValues(values);
   } else {
     workload_->BuildUpdate(values);
   }
   return db_.Update(table, key, values);
-#endif
 }
 
 inline int Client::TransactionScan(size_t thread_id) {
 #ifdef TWITTER_TRACE
   TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
   const std::string &table = t_wl->NextTable();
-  const std::string &key = t_wl->NextTransactionKey(thread_id);
+  const std::string &key = trace_key_;
   int len = t_wl->NextScanLength();
   std::vector<std::vector<DB::KVPair>> result;
   if (!t_wl->read_all_fields()) {
@@ -173,7 +345,16 @@ inline int Client::TransactionScan(size_t thread_id) {
   }
 #else
   const std::string &table = workload_->NextTable();
-  const std::string &key = workload_->NextTransactionKey();
+  uint64_t key_num = NextTransactionKeyNum();
+  if (workload_->integer_keys()) {
+    return ScanRecords(table, workload_->KeyId(key_num));
+  }
+  return ScanRecords(table, workload_->BuildKeyName(key_num));
+#endif
+}
+
+template <typename Key>
+inline int Client::ScanRecords(const std::string &table, const Key &key) {
   int len = workload_->NextScanLength();
   std::vector<std::vector<DB::KVPair>> result;
   if (!workload_->read_all_fields()) {
@@ -183,50 +364,79 @@ inline int Client::TransactionScan(size_t thread_id) {
   } else {
     return db_.Scan(table, key, len, NULL, result);
   }
-#endif
 }
 
 inline int Client::TransactionUpdate(size_t thread_id) {
 #ifdef TWITTER_TRACE
   TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
   const std::string &table = t_wl->NextTable();
-  const std::string &key = t_wl->NextTransactionKey(thread_id);
-  std::vector<DB::KVPair> values;
+  const std::string &key = trace_key_;
+  std::vector<DB::KVPairView> &values = ClearedValues();
   if (t_wl->write_all_fields()) {
-    t_wl->BuildValues(values, thread_id);
+    t_wl->BuildRequestValues(values, trace_req_);
   } else {
-    t_wl->BuildUpdate(values, thread_id);
+    t_wl->BuildRequestUpdate(values, trace_req_);
   }
   return db_.Update(table, key, values);
 #else 
   const std::string &table = workload_->NextTable();
-  const std::string &key = workload_->NextTransactionKey();
-  std::vector<DB::KVPair> values;
+  uint64_t key_num = NextTransactionKeyNum();
+  if (workload_->integer_keys()) {
+    return UpdateRecord(table, workload_->KeyId(key_num));
+  }
+  return UpdateRecord(table, workload_->BuildKeyName(key_num));
+#endif
+}
+
+template <typename Key>
+inline int Client::UpdateRecord(const std::string &table, const Key &key) {
+  std::vector<DB::KVPairView> &values = ClearedValues();
   if (workload_->write_all_fields()) {
     workload_->BuildValues(values);
   } else {
     workload_->BuildUpdate(values);
   }
   return db_.Update(table, key, values);
-#endif
 }
 
 inline int Client::TransactionInsert(size_t thread_id) {
 #ifdef TWITTER_TRACE
   TwitterTraceWorkload* t_wl = static_cast<TwitterTraceWorkload*>(workload_);
   const std::string &table = t_wl->NextTable();
-  const std::string &key = t_wl->NextSequenceKey(thread_id);
-  std::vector<DB::KVPair> values;
-  t_wl->BuildValues(values, thread_id);
+  const std::string &key = trace_key_;
+  std::vector<DB::KVPairView> &values = ClearedValues();
+  t_wl->BuildRequestValues(values, trace_req_);
   return db_.Insert(table, key, values);
 #else
   const std::string &table = workload_->NextTable();
-  const std::string &key = workload_->NextSequenceKey();
-  std::vector<DB::KVPair> values;
+  uint64_t key_num = workload_->NextInsertKeyId(insert_block_);
+  int status = workload_->integer_keys() ?
+      InsertRecord(table, workload_->KeyId(key_num)) :
+      InsertRecord(table, workload_->BuildKeyName(key_num));
+  workload_->AcknowledgeInsert(key_num);
+  return status;
+#endif
+}
+
+template <typename Key>
+inline int Client::InsertRecord(const std::string &table, const Key &key) {
+  std::vector<DB::KVPairView> &values = ClearedValues();
   workload_->BuildValues(values);
   return db_.Insert(table, key, values);
+}
+
+inline int Client::TransactionDelete(size_t thread_id) {
+#ifdef TWITTER_TRACE
+  return db_.Delete(workload_->NextTable(), trace_key_);
+#else
+  const std::string &table = workload_->NextTable();
+  uint64_t key_num = NextTransactionKeyNum();
+  if (workload_->integer_keys()) {
+    return db_.Delete(table, workload_->KeyId(key_num));
+  }
+  return db_.Delete(table, workload_->BuildKeyName(key_num));
 #endif
-} 
+}
 
 } // ycsbc
 
@@ -12,9 +12,11 @@
 #include "skewed_latest_generator.h"
 #include "const_generator.h"
 #include "core_workload.h"
+#include "payload_arena.h"
 
 #include <string>
 #include <iostream>
+#include <unordered_set>
 
 using ycsbc::CoreWorkload;
 using std::string;
@@ -76,15 +78,37 @@ const string CoreWorkload::INSERT_ORDER_DEFAULT = "hashed";
 const string CoreWorkload::INSERT_START_PROPERTY = "insertstart";
 const string CoreWorkload::INSERT_START_DEFAULT = "0";
 
+const string CoreWorkload::KEY_PREFIX_PROPERTY = "keyprefix";
+const string CoreWorkload::KEY_PREFIX_DEFAULT = "user";
+
+const string CoreWorkload::KEY_BATCH_SIZE_PROPERTY = "keybatchsize";
+const string CoreWorkload::KEY_BATCH_SIZE_DEFAULT = "64";
+
+const string CoreWorkload::KEY_TYPE_PROPERTY = "keytype";
+const string CoreWorkload::KEY_TYPE_DEFAULT = "string";
+
+const string CoreWorkload::INSERT_BLOCK_SIZE_PROPERTY = "insertblocksize";
+const string CoreWorkload::INSERT_BLOCK_SIZE_DEFAULT = "64";
+
 const string CoreWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string CoreWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
 
+const string CoreWorkload::SAMPLE_RATE_PROPERTY = "samplerate";
+const string CoreWorkload::SAMPLE_RATE_DEFAULT = "1";
+
 void CoreWorkload::Init(const utils::Properties &p) {
   table_name_ = p.GetProperty(TABLENAME_PROPERTY,TABLENAME_DEFAULT);
   
   field_count_ = std::stoi(p.GetProperty(FIELD_COUNT_PROPERTY,
                                          FIELD_COUNT_DEFAULT));
   field_len_generator_ = GetFieldLenGenerator(p);
+  field_names_.clear();
+  for (int i = 0; i < field_count_; ++i) {
+    field_names_.push_back(FieldName(i));
+  }
+  // Values are sliced from the shared arena, sized once for the longest field
+  PayloadArena::Default().Reserve(std::stoi(p.GetProperty(FIELD_LENGTH_PROPERTY,
+                                                          FIELD_LENGTH_DEFAULT)));
   
   double read_proportion = std::stod(p.GetProperty(READ_PROPORTION_PROPERTY,
                                                    READ_PROPORTION_DEFAULT));
@@ -97,16 +121,20 @@ void CoreWorkload::Init(const utils::Properties &p) {
   double readmodifywrite_proportion = std::stod(p.GetProperty(
       READMODIFYWRITE_PROPORTION_PROPERTY, READMODIFYWRITE_PROPORTION_DEFAULT));
   
-  record_count_ = std::stoi(p.GetProperty(RECORD_COUNT_PROPERTY));
+  record_count_ = std::stoull(p.GetProperty(RECORD_COUNT_PROPERTY));
   std::string request_dist = p.GetProperty(REQUEST_DISTRIBUTION_PROPERTY,
                                            REQUEST_DISTRIBUTION_DEFAULT);
-  zero_padding_ = std::stoi(p.GetProperty(ZERO_PADDING_PROPERTY, ZERO_PADDING_DEFAULT));
+  key_format_.zero_padding = std::stoi(p.GetProperty(ZERO_PADDING_PROPERTY,
+                                                    ZERO_PADDING_DEFAULT));
+  key_format_.prefix = p.GetProperty(KEY_PREFIX_PROPERTY, KEY_PREFIX_DEFAULT);
   int max_scan_len = std::stoi(p.GetProperty(MAX_SCAN_LENGTH_PROPERTY,
                                              MAX_SCAN_LENGTH_DEFAULT));
   std::string scan_len_dist = p.GetProperty(SCAN_LENGTH_DISTRIBUTION_PROPERTY,
                                             SCAN_LENGTH_DISTRIBUTION_DEFAULT);
-  int insert_start = std::stoi(p.GetProperty(INSERT_START_PROPERTY,
-                                             INSERT_START_DEFAULT));
+  uint64_t insert_start = std::stoull(p.GetProperty(INSERT_START_PROPERTY,
+                                                    INSERT_START_DEFAULT));
+  key_batch_size_ = std::max(1, std::stoi(p.GetProperty(KEY_BATCH_SIZE_PROPERTY,
+                                                        KEY_BATCH_SIZE_DEFAULT)));
   
   read_all_fields_ = utils::StrToBool(p.GetProperty(READ_ALL_FIELDS_PROPERTY,
                                                     READ_ALL_FIELDS_DEFAULT));
@@ -114,12 +142,34 @@ void CoreWorkload::Init(const utils::Properties &p) {
                                                      WRITE_ALL_FIELDS_DEFAULT));
   
   if (p.GetProperty(INSERT_ORDER_PROPERTY, INSERT_ORDER_DEFAULT) == "hashed") {
-    ordered_inserts_ = false;
+    key_format_.hashed = true;
+  } else {
+    key_format_.hashed = false;
+  }
+
+  std::string key_type = p.GetProperty(KEY_TYPE_PROPERTY, KEY_TYPE_DEFAULT);
+  if (key_type == "string") {
+    integer_keys_ = false;
+  } else if (key_type == "integer") {
+    integer_keys_ = true;
   } else {
-    ordered_inserts_ = true;
+    throw utils::Exception("Unknown key type: " + key_type);
   }
   
   key_generator_ = new CounterGenerator(insert_start);
+  sampler_ = utils::KeySampler(std::stod(p.GetProperty(SAMPLE_RATE_PROPERTY,
+                                                       SAMPLE_RATE_DEFAULT)));
+  // The load skips keys outside the sample, so it runs one operation per
+  // sampled key of its range rather than Scale(recordcount): that would
+  // stop short of the range or run past it
+  load_count_ = record_count_;
+  if (sampler_.enabled()) {
+    load_count_ = 0;
+    for (uint64_t key_num = insert_start;
+         key_num < insert_start + record_count_; ++key_num) {
+      load_count_ += sampler_.Sampled(key_num);
+    }
+  }
   
   if (read_proportion > 0) {
     op_chooser_.AddValue(READ, read_proportion);
@@ -138,6 +188,14 @@ void CoreWorkload::Init(const utils::Properties &p) {
   }
   
   insert_key_sequence_.Set(record_count_);
+  size_t insert_block_size = std::stoul(p.GetProperty(
+      INSERT_BLOCK_SIZE_PROPERTY, INSERT_BLOCK_SIZE_DEFAULT));
+  if (insert_block_size == 0 ||
+      insert_block_size >= InsertKeySequence::kWindowSize) {
+    throw utils::Exception("Invalid insert block size: " +
+        std::to_string(insert_block_size));
+  }
+  insert_key_sequence_.SetBlockSize(insert_block_size);
   
   if (request_dist == "uniform") {
     key_chooser_ = new UniformGenerator(0, record_count_ - 1);
@@ -148,12 +206,14 @@ void CoreWorkload::Init(const utils::Properties &p) {
     // that is larger than what exists at the beginning of the test.
     // If the generator picks a key that is not inserted yet, we just ignore it
     // and pick another key.
-    int op_count = std::stoi(p.GetProperty(OPERATION_COUNT_PROPERTY));
-    int new_keys = (int)(op_count * insert_proportion * 2); // a fudge factor
+    uint64_t op_count = std::stoull(p.GetProperty(OPERATION_COUNT_PROPERTY));
+    uint64_t new_keys = op_count * insert_proportion * 2; // a fudge factor
     key_chooser_ = new ScrambledZipfianGenerator(record_count_ + new_keys);
     
   } else if (request_dist == "latest") {
     key_chooser_ = new SkewedLatestGenerator(insert_key_sequence_);
+    // Buffered keys would be skewed towards a stale "latest" record
+    key_batch_size_ = 1;
     
   } else {
     throw utils::Exception("Unknown request distribution: " + request_dist);
@@ -169,6 +229,38 @@ void CoreWorkload::Init(const utils::Properties &p) {
     throw utils::Exception("Distribution not allowed for scan length: " +
         scan_len_dist);
   }
+
+  InitBursts(p);
+}
+
+void CoreWorkload::InitBursts(const utils::Properties &p) {
+  // Keys drawn from the base distribution, to tell which keys are cold
+  const size_t kColdKeySample = 1 << 16;
+  const int kColdKeyTries = 64;
+  std::unordered_set<uint64_t> drawn;
+
+  bursts_.Init(p);
+  for (size_t i = 0; i < bursts_.size(); ++i) {
+    const BurstInjector::Burst &burst = bursts_.burst(i);
+    uint64_t key_num = burst.key_num;
+    if (burst.kind == BurstInjector::kNewKey) {
+      // Far above every key loaded or inserted during the run
+      key_num = DB::kKeyNumMask - i;
+    } else if (burst.kind == BurstInjector::kColdKey) {
+      if (drawn.empty()) {
+        std::vector<uint64_t> sample(kColdKeySample);
+        NextTransactionKeyNums(sample.data(), sample.size());
+        drawn.insert(sample.begin(), sample.end());
+      }
+      int tries = 0;
+      do {
+        key_num = utils::ThreadLocalRandomDouble() * record_count_;
+      } while (drawn.count(key_num) && ++tries < kColdKeyTries);
+    }
+    drawn.insert(key_num);
+    bursts_.SetKey(i, key_num, KeyId(key_num), BuildKeyName(key_num));
+  }
+  bursts_.Arm();
 }
 
 ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
@@ -193,7 +285,7 @@ void CoreWorkload::BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
   for (int i = 0; i < field_count_; ++i) {
     ycsbc::DB::KVPair pair;
     pair.first.append("field").append(std::to_string(i));
-    pair.second.append(field_len_generator_->Next(), utils::RandomPrintChar());
+    pair.second.append(NextFieldLength(), utils::RandomPrintChar());
     values.push_back(pair);
   }
 }
@@ -201,7 +293,20 @@ void CoreWorkload::BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
 void CoreWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPair> &update) {
   ycsbc::DB::KVPair pair;
   pair.first.append(NextFieldName());
-  pair.second.append(field_len_generator_->Next(), utils::RandomPrintChar());
+  pair.second.append(NextFieldLength(), utils::RandomPrintChar());
   update.push_back(pair);
 }
 
+void CoreWorkload::BuildValues(std::vector<ycsbc::DB::KVPairView> &values) {
+  PayloadArena &arena = PayloadArena::Default();
+  for (int i = 0; i < field_count_; ++i) {
+    values.emplace_back(field_names_[i],
+                        arena.Slice(NextFieldLength()));
+  }
+}
+
+void CoreWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPairView> &update) {
+  update.emplace_back(field_names_[NextFieldIndex()],
+                      PayloadArena::Default().Slice(NextFieldLength()));
+}
+
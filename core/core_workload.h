@@ -16,6 +16,9 @@
 #include "generator.h"
 #include "discrete_generator.h"
 #include "counter_generator.h"
+#include "insert_key_sequence.h"
+#include "burst_injector.h"
+#include "key_sampler.h"
 #include "utils.h"
 
 namespace ycsbc {
@@ -25,7 +28,8 @@ enum Operation {
   READ,
   UPDATE,
   SCAN,
-  READMODIFYWRITE
+  READMODIFYWRITE,
+  DELETE
 };
 
 class CoreWorkload {
@@ -114,6 +118,12 @@ class CoreWorkload {
   static const std::string ZERO_PADDING_PROPERTY;
   static const std::string ZERO_PADDING_DEFAULT;
 
+  ///
+  /// The name of the property for the prefix of record keys.
+  ///
+  static const std::string KEY_PREFIX_PROPERTY;
+  static const std::string KEY_PREFIX_DEFAULT;
+
   /// 
   /// The name of the property for the max scan length (number of records).
   ///
@@ -136,10 +146,40 @@ class CoreWorkload {
 
   static const std::string INSERT_START_PROPERTY;
   static const std::string INSERT_START_DEFAULT;
+
+  ///
+  /// The name of the property for the number of transaction keys each client
+  /// draws from the key chooser at once and buffers locally.
+  ///
+  static const std::string KEY_BATCH_SIZE_PROPERTY;
+  static const std::string KEY_BATCH_SIZE_DEFAULT;
+
+  ///
+  /// The name of the property for the type of keys handed to the DB.
+  /// Options are "string" (formatted "user..." keys) and "integer" (64-bit
+  /// key ids, formatted only by backends that need string keys).
+  ///
+  static const std::string KEY_TYPE_PROPERTY;
+  static const std::string KEY_TYPE_DEFAULT;
+
+  ///
+  /// The name of the property for the number of insert key numbers each
+  /// client reserves at once during the transaction phase.
+  ///
+  static const std::string INSERT_BLOCK_SIZE_PROPERTY;
+  static const std::string INSERT_BLOCK_SIZE_DEFAULT;
   
   static const std::string RECORD_COUNT_PROPERTY;
   static const std::string OPERATION_COUNT_PROPERTY;
 
+  ///
+  /// The name of the property for the rate of spatial key sampling. Only
+  /// keys in the hash sample (see key_sampler.h) are loaded and requested,
+  /// and the record and operation counts shrink by the same rate.
+  ///
+  static const std::string SAMPLE_RATE_PROPERTY;
+  static const std::string SAMPLE_RATE_DEFAULT;
+
   ///
   /// Initialize the scenario.
   /// Called once, in the main client thread, before any operations are started.
@@ -148,22 +188,58 @@ class CoreWorkload {
   
   virtual void BuildValues(std::vector<ycsbc::DB::KVPair> &values);
   virtual void BuildUpdate(std::vector<ycsbc::DB::KVPair> &update);
+  /// Same as above, with field names and values viewed from shared memory
+  virtual void BuildValues(std::vector<ycsbc::DB::KVPairView> &values);
+  virtual void BuildUpdate(std::vector<ycsbc::DB::KVPairView> &update);
   
   virtual std::string NextTable() { return table_name_; }
   virtual std::string NextSequenceKey(); /// Used for loading data
   virtual std::string NextTransactionKey(); /// Used for transactions
+  virtual uint64_t NextSequenceKeyId(); /// Used for loading data
+  virtual uint64_t NextTransactionKeyId(); /// Used for transactions
+  /// Used for transaction inserts, from the calling client's reserved block
+  virtual uint64_t NextInsertKeyId(InsertKeySequence::Block &block);
+  /// Marks a transaction insert as done, so its key can be chosen by others
+  virtual void AcknowledgeInsert(uint64_t key_num);
+  /// Returns the unused rest of a client's block when the client is done
+  virtual void ReleaseInsertBlock(InsertKeySequence::Block &block);
+  /// Used for transactions by clients that buffer upcoming keys
+  virtual void NextTransactionKeyNums(uint64_t *key_nums, size_t n);
+  virtual std::string BuildKeyName(uint64_t key_num);
+  /// Key id handed to the DB for a key number in integer key mode
+  uint64_t KeyId(uint64_t key_num) const { return key_id_base_ | key_num; }
+  /// Tags the key ids of this workload, e.g. with a tenant index
+  void SetKeyIdBase(uint64_t base) { key_id_base_ = base; }
   virtual Operation NextOperation() { return op_chooser_.Next(); }
   virtual std::string NextFieldName();
   virtual size_t NextScanLength() { return scan_len_chooser_->Next(); }
+  virtual size_t NextFieldIndex() { return field_chooser_->Next(); }
+  virtual size_t NextFieldLength() { return field_len_generator_->Next(); }
+  std::string FieldName(size_t index);
+  /// Name of field index, owned by the workload
+  std::string_view FieldNameView(size_t index) const { return field_names_[index]; }
   
   bool read_all_fields() const { return read_all_fields_; }
   bool write_all_fields() const { return write_all_fields_; }
+  int field_count() const { return field_count_; }
+  size_t key_batch_size() const { return key_batch_size_; }
+  bool integer_keys() const { return integer_keys_; }
+  const DB::KeyFormat &key_format() const { return key_format_; }
+  /// Hot-key bursts overlaid on the transaction keys
+  const BurstInjector &bursts() const { return bursts_; }
+  /// Called right before a transaction on key_num is issued
+  void IssueTransactionKeyNum(uint64_t key_num) { bursts_.Issue(key_num); }
+  /// The key sample; counts of operations go through Scale()
+  const utils::KeySampler &sampler() const { return sampler_; }
+  /// Keys the load phase inserts: the sampled keys of the load range
+  uint64_t load_count() const { return load_count_; }
 
   CoreWorkload() :
       field_count_(0), read_all_fields_(false), write_all_fields_(false),
       field_len_generator_(NULL), key_generator_(NULL), key_chooser_(NULL),
-      field_chooser_(NULL), scan_len_chooser_(NULL), insert_key_sequence_(3),
-      ordered_inserts_(true), record_count_(0) {
+      field_chooser_(NULL), scan_len_chooser_(NULL), insert_key_sequence_(0),
+      record_count_(0), load_count_(0), key_batch_size_(1), integer_keys_(false),
+      key_id_base_(0) {
   }
   
   virtual ~CoreWorkload() {
@@ -176,7 +252,8 @@ class CoreWorkload {
   
  protected:
   static Generator<uint64_t> *GetFieldLenGenerator(const utils::Properties &p);
-  std::string BuildKeyName(uint64_t key_num);
+  /// Parses the bursts and picks their keys; called at the end of Init
+  void InitBursts(const utils::Properties &p);
 
   std::string table_name_;
   int field_count_;
@@ -188,37 +265,85 @@ class CoreWorkload {
   Generator<uint64_t> *key_chooser_;
   Generator<uint64_t> *field_chooser_;
   Generator<uint64_t> *scan_len_chooser_;
-  CounterGenerator insert_key_sequence_;
-  bool ordered_inserts_;
-  size_t record_count_;
-  int zero_padding_;
+  InsertKeySequence insert_key_sequence_;
+  uint64_t record_count_;
+  uint64_t load_count_;
+  DB::KeyFormat key_format_;
+  size_t key_batch_size_;
+  bool integer_keys_;
+  uint64_t key_id_base_;
+  std::vector<std::string> field_names_;
+  BurstInjector bursts_;
+  utils::KeySampler sampler_;
 };
 
 inline std::string CoreWorkload::NextSequenceKey() {
-  uint64_t key_num = key_generator_->Next();
-  return BuildKeyName(key_num);
+  return BuildKeyName(NextSequenceKeyId());
 }
 
 inline std::string CoreWorkload::NextTransactionKey() {
+  return BuildKeyName(NextTransactionKeyId());
+}
+
+inline uint64_t CoreWorkload::NextSequenceKeyId() {
+  uint64_t key_num;
+  do {
+    key_num = key_generator_->Next();
+  } while (!sampler_.Sampled(key_num));
+  return key_num;
+}
+
+inline uint64_t CoreWorkload::NextTransactionKeyId() {
   uint64_t key_num;
   do {
     key_num = key_chooser_->Next();
-  } while (key_num > insert_key_sequence_.Last());
-  return BuildKeyName(key_num);
+  } while (key_num > insert_key_sequence_.Last() ||
+           !sampler_.Sampled(key_num));
+  bursts_.Overlay(&key_num, 1);
+  return key_num;
 }
 
-inline std::string CoreWorkload::BuildKeyName(uint64_t key_num) {
-  if (!ordered_inserts_) {
-    key_num = utils::Hash(key_num);
+inline uint64_t CoreWorkload::NextInsertKeyId(
+    InsertKeySequence::Block &block) {
+  uint64_t key_num = insert_key_sequence_.Next(block);
+  // Keys outside the sample are never inserted, nor chosen by readers
+  while (!sampler_.Sampled(key_num)) {
+    insert_key_sequence_.Acknowledge(key_num);
+    key_num = insert_key_sequence_.Next(block);
   }
-  std::string key_num_str = std::to_string(key_num);
-  int zeros = zero_padding_ - key_num_str.length();
-  zeros = std::max(0, zeros);
-  return std::string("user").append(zeros, '0').append(key_num_str);
+  return key_num;
+}
+
+inline void CoreWorkload::AcknowledgeInsert(uint64_t key_num) {
+  insert_key_sequence_.Acknowledge(key_num);
+}
+
+inline void CoreWorkload::ReleaseInsertBlock(InsertKeySequence::Block &block) {
+  insert_key_sequence_.Release(block);
+}
+
+inline void CoreWorkload::NextTransactionKeyNums(uint64_t *key_nums,
+                                                 size_t n) {
+  key_chooser_->NextBatch(key_nums, n);
+  for (size_t i = 0; i < n; ++i) {
+    while (key_nums[i] > insert_key_sequence_.Last() ||
+           !sampler_.Sampled(key_nums[i])) {
+      key_nums[i] = key_chooser_->Next();
+    }
+  }
+  bursts_.Overlay(key_nums, n);
+}
+
+inline std::string CoreWorkload::BuildKeyName(uint64_t key_num) {
+  return key_format_.Name(key_num);
 }
 
 inline std::string CoreWorkload::NextFieldName() {
-  return std::string("field").append(std::to_string(field_chooser_->Next()));
+  return FieldName(NextFieldIndex());
+}
+
+inline std::string CoreWorkload::FieldName(size_t index) {
+  return std::string("field").append(std::to_string(index));
 }
   
 } // ycsbc
@@ -9,18 +9,54 @@
 #ifndef YCSB_C_DB_H_
 #define YCSB_C_DB_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
+#include "utils.h"
 
 namespace ycsbc {
 
 class DB {
  public:
   typedef std::pair<std::string, std::string> KVPair;
+  /// Field/value pair pointing into memory owned by the caller
+  typedef std::pair<std::string_view, std::string_view> KVPairView;
   static const int kOK = 0;
   static const int kErrorNoData = 1;
   static const int kErrorConflict = 2;
   ///
+  /// Spelling of an integer key id as a string key: the prefix followed by
+  /// the zero padded key number, which is hashed first unless inserts are
+  /// ordered. Shared by the workload and by backends that need string keys.
+  ///
+  struct KeyFormat {
+    std::string prefix = "user";
+    int zero_padding = 20;
+    bool hashed = true;
+
+    std::string Name(uint64_t key_id) const;
+  };
+  ///
+  /// Key ids of multi-tenant runs carry the tenant index in the bits above
+  /// kTenantShift; the bits below hold the tenant's own key number.
+  ///
+  static const int kTenantShift = 48;
+  static const uint64_t kKeyNumMask = (uint64_t(1) << kTenantShift) - 1;
+  ///
+  /// Where the operations a thread is about to issue come from, such as the
+  /// position of the request in a replayed trace. Operations of one request
+  /// (e.g. the read and write of a read-modify-write) share a sequence.
+  ///
+  static const uint64_t kNoSequence = UINT64_MAX;
+  struct OpContext {
+    uint64_t sequence = kNoSequence;
+    uint32_t accesses = 1;  /// Number of operations the request issues
+    uint64_t timestamp = 0; /// Trace time of the request, in seconds
+    uint32_t ttl = 0;       /// Seconds a write stays live; 0 never expires
+  };
+  ///
   /// Initializes any state for accessing this DB.
   /// Called once per DB client (thread); there is a single DB instance globally.
   ///
@@ -89,6 +125,86 @@ class DB {
   /// @return Zero on success, a non-zero error code on error.
   ///
   virtual int Delete(const std::string &table, const std::string &key) = 0;
+
+  ///
+  /// Integer-key variants of the operations above, used when the workload
+  /// runs with keytype=integer. The key is a 64-bit key id; backends that
+  /// store string keys get the id formatted through the key format, while
+  /// backends that only need key identity override these and skip the
+  /// string entirely.
+  ///
+  virtual int Read(const std::string &table, uint64_t key_id,
+                   const std::vector<std::string> *fields,
+                   std::vector<KVPair> &result) {
+    return Read(table, KeyName(key_id), fields, result);
+  }
+  virtual int Scan(const std::string &table, uint64_t key_id,
+                   int record_count, const std::vector<std::string> *fields,
+                   std::vector<std::vector<KVPair>> &result) {
+    return Scan(table, KeyName(key_id), record_count, fields, result);
+  }
+  virtual int Update(const std::string &table, uint64_t key_id,
+                     const std::vector<KVPairView> &values) {
+    return Update(table, KeyName(key_id), values);
+  }
+  virtual int Insert(const std::string &table, uint64_t key_id,
+                     const std::vector<KVPairView> &values) {
+    return Insert(table, KeyName(key_id), values);
+  }
+
+  ///
+  /// View-based variants of Update/Insert, used by the client so values can
+  /// be sliced from a shared payload arena instead of built per operation.
+  /// The views are only valid during the call. By default they are copied
+  /// once into KVPairs; backends that store values should copy straight from
+  /// the views, and backends that ignore values should skip them.
+  ///
+  virtual int Update(const std::string &table, const std::string &key,
+                     const std::vector<KVPairView> &values) {
+    std::vector<KVPair> pairs = ToKVPairs(values);
+    return Update(table, key, pairs);
+  }
+  virtual int Insert(const std::string &table, const std::string &key,
+                     const std::vector<KVPairView> &values) {
+    std::vector<KVPair> pairs = ToKVPairs(values);
+    return Insert(table, key, pairs);
+  }
+
+  static std::vector<KVPair> ToKVPairs(const std::vector<KVPairView> &values) {
+    std::vector<KVPair> pairs;
+    pairs.reserve(values.size());
+    for (const auto &value : values) {
+      pairs.emplace_back(value.first, value.second);
+    }
+    return pairs;
+  }
+  virtual int Delete(const std::string &table, uint64_t key_id) {
+    return Delete(table, KeyName(key_id));
+  }
+
+  ///
+  /// Sets how integer key ids are formatted into string keys.
+  /// Called once, in the main client thread, before any operations are started.
+  ///
+  void SetKeyFormat(const KeyFormat &format) { key_format_ = format; }
+  const KeyFormat &key_format() const { return key_format_; }
+  ///
+  /// Sets one key format per tenant for multi-tenant runs; key ids are then
+  /// formatted by the format of the tenant in their top bits.
+  ///
+  void SetTenantKeyFormats(const std::vector<KeyFormat> &formats) {
+    tenant_key_formats_ = formats;
+  }
+  const std::vector<KeyFormat> &tenant_key_formats() const {
+    return tenant_key_formats_;
+  }
+  std::string KeyName(uint64_t key_id) const;
+  ///
+  /// Sets the context of the following operations of the calling thread.
+  /// Called by the client before the operations of each traced request;
+  /// backends that do not need it ignore it.
+  ///
+  virtual void SetOpContext(const OpContext &ctx) { }
   
   /// @CS0522
   /// Sends a Special command to server.
@@ -98,8 +214,29 @@ class DB {
   virtual int Special(const std::string &command) { return 0; };
   
   virtual ~DB() { }
+
+ protected:
+  KeyFormat key_format_;
+  std::vector<KeyFormat> tenant_key_formats_;
 };
 
+inline std::string DB::KeyFormat::Name(uint64_t key_id) const {
+  if (hashed) {
+    key_id = utils::Hash(key_id);
+  }
+  std::string key_num_str = std::to_string(key_id);
+  int zeros = zero_padding - key_num_str.length();
+  zeros = std::max(0, zeros);
+  return std::string(prefix).append(zeros, '0').append(key_num_str);
+}
+
+inline std::string DB::KeyName(uint64_t key_id) const {
+  if (tenant_key_formats_.empty()) {
+    return key_format_.Name(key_id);
+  }
+  return tenant_key_formats_.at(key_id >> kTenantShift).Name(key_id & kKeyNumMask);
+}
+
 } // ycsbc
 
 #endif // YCSB_C_DB_H_
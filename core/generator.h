@@ -9,6 +9,7 @@
 #ifndef YCSB_C_GENERATOR_H_
 #define YCSB_C_GENERATOR_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -19,6 +20,14 @@ class Generator {
  public:
   virtual Value Next() = 0;
   virtual Value Last() = 0;
+  ///
+  /// Fills out[0, n) with the next n values.
+  /// Generators that lock or do heavy math per value override this so the
+  /// cost is paid once per batch instead of once per value.
+  ///
+  virtual void NextBatch(Value *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = Next();
+  }
   virtual ~Generator() { }
 };
 
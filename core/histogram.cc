@@ -268,3 +268,11 @@ std::string Histogram::ToString() const {
   return r;
 }
 
+std::string Histogram::Summary() const {
+  char buf[300];
+  std::snprintf(buf, sizeof(buf),
+                "Count: %.0f  Average: %.4f  P50: %.2f  P99: %.2f  P99.9: %.2f",
+                num_, Average(), Percentile(50), Percentile(99),
+                Percentile(99.9));
+  return buf;
+}
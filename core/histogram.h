@@ -17,6 +17,8 @@ class Histogram {
   void Merge(const Histogram& other);
 
   std::string ToString() const;
+  // One line: count, average and tail percentiles, without the buckets
+  std::string Summary() const;
 
  private:
   enum { kNumBuckets = 154 };
@@ -0,0 +1,162 @@
+//
+//  insert_key_sequence.h
+//  YCSB-C
+//
+//  Key numbers for transaction-phase inserts. Client threads reserve blocks
+//  of consecutive numbers from one shared counter, so the counter is touched
+//  once per block rather than once per insert. Completed inserts are
+//  acknowledged, and the sequence publishes a low watermark below which
+//  every key number has been inserted; readers never pick a key that is
+//  still in flight. A block left far behind the counter is given back when
+//  its owner next reserves a number, so a thread that inserts rarely does not
+//  hold the watermark back for long.
+//
+
+#ifndef YCSB_C_INSERT_KEY_SEQUENCE_H_
+#define YCSB_C_INSERT_KEY_SEQUENCE_H_
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace ycsbc {
+
+class InsertKeySequence {
+ public:
+  ///
+  /// A range [next, end) of key numbers reserved by one client thread.
+  ///
+  struct Block {
+    uint64_t next = 0;
+    uint64_t end = 0;
+  };
+
+  static const size_t kDefaultBlockSize = 64;
+  static const size_t kWindowSize = 1 << 20; /// Must be a power of two
+  /// A block whose end trails the counter by this many blocks is stale
+  static const size_t kStaleBlocks = 16;
+
+  InsertKeySequence(uint64_t start, size_t block_size = kDefaultBlockSize) :
+      counter_(start), watermark_(start), block_size_(block_size),
+      acked_(new std::atomic<uint64_t>[kWindowSize]) {
+    assert(block_size_ > 0 && block_size_ < kWindowSize);
+    for (size_t i = 0; i < kWindowSize; ++i) acked_[i] = 0;
+  }
+
+  ///
+  /// Restarts the sequence at start, treating every smaller key number as
+  /// inserted. Called before any client thread uses the sequence.
+  ///
+  void Set(uint64_t start) {
+    for (size_t i = 0; i < kWindowSize; ++i) acked_[i] = 0;
+    counter_.store(start);
+    watermark_.store(start);
+  }
+
+  void SetBlockSize(size_t block_size) {
+    assert(block_size > 0 && block_size < kWindowSize);
+    block_size_ = block_size;
+  }
+
+  ///
+  /// Hands out the next key number of the caller's block, reserving a new
+  /// block from the shared counter when it is used up or has gone stale.
+  /// The unused rest of a stale block is acknowledged without an insert,
+  /// like Release(), so the watermark can pass it.
+  ///
+  uint64_t Next(Block &block) {
+    if (block.next != block.end &&
+        counter_.load(std::memory_order_relaxed) - block.end >=
+            kStaleBlocks * block_size_) {
+      Release(block);
+    }
+    if (block.next == block.end) {
+      block.next = counter_.fetch_add(block_size_, std::memory_order_relaxed);
+      block.end = block.next + block_size_;
+    }
+    return block.next++;
+  }
+
+  ///
+  /// Marks key_num, handed out by Next(), as inserted.
+  ///
+  void Acknowledge(uint64_t key_num) {
+    // The window only tracks kWindowSize numbers past the watermark. It only
+    // fills up while some block is held far behind, so sleep rather than spin
+    if (key_num - watermark_.load() >= kWindowSize) {
+      WaitForWindow(key_num);
+    }
+    acked_[key_num & (kWindowSize - 1)].store(key_num + 1);
+    Advance();
+  }
+
+  ///
+  /// Gives back the unused rest of a block, e.g. when a client thread is
+  /// done, so the watermark does not stall behind numbers nobody inserts.
+  ///
+  void Release(Block &block) {
+    while (block.next != block.end) {
+      Acknowledge(block.next++);
+    }
+  }
+
+  ///
+  /// The largest key number such that it and all smaller ones are inserted.
+  ///
+  uint64_t Last() const {
+    return watermark_.load(std::memory_order_acquire) - 1;
+  }
+
+ private:
+  ///
+  /// Moves the watermark past every acknowledged number, lock-free. Each slot
+  /// holds key_num + 1 of the last number acknowledged in it, so a slot never
+  /// needs clearing and a stale value is never mistaken for a fresh ack.
+  /// Whoever loses the CAS rescans from the new watermark. The slot stores
+  /// and loads are sequentially consistent, so of two threads acknowledging
+  /// neighbouring numbers at least one sees the other's ack.
+  ///
+  void Advance() {
+    uint64_t mark = watermark_.load();
+    for (;;) {
+      uint64_t next = mark;
+      while (acked_[next & (kWindowSize - 1)].load() == next + 1) {
+        ++next;
+      }
+      if (next == mark) return;
+      if (watermark_.compare_exchange_weak(mark, next)) {
+        if (waiters_.load() > 0) {
+          std::lock_guard<std::mutex> lock(wait_mutex_);
+          window_cv_.notify_all();
+        }
+        mark = next;
+      }
+    }
+  }
+
+  void WaitForWindow(uint64_t key_num) {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    waiters_.fetch_add(1);
+    window_cv_.wait(lock, [&] {
+      return key_num - watermark_.load() < kWindowSize;
+    });
+    waiters_.fetch_sub(1);
+  }
+
+  std::atomic<uint64_t> counter_;
+  std::atomic<uint64_t> watermark_;
+  size_t block_size_;
+  std::unique_ptr<std::atomic<uint64_t>[]> acked_;
+  /// Threads waiting for the window to move
+  std::atomic<size_t> waiters_{0};
+  std::mutex wait_mutex_;
+  std::condition_variable window_cv_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_INSERT_KEY_SEQUENCE_H_
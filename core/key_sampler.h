@@ -0,0 +1,77 @@
+//
+//  key_sampler.h
+//  YCSB-C
+//
+//  Spatial (SHARDS-style) key sampling. A key is kept when its hash falls
+//  below rate * kModulus, so a sampled key keeps every one of its accesses
+//  and the other keys lose all of theirs. Per-key frequencies and reuse
+//  distances within the sample match the full stream, while the number of
+//  keys, the number of accesses and any cache size scale by the rate.
+//
+//  With samplerate=R the trace readers (text, compressed, multi-file,
+//  streaming and binary) still read the first max(recordcount,
+//  operationcount) raw requests and replay only the sampled ones. Synthetic
+//  workloads, including tracefitted and multi-tenant, load and request only
+//  sampled keys, and operationcount shrinks by R. keystats multiplies the
+//  separator capacities (capacity, and window_size for sketch_window) by R
+//  and writes <workload>_sampling.csv, from which parse_keystats.py scales
+//  key counts back by 1/R. Recall and precision are ratios and need no
+//  rescaling.
+//
+
+#ifndef YCSB_C_KEY_SAMPLER_H_
+#define YCSB_C_KEY_SAMPLER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "utils.h"
+
+namespace utils {
+
+class KeySampler {
+ public:
+  static const uint64_t kModulus = uint64_t(1) << 24;
+
+  explicit KeySampler(double rate = 1.0) {
+    if (!(rate > 0 && rate <= 1)) {
+      throw Exception("Sample rate must be in (0, 1]: " + std::to_string(rate));
+    }
+    threshold_ = std::max<uint64_t>(1, std::llround(rate * kModulus));
+  }
+
+  bool enabled() const { return threshold_ < kModulus; }
+  /// The effective rate, rounded to a multiple of 1 / kModulus
+  double rate() const { return double(threshold_) / kModulus; }
+
+  ///
+  /// Whether the key with this number, or with this hash for string keys,
+  /// is in the sample. The value is remixed first, so key numbers and
+  /// weak hashes sample as evenly as strong hashes.
+  ///
+  bool Sampled(uint64_t key) const {
+    return threshold_ == kModulus || (Mix(key) & (kModulus - 1)) < threshold_;
+  }
+
+  /// Scales a count of keys, accesses or cache entries down to the sample
+  uint64_t Scale(uint64_t count) const {
+    return enabled() ? std::llround(count * rate()) : count;
+  }
+
+ private:
+  /// The splitmix64 finalizer
+  static uint64_t Mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+
+  uint64_t threshold_;
+};
+
+} // utils
+
+#endif // YCSB_C_KEY_SAMPLER_H_
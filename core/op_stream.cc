@@ -0,0 +1,188 @@
+//
+//  op_stream.cc
+//  YCSB-C
+//
+
+#include "op_stream.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::string;
+
+namespace ycsbc {
+
+const string OpStream::WRITE_FILE_PROPERTY = "writeopsfile";
+const string OpStream::REPLAY_FILE_PROPERTY = "replayopsfile";
+
+const char OpStream::kMagic[8] = {'Y', 'C', 'S', 'B', 'O', 'P', 'S', '\0'};
+
+namespace {
+
+OpRecord NextLoadRecord(CoreWorkload &wl) {
+  OpRecord rec;
+  std::memset(&rec, 0, sizeof(rec));
+  rec.op = INSERT;
+  rec.key_id = wl.NextSequenceKeyId();
+  rec.length = wl.NextFieldLength();
+  return rec;
+}
+
+OpRecord NextRunRecord(CoreWorkload &wl, InsertKeySequence::Block &block) {
+  OpRecord rec;
+  std::memset(&rec, 0, sizeof(rec));
+  Operation op = wl.NextOperation();
+  rec.op = op;
+  switch (op) {
+    case INSERT:
+      rec.key_id = wl.NextInsertKeyId(block);
+      rec.length = wl.NextFieldLength();
+      wl.AcknowledgeInsert(rec.key_id);
+      break;
+    case SCAN:
+      rec.key_id = wl.NextTransactionKeyId();
+      rec.length = wl.NextScanLength();
+      rec.field = wl.NextFieldIndex();
+      break;
+    case READ:
+      rec.key_id = wl.NextTransactionKeyId();
+      rec.field = wl.NextFieldIndex();
+      break;
+    default:  // UPDATE, READMODIFYWRITE
+      rec.key_id = wl.NextTransactionKeyId();
+      rec.field = wl.NextFieldIndex();
+      rec.length = wl.NextFieldLength();
+      break;
+  }
+  return rec;
+}
+
+} // namespace
+
+bool OpStream::Write(const string &path, CoreWorkload &wl,
+                     size_t thread_count, uint64_t load_ops,
+                     uint64_t run_ops) {
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    YCSB_C_LOG_ERROR("Cannot open op stream file: %s", path.c_str());
+    return false;
+  }
+  std::vector<char> buffer(1 << 20);
+  std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.thread_count = thread_count;
+
+  // All load partitions first, then all run partitions, so key numbers of
+  // the load phase are generated in thread order.
+  std::vector<Partition> partitions(thread_count * 2);
+  uint64_t offset = sizeof(Header) + sizeof(Partition) * partitions.size();
+  for (int phase = kLoad; phase <= kRun; ++phase) {
+    uint64_t per_thread = (phase == kLoad ? load_ops : run_ops) / thread_count;
+    for (size_t t = 0; t < thread_count; ++t) {
+      partitions[t * 2 + phase] = {offset, per_thread};
+      offset += per_thread * sizeof(OpRecord);
+    }
+  }
+
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+      std::fwrite(partitions.data(), sizeof(Partition), partitions.size(),
+                  file) == partitions.size();
+  for (int phase = kLoad; ok && phase <= kRun; ++phase) {
+    for (size_t t = 0; ok && t < thread_count; ++t) {
+      InsertKeySequence::Block block;
+      uint64_t count = partitions[t * 2 + phase].count;
+      for (uint64_t i = 0; ok && i < count; ++i) {
+        OpRecord rec = (phase == kLoad ? NextLoadRecord(wl) :
+            NextRunRecord(wl, block));
+        ok = std::fwrite(&rec, sizeof(rec), 1, file) == 1;
+      }
+      wl.ReleaseInsertBlock(block);
+    }
+  }
+  if (std::fclose(file) != 0) ok = false;
+  if (!ok) {
+    YCSB_C_LOG_ERROR("Write op stream file failed: %s", path.c_str());
+  }
+  return ok;
+}
+
+bool OpStream::Open(const string &path) {
+  Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    YCSB_C_LOG_ERROR("Cannot open op stream file: %s", path.c_str());
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+    YCSB_C_LOG_ERROR("Invalid op stream file: %s", path.c_str());
+    close(fd);
+    return false;
+  }
+  void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    YCSB_C_LOG_ERROR("mmap op stream file failed: %s", path.c_str());
+    return false;
+  }
+  data_ = static_cast<const char *>(addr);
+  size_ = st.st_size;
+
+  Header header;
+  std::memcpy(&header, data_, sizeof(header));
+  size_t table_end = sizeof(Header) + sizeof(Partition) * header.thread_count * 2;
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.thread_count == 0 ||
+      table_end > size_) {
+    YCSB_C_LOG_ERROR("Invalid op stream file: %s", path.c_str());
+    Close();
+    return false;
+  }
+  thread_count_ = header.thread_count;
+  partitions_.resize(thread_count_ * 2);
+  std::memcpy(partitions_.data(), data_ + sizeof(Header),
+              sizeof(Partition) * partitions_.size());
+  for (auto &part : partitions_) {
+    if (part.offset + part.count * sizeof(OpRecord) > size_) {
+      YCSB_C_LOG_ERROR("Truncated op stream file: %s", path.c_str());
+      Close();
+      return false;
+    }
+  }
+  madvise(const_cast<char *>(data_), size_, MADV_SEQUENTIAL);
+  return true;
+}
+
+void OpStream::Close() {
+  if (data_) {
+    munmap(const_cast<char *>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  thread_count_ = 0;
+  partitions_.clear();
+}
+
+const OpRecord *OpStream::Records(size_t thread_id, Phase phase,
+                                  size_t *count) const {
+  const Partition &part = partitions_.at(thread_id * 2 + phase);
+  *count = part.count;
+  return reinterpret_cast<const OpRecord *>(data_ + part.offset);
+}
+
+uint64_t OpStream::TotalRecords(Phase phase) const {
+  uint64_t total = 0;
+  for (size_t t = 0; t < thread_count_; ++t) {
+    total += partitions_[t * 2 + phase].count;
+  }
+  return total;
+}
+
+} // ycsbc
@@ -0,0 +1,100 @@
+//
+//  op_stream.h
+//  YCSB-C
+//
+//  Pre-materialized operation streams: the full operation sequence of a
+//  workload spec, written once to a compact binary file partitioned per
+//  client thread, and replayed later through mmap with no generation cost.
+//  -writeops <file> writes the stream of the spec for -threads partitions
+//  and exits; -replayops <file> replays it, so different backends run
+//  exactly the same operations.
+//
+
+#ifndef YCSB_C_OP_STREAM_H_
+#define YCSB_C_OP_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core_workload.h"
+
+namespace ycsbc {
+
+///
+/// One pre-generated operation, stored as-is in the stream file.
+///
+struct OpRecord {
+  uint64_t key_id;    /// Key number, formatted through the key format on replay
+  uint32_t length;    /// Field length for writes, record count for scans
+  uint8_t op;         /// ycsbc::Operation
+  uint8_t reserved;
+  uint16_t field;     /// Field index for single-field reads/updates
+};
+
+static_assert(sizeof(OpRecord) == 16, "OpRecord must stay 16 bytes");
+
+class OpStream {
+ public:
+  ///
+  /// The name of the property for the file to write the operation stream of
+  /// the loaded spec to. The run exits after the file is written.
+  ///
+  static const std::string WRITE_FILE_PROPERTY;
+  ///
+  /// The name of the property for an operation stream file to replay instead
+  /// of generating operations from the spec.
+  ///
+  static const std::string REPLAY_FILE_PROPERTY;
+
+  enum Phase {
+    kLoad = 0,
+    kRun = 1
+  };
+
+  ///
+  /// Generates load_ops load records and run_ops transactions from the
+  /// workload, split evenly over thread_count partitions, and writes them to
+  /// path. Single threaded, so the same spec always yields the same file.
+  ///
+  static bool Write(const std::string &path, CoreWorkload &wl,
+                    size_t thread_count, uint64_t load_ops, uint64_t run_ops);
+
+  OpStream() : data_(nullptr), size_(0), thread_count_(0) { }
+  ~OpStream() { Close(); }
+
+  ///
+  /// Maps a stream file read-only. Returns false if it is missing or malformed.
+  ///
+  bool Open(const std::string &path);
+  void Close();
+
+  size_t thread_count() const { return thread_count_; }
+  const OpRecord *Records(size_t thread_id, Phase phase, size_t *count) const;
+  uint64_t TotalRecords(Phase phase) const;
+
+ private:
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t thread_count;
+  };
+
+  struct Partition {
+    uint64_t offset; /// Byte offset of the first record in the file
+    uint64_t count;  /// Number of records
+  };
+
+  static const char kMagic[8];
+  static const uint32_t kVersion = 1;
+
+  const char *data_;
+  size_t size_;
+  size_t thread_count_;
+  /// Indexed by thread_id * 2 + phase
+  std::vector<Partition> partitions_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_OP_STREAM_H_
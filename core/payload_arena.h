@@ -0,0 +1,92 @@
+//
+//  payload_arena.h
+//  YCSB-C
+//
+//  A process-wide buffer of random printable bytes that value payloads are
+//  sliced from, so building a value costs a random offset instead of an
+//  allocation and a fill. Slices are views that stay valid for the lifetime
+//  of the process: the arena only ever grows by publishing a larger buffer,
+//  and earlier buffers are kept.
+//
+
+#ifndef YCSB_C_PAYLOAD_ARENA_H_
+#define YCSB_C_PAYLOAD_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "utils.h"
+
+namespace ycsbc {
+
+class PayloadArena {
+ public:
+  static const size_t kDefaultSize = 1 << 20;
+
+  ///
+  /// The arena shared by all workloads and client threads.
+  ///
+  static PayloadArena &Default() {
+    static PayloadArena arena(kDefaultSize);
+    return arena;
+  }
+
+  explicit PayloadArena(size_t size) : current_(nullptr) { Grow(size); }
+
+  ///
+  /// Makes sure slices of up to length bytes are served without growing.
+  /// Called in the main thread when the largest value size is known.
+  ///
+  void Reserve(size_t length) {
+    if (length * 2 > current_.load(std::memory_order_acquire)->size) {
+      Grow(length * 2);
+    }
+  }
+
+  ///
+  /// Returns length random bytes starting at a random offset.
+  ///
+  std::string_view Slice(size_t length) {
+    const Buffer *buffer = current_.load(std::memory_order_acquire);
+    if (length * 2 > buffer->size) {
+      buffer = Grow(length * 2);
+    }
+    size_t offset = utils::ThreadLocalRandomDouble() * (buffer->size - length);
+    return std::string_view(buffer->data.get() + offset, length);
+  }
+
+ private:
+  struct Buffer {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  const Buffer *Grow(size_t size) {
+    std::lock_guard<std::mutex> lock(grow_mutex_);
+    const Buffer *current = current_.load(std::memory_order_relaxed);
+    if (current && current->size >= size) return current;
+
+    std::unique_ptr<Buffer> buffer(new Buffer);
+    buffer->size = current ? std::max(size, current->size * 2) : size;
+    buffer->data.reset(new char[buffer->size]);
+    for (size_t i = 0; i < buffer->size; ++i) {
+      buffer->data[i] = utils::RandomPrintChar();
+    }
+    const Buffer *published = buffer.get();
+    buffers_.push_back(std::move(buffer));
+    current_.store(published, std::memory_order_release);
+    return published;
+  }
+
+  std::atomic<const Buffer *> current_;
+  std::mutex grow_mutex_;
+  /// Every buffer ever published; slices of old ones must stay valid
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_PAYLOAD_ARENA_H_
@@ -30,6 +30,7 @@ class ScrambledZipfianGenerator : public Generator<uint64_t> {
   
   uint64_t Next();
   uint64_t Last();
+  void NextBatch(uint64_t *out, size_t n);
   
  private:
   const uint64_t base_;
@@ -47,6 +48,14 @@ inline uint64_t ScrambledZipfianGenerator::Next() {
   return Scramble(generator_.Next());
 }
 
+inline void ScrambledZipfianGenerator::NextBatch(uint64_t *out, size_t n) {
+  generator_.NextBatch(out, n);
+  utils::FNVHash64Batch(out, n);
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = base_ + out[i] % num_items_;
+  }
+}
+
 inline uint64_t ScrambledZipfianGenerator::Last() {
   return Scramble(generator_.Last());
 }
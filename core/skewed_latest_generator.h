@@ -12,30 +12,122 @@
 #include "generator.h"
 
 #include <atomic>
+#include <cmath>
 #include <cstdint>
-#include "counter_generator.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "insert_key_sequence.h"
 #include "zipfian_generator.h"
 
 namespace ycsbc {
 
+///
+/// Zipfian over the distance from the latest inserted key. Draws take no
+/// lock: each thread uses its own random engine and reads the zipfian
+/// parameters through an atomic pointer. The parameters are rebuilt only when
+/// the inserted key count has grown by 1 / 2^kRefreshShift since the last
+/// rebuild, and zeta is extended in O(1) instead of summed per new key.
+///
 class SkewedLatestGenerator : public Generator<uint64_t> {
  public:
-  SkewedLatestGenerator(CounterGenerator &counter) :
-      basis_(counter), zipfian_(basis_.Last()) {
-    Next();
-  }
-  
+  SkewedLatestGenerator(InsertKeySequence &sequence,
+                        double zipfian_const = ZipfianGenerator::kZipfianConst);
+
   uint64_t Next();
   uint64_t Last() { return last_; }
+
  private:
-  CounterGenerator &basis_;
-  ZipfianGenerator zipfian_;
+  /// Zipfian parameters for a fixed number of items, immutable once published
+  struct Params {
+    uint64_t num_items;
+    double zeta_n;
+    double eta;
+  };
+
+  static const int kRefreshShift = 10;
+
+  const Params *Refresh(uint64_t num_items);
+  double Zeta(uint64_t num_items);
+
+  InsertKeySequence &basis_;
+  const double theta_, alpha_, half_pow_theta_;
+  double zeta_2_;
+  uint64_t exact_items_; /// Number of items summed into exact_zeta_
+  double exact_zeta_;
+  std::atomic<const Params *> params_;
+  std::mutex refresh_mutex_;
+  /// Every published Params, kept alive for threads still reading old ones
+  std::vector<std::unique_ptr<Params>> all_params_;
   std::atomic<uint64_t> last_;
 };
 
+inline SkewedLatestGenerator::SkewedLatestGenerator(
+    InsertKeySequence &sequence, double zipfian_const) :
+    basis_(sequence), theta_(zipfian_const), alpha_(1.0 / (1.0 - theta_)),
+    half_pow_theta_(std::pow(0.5, theta_)), exact_items_(0), exact_zeta_(0),
+    params_(nullptr), last_(0) {
+  zeta_2_ = 1 + half_pow_theta_;
+  Refresh(basis_.Last());
+  Next();
+}
+
 inline uint64_t SkewedLatestGenerator::Next() {
   uint64_t max = basis_.Last();
-  return last_ = max - zipfian_.Next(max);
+  const Params *params = params_.load(std::memory_order_acquire);
+  uint64_t num = params->num_items;
+  if (max >= num + std::max<uint64_t>(1, num >> kRefreshShift)) {
+    params = Refresh(max);
+    num = params->num_items;
+  }
+  // The item count may lag max by a little; offsets stay within [0, max]
+  if (num < 2) return last_ = max;
+
+  double u = utils::ThreadLocalRandomDouble();
+  double uz = u * params->zeta_n;
+  uint64_t offset;
+  if (uz < 1.0) {
+    offset = 0;
+  } else if (uz < 1.0 + half_pow_theta_) {
+    offset = 1;
+  } else {
+    offset = num * std::pow(params->eta * u - params->eta + 1, alpha_);
+  }
+  return last_ = max - std::min(offset, max);
+}
+
+inline const SkewedLatestGenerator::Params *SkewedLatestGenerator::Refresh(
+    uint64_t num_items) {
+  std::lock_guard<std::mutex> lock(refresh_mutex_);
+  const Params *current = params_.load(std::memory_order_relaxed);
+  if (current && current->num_items >= num_items) return current;
+
+  std::unique_ptr<Params> params(new Params);
+  params->num_items = num_items;
+  params->zeta_n = Zeta(num_items);
+  params->eta = (1 - std::pow(2.0 / num_items, 1 - theta_)) /
+      (1 - zeta_2_ / params->zeta_n);
+  const Params *published = params.get();
+  all_params_.push_back(std::move(params));
+  params_.store(published, std::memory_order_release);
+  return published;
+}
+
+///
+/// Called under refresh_mutex_ with a non-decreasing num_items. Sums the
+/// first kExactItems terms exactly (incrementally), then adds the rest in
+/// closed form.
+///
+inline double SkewedLatestGenerator::Zeta(uint64_t num_items) {
+  const uint64_t kExactItems = ZipfianGenerator::kExactItems;
+  uint64_t exact_end = num_items < kExactItems ? num_items : kExactItems;
+  for (uint64_t i = exact_items_ + 1; i <= exact_end; ++i) {
+    exact_zeta_ += 1 / std::pow(i, theta_);
+  }
+  exact_items_ = std::max(exact_items_, exact_end);
+  if (num_items <= exact_items_) return exact_zeta_;
+  return exact_zeta_ + ZipfianGenerator::ZetaTail(exact_items_, num_items,
+                                                  theta_);
 }
 
 } // ycsbc
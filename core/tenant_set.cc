@@ -0,0 +1,174 @@
+//
+//  tenant_set.cc
+//  YCSB-C
+//
+
+#include "tenant_set.h"
+
+#include <algorithm>
+#include <fstream>
+
+using std::string;
+
+namespace ycsbc {
+
+const string TenantSet::TENANT_COUNT_PROPERTY = "tenantcount";
+const string TenantSet::TENANT_COUNT_DEFAULT = "0";
+
+const string TenantSet::TENANT_THREADS_PROPERTY = "tenantthreads";
+const string TenantSet::TENANT_THREADS_DEFAULT = "interleave";
+
+const string TenantSet::TENANT_PROPERTY_PREFIX = "tenant.";
+const string TenantSet::SPEC_PROPERTY = "spec";
+const string TenantSet::WEIGHT_PROPERTY = "weight";
+
+bool TenantSet::Init(const utils::Properties &p, size_t num_threads) {
+  size_t count = std::stoul(p.GetProperty(TENANT_COUNT_PROPERTY,
+                                          TENANT_COUNT_DEFAULT));
+  if (count == 0) return false;
+  if (count > (size_t(1) << (64 - DB::kTenantShift))) {
+    throw utils::Exception("Too many tenants: " + std::to_string(count));
+  }
+
+  string mode = p.GetProperty(TENANT_THREADS_PROPERTY, TENANT_THREADS_DEFAULT);
+  if (mode == "interleave") {
+    dedicated_ = false;
+  } else if (mode == "dedicated") {
+    dedicated_ = true;
+  } else {
+    throw utils::Exception("Unknown tenant thread mode: " + mode);
+  }
+  num_threads_ = num_threads;
+  operation_count_ = std::stoull(p.GetProperty(
+      CoreWorkload::OPERATION_COUNT_PROPERTY));
+  const utils::KeySampler sampler(std::stod(p.GetProperty(
+      CoreWorkload::SAMPLE_RATE_PROPERTY, CoreWorkload::SAMPLE_RATE_DEFAULT)));
+
+  // Properties given for each tenant only: its spec file, then overrides
+  std::vector<utils::Properties> own(count);
+  double total_weight = 0;
+  tenants_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const string prefix = TENANT_PROPERTY_PREFIX + std::to_string(i) + ".";
+    const string spec = p.GetProperty(prefix + SPEC_PROPERTY);
+    if (!spec.empty()) {
+      std::ifstream input(spec);
+      if (!input.is_open()) {
+        throw utils::Exception("Cannot open tenant spec: " + spec);
+      }
+      own[i].Load(input);
+    }
+    for (const auto &prop : p.properties()) {
+      if (prop.first.compare(0, prefix.size(), prefix) == 0) {
+        own[i].SetProperty(prop.first.substr(prefix.size()), prop.second);
+      }
+    }
+    tenants_[i].name = "tenant" + std::to_string(i);
+    tenants_[i].weight = std::stod(own[i].GetProperty(WEIGHT_PROPERTY, "1"));
+    if (!(tenants_[i].weight > 0)) {
+      throw utils::Exception("Tenant weight must be positive: " +
+          tenants_[i].name);
+    }
+    total_weight += tenants_[i].weight;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    Tenant &tenant = tenants_[i];
+    utils::Properties props = p;
+    for (const auto &prop : own[i].properties()) {
+      if (prop.first != SPEC_PROPERTY && prop.first != WEIGHT_PROPERTY) {
+        props.SetProperty(prop.first, prop.second);
+      }
+    }
+    // Tenants share one store, so their key spaces must not overlap
+    if (own[i].GetProperty(CoreWorkload::KEY_PREFIX_PROPERTY).empty()) {
+      props.SetProperty(CoreWorkload::KEY_PREFIX_PROPERTY,
+                        "user" + std::to_string(i) + "_");
+    }
+    tenant.operation_count = operation_count_ * tenant.weight / total_weight;
+    props.SetProperty(CoreWorkload::OPERATION_COUNT_PROPERTY,
+                      std::to_string(tenant.operation_count));
+    tenant.record_count = std::stoull(props.GetProperty(
+        CoreWorkload::RECORD_COUNT_PROPERTY));
+
+    tenant.workload.reset(new CoreWorkload());
+    tenant.workload->Init(props);
+    tenant.workload->SetKeyIdBase(uint64_t(i) << DB::kTenantShift);
+    // A sampled tenant loads and runs only its share of the sample
+    tenant.record_count = tenant.workload->load_count();
+    tenant.operation_count =
+        tenant.workload->sampler().Scale(tenant.operation_count);
+  }
+  operation_count_ = sampler.Scale(operation_count_);
+
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < count; ++j) {
+      const string &a = tenants_[i].workload->key_format().prefix;
+      const string &b = tenants_[j].workload->key_format().prefix;
+      if (i != j && b.compare(0, a.size(), a) == 0) {
+        throw utils::Exception("Key prefix of " + tenants_[i].name +
+            " overlaps with " + tenants_[j].name + ": " + a);
+      }
+    }
+  }
+
+  double sum = 0;
+  for (const auto &tenant : tenants_) {
+    sum += tenant.weight;
+    cumulative_weights_.push_back(sum);
+  }
+  if (dedicated_) AssignThreads();
+  return true;
+}
+
+///
+/// Every tenant gets one thread, the rest go one by one to the tenant with
+/// the largest weight per thread.
+///
+void TenantSet::AssignThreads() {
+  if (num_threads_ < tenants_.size()) {
+    throw utils::Exception("Dedicated tenant threads need at least " +
+        std::to_string(tenants_.size()) + " threads");
+  }
+  tenant_threads_.assign(tenants_.size(), 1);
+  for (size_t t = tenants_.size(); t < num_threads_; ++t) {
+    size_t best = 0;
+    for (size_t i = 1; i < tenants_.size(); ++i) {
+      if (tenants_[i].weight / tenant_threads_[i] >
+          tenants_[best].weight / tenant_threads_[best]) {
+        best = i;
+      }
+    }
+    ++tenant_threads_[best];
+  }
+  thread_tenants_.clear();
+  for (size_t i = 0; i < tenants_.size(); ++i) {
+    thread_tenants_.insert(thread_tenants_.end(), tenant_threads_[i], i);
+  }
+}
+
+size_t TenantSet::PickTenant() const {
+  double chooser = utils::ThreadLocalRandomDouble() * cumulative_weights_.back();
+  size_t i = std::upper_bound(cumulative_weights_.begin(),
+                              cumulative_weights_.end(), chooser) -
+      cumulative_weights_.begin();
+  return std::min(i, tenants_.size() - 1);
+}
+
+uint64_t TenantSet::RunOperations(size_t thread_id) const {
+  if (!dedicated_) {
+    return operation_count_ / num_threads_;
+  }
+  size_t tenant = thread_tenants_[thread_id];
+  return tenants_[tenant].operation_count / tenant_threads_[tenant];
+}
+
+std::vector<DB::KeyFormat> TenantSet::key_formats() const {
+  std::vector<DB::KeyFormat> formats;
+  for (const auto &tenant : tenants_) {
+    formats.push_back(tenant.workload->key_format());
+  }
+  return formats;
+}
+
+} // ycsbc
@@ -0,0 +1,112 @@
+//
+//  tenant_set.h
+//  YCSB-C
+//
+//  Several workload specs run side by side in one process, one CoreWorkload
+//  per tenant. Each tenant has its own key prefix (and, in integer key mode,
+//  its index in the top bits of the key id), distribution, op mix and weight.
+//  Tenant i's keys are prefixed "user<i>_" unless keyprefix is set. The
+//  driver reports latency per tenant, and keystats writes
+//  <workload>_tenant_stats.csv with each tenant's true hot keys and the hot
+//  keys and hits of every separator.
+//
+
+#ifndef YCSB_C_TENANT_SET_H_
+#define YCSB_C_TENANT_SET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core_workload.h"
+#include "db.h"
+#include "properties.h"
+
+namespace ycsbc {
+
+class TenantSet {
+ public:
+  ///
+  /// The name of the property for the number of tenants. With 0 the run uses
+  /// the single workload of the main spec.
+  ///
+  static const std::string TENANT_COUNT_PROPERTY;
+  static const std::string TENANT_COUNT_DEFAULT;
+
+  ///
+  /// The name of the property for how client threads serve tenants.
+  /// Options are "interleave" (every thread picks a tenant per operation by
+  /// weight) and "dedicated" (threads are split among tenants by weight).
+  ///
+  static const std::string TENANT_THREADS_PROPERTY;
+  static const std::string TENANT_THREADS_DEFAULT;
+
+  ///
+  /// Per-tenant properties are named "tenant.<i>.<name>". "spec" loads a
+  /// property file for the tenant on top of the main spec, "weight" sets its
+  /// share of the operations (default 1), and any other name overrides that
+  /// workload property, e.g. "tenant.1.requestdistribution=uniform".
+  ///
+  static const std::string TENANT_PROPERTY_PREFIX;
+  static const std::string SPEC_PROPERTY;
+  static const std::string WEIGHT_PROPERTY;
+
+  struct Tenant {
+    std::string name;
+    double weight;
+    uint64_t record_count;
+    uint64_t operation_count;  /// Share of the run phase operations
+    std::unique_ptr<CoreWorkload> workload;
+  };
+
+  TenantSet() : dedicated_(false), num_threads_(0) { }
+
+  ///
+  /// Builds the tenant workloads. Returns false if the properties define no
+  /// tenants; throws utils::Exception on an invalid tenant setup.
+  ///
+  bool Init(const utils::Properties &p, size_t num_threads);
+
+  size_t size() const { return tenants_.size(); }
+  Tenant &tenant(size_t i) { return tenants_[i]; }
+  const Tenant &tenant(size_t i) const { return tenants_[i]; }
+  bool dedicated() const { return dedicated_; }
+
+  ///
+  /// Picks the tenant of the next operation by weight, without locking.
+  ///
+  size_t PickTenant() const;
+  ///
+  /// The tenant a thread serves in dedicated mode.
+  ///
+  size_t ThreadTenant(size_t thread_id) const { return thread_tenants_[thread_id]; }
+  ///
+  /// Records of a tenant each thread loads.
+  ///
+  uint64_t LoadOperations(size_t tenant) const {
+    return tenants_[tenant].record_count / num_threads_;
+  }
+  ///
+  /// Transactions a thread runs, over all tenants it serves.
+  ///
+  uint64_t RunOperations(size_t thread_id) const;
+
+  /// Key formats indexed by tenant, for DB::SetTenantKeyFormats
+  std::vector<DB::KeyFormat> key_formats() const;
+
+ private:
+  void AssignThreads();
+
+  std::vector<Tenant> tenants_;
+  std::vector<double> cumulative_weights_;
+  bool dedicated_;
+  size_t num_threads_;
+  uint64_t operation_count_;
+  std::vector<size_t> thread_tenants_;
+  std::vector<size_t> tenant_threads_;  /// Number of threads per tenant
+};
+
+} // ycsbc
+
+#endif // YCSB_C_TENANT_SET_H_
@@ -0,0 +1,382 @@
+//
+//  trace_fitted_workload.cc
+//  YCSB-C
+//
+
+#include "trace_fitted_workload.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include "payload_arena.h"
+#include "twitter_trace_workload.h"
+#include "modules/twitter_trace_reader.h"
+
+using std::string;
+using std::vector;
+
+namespace ycsbc {
+
+const string TraceFittedWorkload::WORKLOAD_NAME = "tracefitted";
+
+const string TraceFittedWorkload::TRACE_FILE_PROPERTY = "tracefile";
+
+const string TraceFittedWorkload::FIT_REQUESTS_PROPERTY = "tracefitrequests";
+const string TraceFittedWorkload::FIT_REQUESTS_DEFAULT = "1000000";
+
+const string TraceFittedWorkload::MODEL_FILE_PROPERTY = "tracemodelfile";
+
+const string TraceFittedWorkload::KEY_SCALE_PROPERTY = "tracekeyscale";
+const string TraceFittedWorkload::KEY_SCALE_DEFAULT = "1.0";
+
+const string TraceFittedWorkload::REUSE_WINDOW_PROPERTY = "tracereusewindow";
+const string TraceFittedWorkload::REUSE_WINDOW_DEFAULT = "4096";
+
+namespace {
+
+/// Ranks below this get a popularity bucket each, beyond it buckets grow
+/// geometrically so the curve stays small for millions of keys
+const uint64_t kExactRanks = 64;
+const double kRankGrowth = 1.0625;
+
+const char kModelMagic[] = "tracefitted";
+const int kModelVersion = 1;
+
+std::atomic<uint64_t> g_instance_count(0);
+
+Operation TraceOperation(module::TwitterTraceOperation op) {
+  // The replay mapping, except that deletes count as writes: the model only
+  // synthesizes operations on live keys
+  Operation mapped = TwitterTraceWorkload::MapOperation(op);
+  return mapped == DELETE ? UPDATE : mapped;
+}
+
+vector<uint32_t> Quantiles(vector<uint32_t> &samples, size_t n) {
+  vector<uint32_t> quantiles(n + 1, 0);
+  if (samples.empty()) return quantiles;
+  std::sort(samples.begin(), samples.end());
+  for (size_t i = 0; i <= n; ++i) {
+    quantiles[i] = samples[(samples.size() - 1) * i / n];
+  }
+  return quantiles;
+}
+
+uint32_t SampleQuantiles(const vector<uint32_t> &quantiles, double u) {
+  double pos = u * (quantiles.size() - 1);
+  size_t i = pos;
+  if (i + 1 >= quantiles.size()) return quantiles.back();
+  return quantiles[i] + (pos - i) * (quantiles[i + 1] - quantiles[i]);
+}
+
+size_t SampleCdf(const vector<double> &cdf, double u) {
+  size_t i = std::upper_bound(cdf.begin(), cdf.end(), u * cdf.back()) -
+      cdf.begin();
+  return std::min(i, cdf.size() - 1);
+}
+
+template <typename T>
+void WriteVector(std::ostream &output, const char *name,
+                 const vector<T> &values) {
+  output << name << ' ' << values.size();
+  for (const T &value : values) output << ' ' << value;
+  output << '\n';
+}
+
+template <typename T>
+bool ReadVector(std::istream &input, const char *name, vector<T> *values) {
+  string tag;
+  size_t size;
+  if (!(input >> tag >> size) || tag != name) return false;
+  values->resize(size);
+  for (T &value : *values) {
+    if (!(input >> value)) return false;
+  }
+  return true;
+}
+
+} // namespace
+
+///
+/// Generator state owned by one client thread: the ring of recently drawn
+/// keys that reuse is sampled from.
+///
+struct TraceFittedWorkload::ThreadState {
+  vector<uint64_t> recent;
+  size_t next = 0;    /// Slot the next key goes to
+  size_t filled = 0;  /// Valid slots, up to recent.size()
+};
+
+TraceFittedWorkload::TraceFittedWorkload()
+    : key_scale_(1.0), key_space_(0), reuse_mix_(0),
+      instance_id_(g_instance_count.fetch_add(1) + 1) {
+}
+
+TraceFittedWorkload::Model TraceFittedWorkload::Fit(
+    const vector<module::Request> &requests, size_t key_count,
+    uint32_t reuse_window) {
+  struct KeyInfo {
+    uint64_t count = 0;
+    uint64_t last = 0;
+  };
+  Model model;
+  model.reuse_window = reuse_window;
+  model.op_cdf.assign(READMODIFYWRITE + 1, 0);
+  model.reuse_cdf.assign(reuse_window ? std::log2(reuse_window) + 1 : 0, 0);
+
+  // Trace keys are interned, so per-key state is indexed by key id
+  vector<KeyInfo> keys(key_count);
+  vector<uint32_t> key_sizes, value_sizes;
+  key_sizes.reserve(requests.size());
+  value_sizes.reserve(requests.size());
+  uint64_t reused = 0;
+  for (uint64_t i = 0; i < requests.size(); ++i) {
+    const module::Request &req = requests[i];
+    KeyInfo &info = keys[req.key_id];
+    if (info.count > 0 && i - info.last <= reuse_window) {
+      ++model.reuse_cdf[std::log2(i - info.last)];
+      ++reused;
+    }
+    ++info.count;
+    info.last = i;
+    ++model.op_cdf[TraceOperation(req.operation)];
+    key_sizes.push_back(req.key_size ? req.key_size : req.anonymized_key.size());
+    value_sizes.push_back(req.value_size);
+  }
+  // Popularity curve over ranks, most requested key first
+  vector<uint64_t> counts;
+  counts.reserve(keys.size());
+  for (const auto &key : keys) {
+    if (key.count > 0) counts.push_back(key.count);
+  }
+  vector<KeyInfo>().swap(keys);
+  model.num_keys = counts.size();
+  std::sort(counts.begin(), counts.end(), std::greater<uint64_t>());
+  double total = 0;
+  uint64_t lo = 0;
+  model.rank_bounds.push_back(0);
+  while (lo < counts.size()) {
+    uint64_t hi = lo < kExactRanks ? lo + 1 :
+        std::max<uint64_t>(lo + 1, std::ceil(lo * kRankGrowth));
+    hi = std::min<uint64_t>(hi, counts.size());
+    for (uint64_t r = lo; r < hi; ++r) total += counts[r];
+    model.rank_bounds.push_back(hi);
+    model.rank_cdf.push_back(total);
+    lo = hi;
+  }
+  for (double &p : model.rank_cdf) p /= total;
+
+  for (size_t i = 1; i < model.op_cdf.size(); ++i) {
+    model.op_cdf[i] += model.op_cdf[i - 1];
+  }
+  for (size_t i = 1; i < model.reuse_cdf.size(); ++i) {
+    model.reuse_cdf[i] += model.reuse_cdf[i - 1];
+  }
+  model.reuse_share = requests.empty() ? 0 : double(reused) / requests.size();
+  model.key_size_quantiles = Quantiles(key_sizes, kQuantiles);
+  model.value_size_quantiles = Quantiles(value_sizes, kQuantiles);
+  return model;
+}
+
+bool TraceFittedWorkload::SaveModel(const Model &model, const string &path) {
+  std::ofstream output(path);
+  if (!output.is_open()) {
+    YCSB_C_LOG_ERROR("Cannot write trace model: %s", path.c_str());
+    return false;
+  }
+  output.precision(17);
+  output << kModelMagic << ' ' << kModelVersion << '\n';
+  output << "keys " << model.num_keys << '\n';
+  WriteVector(output, "rank_bounds", model.rank_bounds);
+  WriteVector(output, "rank_cdf", model.rank_cdf);
+  WriteVector(output, "op_cdf", model.op_cdf);
+  WriteVector(output, "key_sizes", model.key_size_quantiles);
+  WriteVector(output, "value_sizes", model.value_size_quantiles);
+  output << "reuse " << model.reuse_window << ' ' << model.reuse_share << '\n';
+  WriteVector(output, "reuse_cdf", model.reuse_cdf);
+  return bool(output);
+}
+
+bool TraceFittedWorkload::LoadModel(const string &path, Model *model) {
+  std::ifstream input(path);
+  if (!input.is_open()) return false;
+  string magic, tag;
+  int version;
+  if (!(input >> magic >> version) || magic != kModelMagic ||
+      version != kModelVersion) {
+    throw utils::Exception("Not a trace model: " + path);
+  }
+  bool ok = (input >> tag >> model->num_keys) && tag == "keys" &&
+      ReadVector(input, "rank_bounds", &model->rank_bounds) &&
+      ReadVector(input, "rank_cdf", &model->rank_cdf) &&
+      ReadVector(input, "op_cdf", &model->op_cdf) &&
+      ReadVector(input, "key_sizes", &model->key_size_quantiles) &&
+      ReadVector(input, "value_sizes", &model->value_size_quantiles) &&
+      (input >> tag >> model->reuse_window >> model->reuse_share) &&
+      tag == "reuse" &&
+      ReadVector(input, "reuse_cdf", &model->reuse_cdf);
+  if (!ok || model->rank_cdf.empty() ||
+      model->rank_bounds.size() != model->rank_cdf.size() + 1 ||
+      model->op_cdf.size() != READMODIFYWRITE + 1 ||
+      model->key_size_quantiles.size() < 2 ||
+      model->value_size_quantiles.size() < 2) {
+    throw utils::Exception("Malformed trace model: " + path);
+  }
+  return true;
+}
+
+void TraceFittedWorkload::Init(const utils::Properties &p) {
+  const string model_file = p.GetProperty(MODEL_FILE_PROPERTY);
+  if (model_file.empty() || !LoadModel(model_file, &model_)) {
+    const string trace_file = p.GetProperty(TRACE_FILE_PROPERTY);
+    if (trace_file.empty()) {
+      throw utils::Exception("Trace-fitted workload needs " +
+          TRACE_FILE_PROPERTY + " or an existing " + MODEL_FILE_PROPERTY);
+    }
+    size_t limit = std::stoull(p.GetProperty(FIT_REQUESTS_PROPERTY,
+                                             FIT_REQUESTS_DEFAULT));
+    module::TwitterTraceReader reader(trace_file, 1, 0, limit);
+    reader.MaterializeRequests();
+    model_ = Fit(reader.GetTraceRequests(), reader.GetKeyCount(),
+                 std::stoul(p.GetProperty(REUSE_WINDOW_PROPERTY,
+                                          REUSE_WINDOW_DEFAULT)));
+    if (model_.num_keys == 0) {
+      throw utils::Exception("No requests to fit in trace: " + trace_file);
+    }
+    if (!model_file.empty()) SaveModel(model_, model_file);
+  } else {
+    YCSB_C_LOG_INFO("Loaded trace model: %s", model_file.c_str());
+  }
+
+  key_scale_ = std::stod(p.GetProperty(KEY_SCALE_PROPERTY, KEY_SCALE_DEFAULT));
+  if (!(key_scale_ > 0)) {
+    throw utils::Exception("Invalid " + KEY_SCALE_PROPERTY + ": " +
+        p.GetProperty(KEY_SCALE_PROPERTY));
+  }
+  key_space_ = std::max<uint64_t>(1, std::llround(model_.num_keys * key_scale_));
+
+  // Popularity alone already brings keys back within the window now and
+  // then; only the excess over that is drawn from the recent keys
+  const double independent = IndependentReuseShare();
+  reuse_mix_ = independent < 1 ?
+      (model_.reuse_share - independent) / (1 - independent) : 0;
+  reuse_mix_ = std::min(std::max(reuse_mix_, 0.0), 0.99);
+
+  // The key space is loaded in full and drawn from by the model, so the
+  // base workload sees a uniform chooser over exactly that many records
+  utils::Properties props = p;
+  props.SetProperty(RECORD_COUNT_PROPERTY, std::to_string(key_space_));
+  props.SetProperty(REQUEST_DISTRIBUTION_PROPERTY, "uniform");
+  CoreWorkload::Init(props);
+  PayloadArena::Default().Reserve(model_.value_size_quantiles.back());
+
+  YCSB_C_LOG_INFO("Trace-fitted workload: %lu trace keys, key space %lu, "
+                  "reuse %.4f (%.4f from popularity)",
+                  (unsigned long)model_.num_keys, (unsigned long)key_space_,
+                  model_.reuse_share, independent);
+}
+
+double TraceFittedWorkload::IndependentReuseShare() const {
+  double share = 0;
+  double prev = 0;
+  for (size_t i = 0; i < model_.rank_cdf.size(); ++i) {
+    double keys = (model_.rank_bounds[i + 1] - model_.rank_bounds[i]) *
+        key_scale_;
+    double p = std::min((model_.rank_cdf[i] - prev) / keys, 1.0);
+    prev = model_.rank_cdf[i];
+    share += keys * p * -std::expm1(model_.reuse_window * std::log1p(-p));
+  }
+  return share;
+}
+
+TraceFittedWorkload::ThreadState &TraceFittedWorkload::LocalState() {
+  thread_local std::unordered_map<uint64_t, std::unique_ptr<ThreadState>> states;
+  thread_local uint64_t cached_id = 0;
+  thread_local ThreadState *cached = nullptr;
+  if (cached_id != instance_id_) {
+    std::unique_ptr<ThreadState> &state = states[instance_id_];
+    if (!state) {
+      state.reset(new ThreadState);
+      state->recent.resize(std::max<uint32_t>(model_.reuse_window, 1));
+    }
+    cached_id = instance_id_;
+    cached = state.get();
+  }
+  return *cached;
+}
+
+uint64_t TraceFittedWorkload::NextPopularKey() {
+  size_t bucket = SampleCdf(model_.rank_cdf, utils::ThreadLocalRandomDouble());
+  double lo = model_.rank_bounds[bucket] * key_scale_;
+  double hi = std::max(model_.rank_bounds[bucket + 1] * key_scale_, lo + 1);
+  uint64_t rank = lo + utils::ThreadLocalRandomDouble() * (hi - lo);
+  return rank < key_space_ ? rank : key_space_ - 1;
+}
+
+uint64_t TraceFittedWorkload::NextKey(ThreadState &state) {
+  uint64_t key_num;
+  if (state.filled > 0 && !model_.reuse_cdf.empty() &&
+      utils::ThreadLocalRandomDouble() < reuse_mix_) {
+    // Distance within a log2 bucket is uniform
+    size_t bucket = SampleCdf(model_.reuse_cdf, utils::ThreadLocalRandomDouble());
+    uint64_t lo = uint64_t(1) << bucket;
+    uint64_t hi = std::min<uint64_t>(lo << 1, uint64_t(state.filled) + 1);
+    uint64_t distance = lo < hi ?
+        lo + uint64_t(utils::ThreadLocalRandomDouble() * (hi - lo)) :
+        state.filled;
+    size_t size = state.recent.size();
+    key_num = state.recent[(state.next + size - distance) % size];
+  } else {
+    key_num = NextPopularKey();
+  }
+  state.recent[state.next] = key_num;
+  state.next = (state.next + 1) % state.recent.size();
+  if (state.filled < state.recent.size()) ++state.filled;
+  return key_num;
+}
+
+uint64_t TraceFittedWorkload::NextTransactionKeyId() {
+  ThreadState &state = LocalState();
+  uint64_t key_num;
+  do {
+    key_num = NextKey(state);
+  } while (!sampler_.Sampled(key_num));
+  bursts_.Overlay(&key_num, 1);
+  return key_num;
+}
+
+void TraceFittedWorkload::NextTransactionKeyNums(uint64_t *key_nums, size_t n) {
+  ThreadState &state = LocalState();
+  for (size_t i = 0; i < n; ++i) {
+    do {
+      key_nums[i] = NextKey(state);
+    } while (!sampler_.Sampled(key_nums[i]));
+  }
+  bursts_.Overlay(key_nums, n);
+}
+
+Operation TraceFittedWorkload::NextOperation() {
+  return Operation(SampleCdf(model_.op_cdf, utils::ThreadLocalRandomDouble()));
+}
+
+size_t TraceFittedWorkload::NextFieldLength() {
+  return SampleQuantiles(model_.value_size_quantiles,
+                         utils::ThreadLocalRandomDouble());
+}
+
+///
+/// Every key keeps one size, drawn from the trace's key sizes by a hash of
+/// its number. Names shorter than the unique part cannot shrink further.
+///
+string TraceFittedWorkload::BuildKeyName(uint64_t key_num) {
+  string name = key_format_.Name(key_num);
+  double u = double(utils::Hash(key_num ^ 0x9e3779b97f4a7c15ULL) % 1000003) /
+      1000003;
+  size_t size = SampleQuantiles(model_.key_size_quantiles, u);
+  if (name.size() < size) name.append(size - name.size(), 'x');
+  return name;
+}
+
+} // ycsbc
@@ -0,0 +1,126 @@
+//
+//  trace_fitted_workload.h
+//  YCSB-C
+//
+//  A synthetic workload fitted to a Twitter cache trace. The key popularity
+//  curve, op mix, key and value size distributions and short-range reuse
+//  are learned once from a trace read by TwitterTraceReader (or from a saved
+//  model), and then an unbounded stream with the same statistics is drawn
+//  over a key space that can be scaled up or down. Draws take no lock: all
+//  mutable generator state is thread-local. Selected with
+//  workload=tracefitted; it does not need the TWITTER_TRACE build.
+//
+
+#ifndef YCSB_C_TRACE_FITTED_WORKLOAD_H_
+#define YCSB_C_TRACE_FITTED_WORKLOAD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core_workload.h"
+
+namespace module {
+struct Request;
+}
+
+namespace ycsbc {
+
+class TraceFittedWorkload : public CoreWorkload {
+ public:
+  ///
+  /// Value of the "workload" property that selects this workload.
+  ///
+  static const std::string WORKLOAD_NAME;
+
+  ///
+  /// The name of the property for the trace file to fit.
+  ///
+  static const std::string TRACE_FILE_PROPERTY;
+
+  ///
+  /// The name of the property for the number of trace requests to fit.
+  ///
+  static const std::string FIT_REQUESTS_PROPERTY;
+  static const std::string FIT_REQUESTS_DEFAULT;
+
+  ///
+  /// The name of the property for a fitted model file. It is loaded instead
+  /// of the trace when it exists, and written after fitting otherwise.
+  ///
+  static const std::string MODEL_FILE_PROPERTY;
+
+  ///
+  /// The name of the property for the key space scale: the generated key
+  /// space is this many times the number of distinct keys in the trace, with
+  /// the popularity curve stretched over it.
+  ///
+  static const std::string KEY_SCALE_PROPERTY;
+  static const std::string KEY_SCALE_DEFAULT;
+
+  ///
+  /// The name of the property for the longest reuse distance (in requests)
+  /// modeled explicitly; longer reuse follows from popularity alone.
+  ///
+  static const std::string REUSE_WINDOW_PROPERTY;
+  static const std::string REUSE_WINDOW_DEFAULT;
+
+  ///
+  /// Statistics learned from a trace.
+  ///
+  struct Model {
+    uint64_t num_keys = 0;            /// Distinct keys in the trace
+    /// Popularity: bucket i holds ranks [rank_bounds[i], rank_bounds[i + 1])
+    /// and rank_cdf[i] is the request share of ranks below rank_bounds[i + 1]
+    std::vector<uint64_t> rank_bounds;
+    std::vector<double> rank_cdf;
+    std::vector<double> op_cdf;       /// Indexed by ycsbc::Operation
+    /// kQuantiles + 1 evenly spaced quantiles of key and value sizes
+    std::vector<uint32_t> key_size_quantiles;
+    std::vector<uint32_t> value_size_quantiles;
+    uint32_t reuse_window = 0;
+    double reuse_share = 0;           /// Requests reusing a key within the window
+    std::vector<double> reuse_cdf;    /// Over log2 buckets of the reuse distance
+  };
+
+  static const size_t kQuantiles = 1024;
+
+  TraceFittedWorkload();
+
+  virtual void Init(const utils::Properties &p);
+
+  virtual uint64_t NextTransactionKeyId();
+  virtual void NextTransactionKeyNums(uint64_t *key_nums, size_t n);
+  virtual Operation NextOperation();
+  virtual size_t NextFieldLength();
+  virtual std::string BuildKeyName(uint64_t key_num);
+
+  /// Number of keys in the generated key space; all of them are loaded
+  uint64_t key_space() const { return key_space_; }
+  const Model &model() const { return model_; }
+
+  /// key_count bounds the interned key ids of the requests
+  static Model Fit(const std::vector<module::Request> &requests,
+                   size_t key_count, uint32_t reuse_window);
+  static bool SaveModel(const Model &model, const std::string &path);
+  static bool LoadModel(const std::string &path, Model *model);
+
+ private:
+  struct ThreadState;
+
+  ThreadState &LocalState();
+  uint64_t NextKey(ThreadState &state);
+  uint64_t NextPopularKey();
+  /// Share of requests popularity alone brings back within the reuse window
+  double IndependentReuseShare() const;
+
+  Model model_;
+  double key_scale_;
+  uint64_t key_space_;
+  double reuse_mix_;  /// Share of keys drawn from the recent window
+  const uint64_t instance_id_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_TRACE_FITTED_WORKLOAD_H_
@@ -1,8 +1,11 @@
 #include "core_workload.h"
 #include "twitter_trace_workload.h"
+#include "payload_arena.h"
 
+#include <algorithm>
 #include <string>
 #include <iostream>
+#include <thread>
 
 using ycsbc::TwitterTraceWorkload;
 using std::string;
@@ -20,6 +23,26 @@ const string TwitterTraceWorkload::TRACE_FILE_PROPERTY = "tracefile";
 const string TwitterTraceWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string TwitterTraceWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
 
+const string TwitterTraceWorkload::STREAMING_PROPERTY = "tracestreaming";
+const string TwitterTraceWorkload::STREAMING_DEFAULT = "false";
+const string TwitterTraceWorkload::STREAM_CHUNK_PROPERTY = "tracestreamchunk";
+const string TwitterTraceWorkload::STREAM_CHUNK_DEFAULT = "1048576";
+const string TwitterTraceWorkload::STREAM_BUFFERS_PROPERTY = "tracestreambuffers";
+const string TwitterTraceWorkload::STREAM_BUFFERS_DEFAULT = "2";
+const string TwitterTraceWorkload::BATCH_PROPERTY = "tracebatch";
+const string TwitterTraceWorkload::BATCH_DEFAULT = "0";
+const string TwitterTraceWorkload::PARTITION_PROPERTY = "tracepartition";
+const string TwitterTraceWorkload::PARTITION_DEFAULT = "stride";
+const string TwitterTraceWorkload::REPLAY_SPEED_PROPERTY = "replayspeed";
+const string TwitterTraceWorkload::REPLAY_SPEED_DEFAULT = "0";
+const string TwitterTraceWorkload::MERGE_PROPERTY = "tracemerge";
+const string TwitterTraceWorkload::MERGE_DEFAULT = "concat";
+const string TwitterTraceWorkload::LOAD_DEDUP_PROPERTY = "traceloaddedup";
+const string TwitterTraceWorkload::LOAD_DEDUP_DEFAULT = "false";
+
+// 滞后超过该值的请求计为未按计划发出
+static const double kReplayLateUs = 1000;
+
 
 TwitterTraceWorkload::TwitterTraceWorkload()
   : CoreWorkload()
@@ -41,11 +64,50 @@ void TwitterTraceWorkload::Init(const utils::Properties &p)
   // fieldcount = 1
   field_count_ = std::stoi(p.GetProperty(FIELD_COUNT_PROPERTY,
                                          FIELD_COUNT_DEFAULT));
+  this->field_names_.clear();
+  for (int i = 0; i < field_count_; ++i)
+    this->field_names_.push_back(FieldName(i));
   // get record, operation count from TwitterTraceReader
-  this->record_count_ = std::stoul(p.GetProperty(RECORD_COUNT_PROPERTY));
-  this->operation_count_ = std::stoul(p.GetProperty(OPERATION_COUNT_PROPERTY));
+  this->record_count_ = std::stoull(p.GetProperty(RECORD_COUNT_PROPERTY));
+  this->operation_count_ = std::stoull(p.GetProperty(OPERATION_COUNT_PROPERTY));
+  // 按 Key 哈希空间采样：读取同样范围的 trace，只重放采中的 Key，加载与重放的请求数按采样率缩小
+  this->sampler_ = utils::KeySampler(std::stod(p.GetProperty(SAMPLE_RATE_PROPERTY, SAMPLE_RATE_DEFAULT)));
 
-  this->twitter_trace_reader_ = new module::TwitterTraceReader(trace_file_path, thread_count, record_count_, operation_count_);
+  // 流式读取：后台线程按分块预取，内存占用与 Trace 长度无关
+  size_t stream_chunk = 0;
+  if (utils::StrToBool(p.GetProperty(STREAMING_PROPERTY, STREAMING_DEFAULT)))
+    stream_chunk = std::stoull(p.GetProperty(STREAM_CHUNK_PROPERTY, STREAM_CHUNK_DEFAULT));
+  size_t stream_buffers = std::stoull(p.GetProperty(STREAM_BUFFERS_PROPERTY, STREAM_BUFFERS_DEFAULT));
+  // 多个 Trace 文件：依次拼接，或按时间戳归并
+  std::string merge = p.GetProperty(MERGE_PROPERTY, MERGE_DEFAULT);
+  if (merge != MERGE_DEFAULT && merge != "timestamp")
+    throw utils::Exception("Unknown trace merge mode: " + merge);
+
+  this->twitter_trace_reader_ = new module::TwitterTraceReader(trace_file_path, thread_count, record_count_, operation_count_,
+                                                               stream_chunk, stream_buffers, merge == "timestamp",
+                                                               this->sampler_.rate());
+  this->record_count_ = this->sampler_.Scale(this->record_count_);
+  this->operation_count_ = this->sampler_.Scale(this->operation_count_);
+  size_t batch = std::stoull(p.GetProperty(BATCH_PROPERTY, BATCH_DEFAULT));
+  if (batch)
+    this->twitter_trace_reader_->SetBatchReplay(batch);
+  // 亲和划分：同一 Key / 客户端的请求固定由一个线程按 Trace 顺序发出
+  std::string partition = p.GetProperty(PARTITION_PROPERTY, PARTITION_DEFAULT);
+  if (partition == "key")
+    this->twitter_trace_reader_->SetPartition(module::TracePartition::KEY);
+  else if (partition == "client")
+    this->twitter_trace_reader_->SetPartition(module::TracePartition::CLIENT);
+  else if (partition != PARTITION_DEFAULT)
+    throw utils::Exception("Unknown trace partition: " + partition);
+  this->replay_speed_ = std::stod(p.GetProperty(REPLAY_SPEED_PROPERTY, REPLAY_SPEED_DEFAULT));
+  if (this->replay_speed_ > 0)
+  {
+    this->replay_slips_.reset(new ReplaySlip[thread_count]);
+    YCSB_C_LOG_INFO("Replaying trace timestamps at %.2fx speed", this->replay_speed_);
+  }
+  this->load_dedup_ = utils::StrToBool(p.GetProperty(LOAD_DEDUP_PROPERTY, LOAD_DEDUP_DEFAULT));
+  if (this->load_dedup_)
+    this->load_shards_.assign(this->thread_count_, std::vector<LoadKeyShard>());
   // jump to first request
   this->twitter_trace_reader_->ResetIterator();
 
@@ -74,13 +136,56 @@ void TwitterTraceWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPair> &update, s
   update.push_back(pair);
 }
 
-inline std::string TwitterTraceWorkload::NextSequenceKey(size_t thread_id) 
+void TwitterTraceWorkload::BuildValues(std::vector<ycsbc::DB::KVPairView> &values, size_t thread_id)
+{
+  // value 长度取自 Trace 中的 value_size，内容为 arena 中的随机切片
+  size_t value_size = this->twitter_trace_reader_->GetCurrentValueSizeByThread(thread_id);
+  for (int i = 0; i < field_count_; ++i)
+    values.emplace_back(this->field_names_[i], PayloadArena::Default().Slice(value_size));
+}
+
+void TwitterTraceWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPairView> &update, size_t thread_id)
+{
+  size_t value_size = this->twitter_trace_reader_->GetCurrentValueSizeByThread(thread_id);
+  update.emplace_back(this->field_names_[0], PayloadArena::Default().Slice(value_size));
+}
+
+void TwitterTraceWorkload::BuildRequestValues(std::vector<ycsbc::DB::KVPairView> &values, const TraceRequest &req)
+{
+  for (int i = 0; i < field_count_; ++i)
+    values.emplace_back(this->field_names_[i], PayloadArena::Default().Slice(req.value_size));
+}
+
+void TwitterTraceWorkload::BuildRequestUpdate(std::vector<ycsbc::DB::KVPairView> &update, const TraceRequest &req)
+{
+  update.emplace_back(this->field_names_[0], PayloadArena::Default().Slice(req.value_size));
+}
+
+bool TwitterTraceWorkload::NextRequest(size_t thread_id, TraceRequest &req)
+{
+  size_t index;
+  const module::Request *request = this->twitter_trace_reader_->NextRequest(thread_id, index);
+  if (!request)
+  {
+    req = TraceRequest();
+    return false;
+  }
+  req.op = MapOperation(request->operation);
+  req.key = request->anonymized_key;
+  req.value_size = request->value_size;
+  req.sequence = index;
+  req.timestamp = request->timestamp;
+  req.ttl = request->ttl;
+  return true;
+}
+
+inline std::string_view TwitterTraceWorkload::NextSequenceKey(size_t thread_id) 
 {
   // may be null string
   return this->twitter_trace_reader_->GetNextKeyByThread(thread_id);
 }
 
-inline std::string TwitterTraceWorkload::NextTransactionKey(size_t thread_id) 
+inline std::string_view TwitterTraceWorkload::NextTransactionKey(size_t thread_id) 
 {
   // may be null string
   return this->twitter_trace_reader_->GetNextKeyByThread(thread_id);
@@ -88,7 +193,11 @@ inline std::string TwitterTraceWorkload::NextTransactionKey(size_t thread_id)
 
 inline Operation TwitterTraceWorkload::NextOperation(size_t thread_id)
 {
-  module::TwitterTraceOperation twitter_trace_op = this->twitter_trace_reader_->GetOperationByThread(thread_id);
+  return MapOperation(this->twitter_trace_reader_->GetOperationByThread(thread_id));
+}
+
+Operation TwitterTraceWorkload::MapOperation(module::TwitterTraceOperation twitter_trace_op)
+{
   switch (twitter_trace_op) 
   {
     case module::TwitterTraceOperation::GET:
@@ -102,11 +211,15 @@ inline Operation TwitterTraceWorkload::NextOperation(size_t thread_id)
     // 这里暂时不支持 scan
     // case module::TwitterTraceOperation::GETS:
     //   return Operation::SCAN;
+    // 改写依赖原值：先读后写
+    case module::TwitterTraceOperation::CAS:
+    case module::TwitterTraceOperation::APPEND:
+    case module::TwitterTraceOperation::PREPEND:
     case module::TwitterTraceOperation::INCR:
     case module::TwitterTraceOperation::DECR:
       return Operation::READMODIFYWRITE;
     case module::TwitterTraceOperation::DELETE:
-      return Operation::UPDATE;
+      return Operation::DELETE;
     default:
       return Operation::READ;
   }
@@ -117,6 +230,125 @@ inline std::string TwitterTraceWorkload::NextFieldName()
   return std::string("field").append(std::to_string(0));
 }
 
+size_t TwitterTraceWorkload::CollectLoadKeys(size_t thread_id, size_t num_requests)
+{
+  std::vector<LoadKeyShard> &shards = this->load_shards_[thread_id];
+  shards.assign(this->thread_count_, LoadKeyShard());
+  TraceRequest req;
+  std::string key;
+  size_t requests = 0;
+  for (size_t i = 0; this->ordered_replay() ? this->HasNextRequest(thread_id) : i < num_requests; ++i)
+  {
+    if (!this->NextRequest(thread_id, req))
+      break;
+    requests++;
+    key.assign(req.key.data(), req.key.size());
+    LoadKeyShard &shard = shards[std::hash<std::string>()(key) % shards.size()];
+    auto iter = shard.find(key);
+    if (iter == shard.end())
+    {
+      shard.emplace(key, LoadKeyInfo{req.value_size, req.sequence});
+      continue;
+    }
+    iter->second.value_size = std::max(iter->second.value_size, req.value_size);
+    iter->second.sequence = std::min(iter->second.sequence, req.sequence);
+  }
+  return requests;
+}
+
+std::vector<TraceLoadKey> TwitterTraceWorkload::MergeLoadKeys(size_t shard)
+{
+  LoadKeyShard merged;
+  for (auto &shards : this->load_shards_)
+  {
+    if (shard >= shards.size())
+      continue;
+    LoadKeyShard &part = shards[shard];
+    if (merged.empty())
+    {
+      merged.swap(part);
+      continue;
+    }
+    for (auto &entry : part)
+    {
+      auto result = merged.emplace(entry.first, entry.second);
+      if (result.second)
+        continue;
+      LoadKeyInfo &info = result.first->second;
+      info.value_size = std::max(info.value_size, entry.second.value_size);
+      info.sequence = std::min(info.sequence, entry.second.sequence);
+    }
+    LoadKeyShard().swap(part);
+  }
+  this->load_unique_keys_ += merged.size();
+  std::vector<TraceLoadKey> keys;
+  keys.reserve(merged.size());
+  for (auto &entry : merged)
+    keys.push_back(TraceLoadKey{entry.first, entry.second.value_size, entry.second.sequence});
+  LoadKeyShard().swap(merged);
+  std::sort(keys.begin(), keys.end(), [](const TraceLoadKey &a, const TraceLoadKey &b) {
+    return a.sequence < b.sequence;
+  });
+  return keys;
+}
+
+void TwitterTraceWorkload::StartReplayClock()
+{
+  this->replay_base_timestamp_ = this->twitter_trace_reader_->GetFirstTimestamp();
+  for (size_t i = 0; i < this->thread_count_; i++)
+  {
+    this->replay_slips_[i].lag_us.Clear();
+    this->replay_slips_[i].late = 0;
+    this->replay_slips_[i].max_lag_us = 0;
+  }
+  this->replay_start_ = std::chrono::steady_clock::now();
+}
+
+void TwitterTraceWorkload::WaitForSchedule(size_t thread_id)
+{
+  uint64_t timestamp;
+  if (!this->twitter_trace_reader_->PeekTimestampByThread(thread_id, timestamp))
+    return;
+  // Trace 时间戳以秒计，早于起点的请求（乱序）立即发出
+  double offset_sec = (timestamp > this->replay_base_timestamp_)
+                      ? (timestamp - this->replay_base_timestamp_) / this->replay_speed_ : 0;
+  auto target = this->replay_start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                        std::chrono::duration<double>(offset_sec));
+  auto now = std::chrono::steady_clock::now();
+  ReplaySlip &slip = this->replay_slips_[thread_id];
+  if (now < target)
+  {
+    std::this_thread::sleep_until(target);
+    slip.lag_us.Add(0);
+    return;
+  }
+  double lag_us = std::chrono::duration<double, std::micro>(now - target).count();
+  slip.lag_us.Add(lag_us);
+  slip.max_lag_us = std::max(slip.max_lag_us, lag_us);
+  if (lag_us > kReplayLateUs)
+    slip.late++;
+}
+
+void TwitterTraceWorkload::ReportReplaySlippage(std::ostream &os) const
+{
+  Histogram lag_us;
+  lag_us.Clear();
+  uint64_t late = 0;
+  double max_lag_us = 0;
+  for (size_t i = 0; i < this->thread_count_; i++)
+  {
+    lag_us.Merge(this->replay_slips_[i].lag_us);
+    late += this->replay_slips_[i].late;
+    max_lag_us = std::max(max_lag_us, this->replay_slips_[i].max_lag_us);
+  }
+  os << "# Replay speed: " << this->replay_speed_ << "x" << std::endl;
+  os << "# Replay slippage (us): " << lag_us.Summary() << "  Max: " << max_lag_us << std::endl;
+  os << "# Replay requests behind schedule (> " << kReplayLateUs << " us): " << late << std::endl;
+  if (max_lag_us > 1e6)
+    YCSB_C_LOG_ERROR("Replay fell %.3f s behind the trace schedule, lower replayspeed for a faithful arrival process",
+                     max_lag_us / 1e6);
+}
+
 inline size_t TwitterTraceWorkload::GetRecordCount()
 {
   return this->record_count_;
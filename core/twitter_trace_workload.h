@@ -2,17 +2,43 @@
 #define _TWITTER_TRACE_WORKLOAD_H_
 
 #include "core_workload.h"
+#include "histogram.h"
 #include "modules/twitter_trace_reader.h"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
 /**
  * 逻辑：
  * 1. 包含 TwitterTraceReader 读取 Trace 文件；
  * 2. Load 阶段：根据 Trace 中所有 Key 预先插入数据。按照 RubbleDB 的逻辑，将 Trace 中每一个请求（不管get\set）都插入；
- * 3. Run 阶段：按照 Trace 下负载，不考虑 Timestamp。
+ * 3. Run 阶段：按照 Trace 下负载，默认不考虑 Timestamp；replayspeed > 0 时按 Timestamp 的原始节奏
+ *    （乘以加速倍数）发出请求，各线程独立对照同一起点计时，无全局锁，等待时间不计入延迟；
+ *    跟不上时不等待，输出调度滞后的分布、最大值与滞后超过 1 ms 的请求数，可与 tracebatch 保序重放同时使用。
  */
 
 namespace ycsbc {
 
+/// One trace request handed to the client. The key views the reader's
+/// storage and stays valid until the thread's next NextRequest call.
+struct TraceRequest {
+  Operation op = READ;
+  std::string_view key;
+  uint32_t value_size = 0;
+  uint64_t sequence = DB::kNoSequence;
+  uint64_t timestamp = 0;
+  uint32_t ttl = 0;
+};
+
+/// One distinct key of the load requests, loaded once when deduplicating
+struct TraceLoadKey {
+  std::string key;
+  uint32_t value_size = 0;  /// Largest value size among its load requests
+  uint64_t sequence = 0;    /// Trace position of its first load request
+};
+
 class TwitterTraceWorkload : public CoreWorkload
 {
  public:
@@ -29,18 +55,69 @@ class TwitterTraceWorkload : public CoreWorkload
 
   // Add trace file property
   static const std::string TRACE_FILE_PROPERTY;
+
+  /// Stream the trace through a bounded ring of prefetched chunks
+  static const std::string STREAMING_PROPERTY;
+  static const std::string STREAMING_DEFAULT;
+  static const std::string STREAM_CHUNK_PROPERTY;
+  static const std::string STREAM_CHUNK_DEFAULT;
+  static const std::string STREAM_BUFFERS_PROPERTY;
+  static const std::string STREAM_BUFFERS_DEFAULT;
+
+  /// Order-preserving replay: threads claim this many consecutive requests
+  /// at a time from a global cursor (0 splits the trace by thread stride)
+  static const std::string BATCH_PROPERTY;
+  static const std::string BATCH_DEFAULT;
+
+  /// Pin requests to threads by key hash or by client_id ("key" / "client"),
+  /// keeping every key's or client's requests on one thread in trace order,
+  /// so per-thread state needs no lock. The default "stride" interleaves by
+  /// index. Works with text, binary and streaming reads
+  static const std::string PARTITION_PROPERTY;
+  static const std::string PARTITION_DEFAULT;
+
+  /// Timestamp-faithful replay: issue run requests on the trace's own
+  /// schedule sped up by this factor (0 replays flat out)
+  static const std::string REPLAY_SPEED_PROPERTY;
+  static const std::string REPLAY_SPEED_DEFAULT;
+
+  /// How a comma-separated or globbed tracefile list is combined:
+  /// "concat" plays the files back to back, "timestamp" merges them in time order
+  static const std::string MERGE_PROPERTY;
+  static const std::string MERGE_DEFAULT;
+
+  /// Load every distinct key of the load requests once (with its largest
+  /// value size) instead of inserting each load request. Threads first take
+  /// the phase's requests in parallel and shard the distinct keys by hash;
+  /// thread i then merges shard i of every thread and inserts its keys in
+  /// first-appearance order. Works with whole, streaming, binary and sampled
+  /// reads; the load report counts trace requests and unique keys
+  static const std::string LOAD_DEDUP_PROPERTY;
+  static const std::string LOAD_DEDUP_DEFAULT;
   
   virtual void Init(const utils::Properties &p);
   
   virtual void BuildValues(std::vector<ycsbc::DB::KVPair> &values, size_t thread_id = 0);
   virtual void BuildUpdate(std::vector<ycsbc::DB::KVPair> &update, size_t thread_id = 0);
+  // 以共享 payload arena 的视图构造 value，不再每次分配并填充
+  virtual void BuildValues(std::vector<ycsbc::DB::KVPairView> &values, size_t thread_id = 0);
+  virtual void BuildUpdate(std::vector<ycsbc::DB::KVPairView> &update, size_t thread_id = 0);
+  /// Values sized for a request already taken with NextRequest
+  void BuildRequestValues(std::vector<ycsbc::DB::KVPairView> &values, const TraceRequest &req);
+  void BuildRequestUpdate(std::vector<ycsbc::DB::KVPairView> &update, const TraceRequest &req);
+
+  /// Takes the thread's next request in one trace access; returns false
+  /// (and an empty READ) when the thread has no request left
+  bool NextRequest(size_t thread_id, TraceRequest &req);
   
   virtual std::string NextTable() { return table_name_; }
-  /// Used for loading data
-  virtual std::string NextSequenceKey(size_t thread_id = 0);
-  /// Used for transactions
-  virtual std::string NextTransactionKey(size_t thread_id = 0);
+  /// Used for loading data; the view stays valid until the thread's next
+  /// request
+  virtual std::string_view NextSequenceKey(size_t thread_id = 0);
+  /// Used for transactions; same lifetime as NextSequenceKey
+  virtual std::string_view NextTransactionKey(size_t thread_id = 0);
   virtual Operation NextOperation(size_t thread_id = 0);
+  static Operation MapOperation(module::TwitterTraceOperation op);
   virtual std::string NextFieldName();
 
   bool read_all_fields() const { return true; }
@@ -51,6 +128,32 @@ class TwitterTraceWorkload : public CoreWorkload
 
   virtual void ResetIterator();
 
+  /// 保序重放或亲和划分：各线程的操作数不固定，领完本阶段的请求即结束
+  bool ordered_replay() const
+  {
+    return twitter_trace_reader_->IsBatchReplay() || twitter_trace_reader_->IsPartitioned();
+  }
+  void SetPhaseRequests(size_t requests) { twitter_trace_reader_->SetRequestLimit(requests); }
+  bool HasNextRequest(size_t thread_id) { return twitter_trace_reader_->HasNextByThread(thread_id); }
+
+  /// 去重 Load：先并行收集 Load 请求中的不同 Key，再由各线程并行插入
+  bool load_dedup() const { return load_dedup_; }
+  /// 第一遍（各线程并行）：取完线程本阶段的请求，Key 按哈希归入各分片，返回取到的请求数
+  size_t CollectLoadKeys(size_t thread_id, size_t num_requests);
+  /// 第二遍（全部线程收集完后并行）：合并各线程的第 shard 个分片，按 Key 在 Trace 中首次出现的顺序返回
+  std::vector<TraceLoadKey> MergeLoadKeys(size_t shard);
+  /// 各分片合并后的不同 Key 总数（MergeLoadKeys 全部返回后有效）
+  size_t load_unique_keys() const { return load_unique_keys_.load(); }
+
+  /// 按时间戳重放
+  bool timed_replay() const { return replay_speed_ > 0; }
+  /// 以当前时刻作为本阶段首条请求的发出时刻（线程开始取请求之前调用）
+  void StartReplayClock();
+  /// 等到线程下一条请求的计划时刻；已落后时不等待，记录滞后
+  void WaitForSchedule(size_t thread_id);
+  /// 输出本阶段的调度滞后统计
+  void ReportReplaySlippage(std::ostream &os) const;
+
   TwitterTraceWorkload();
   TwitterTraceWorkload(const size_t thread_count);
   ~TwitterTraceWorkload() {}
@@ -64,6 +167,29 @@ class TwitterTraceWorkload : public CoreWorkload
 
   size_t thread_count_;
 
+  // 按时间戳重放：各线程只读共享的起点，滞后统计按线程分开，无需加锁
+  struct alignas(64) ReplaySlip
+  {
+    Histogram lag_us;
+    uint64_t late = 0;
+    double max_lag_us = 0;
+  };
+  double replay_speed_ = 0;
+  uint64_t replay_base_timestamp_ = 0;
+  std::chrono::steady_clock::time_point replay_start_;
+  std::unique_ptr<ReplaySlip[]> replay_slips_;
+
+  // 去重 Load：load_shards_[线程][分片]，分片数等于线程数，同一 Key 总在同一分片
+  struct LoadKeyInfo
+  {
+    uint32_t value_size;
+    uint64_t sequence;
+  };
+  typedef std::unordered_map<std::string, LoadKeyInfo> LoadKeyShard;
+  bool load_dedup_ = false;
+  std::vector<std::vector<LoadKeyShard>> load_shards_;
+  std::atomic<size_t> load_unique_keys_{0};
+
   module::TwitterTraceReader *twitter_trace_reader_ = nullptr;
 };
   
@@ -24,6 +24,7 @@ class UniformGenerator : public Generator<uint64_t> {
   
   uint64_t Next();
   uint64_t Last();
+  void NextBatch(uint64_t *out, size_t n);
   
  private:
   std::mt19937_64 generator_;
@@ -37,6 +38,15 @@ inline uint64_t UniformGenerator::Next() {
   return last_int_ = dist_(generator_);
 }
 
+inline void UniformGenerator::NextBatch(uint64_t *out, size_t n) {
+  if (n == 0) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = dist_(generator_);
+  }
+  last_int_ = out[n - 1];
+}
+
 inline uint64_t UniformGenerator::Last() {
   std::lock_guard<std::mutex> lock(mutex_);
   return last_int_;
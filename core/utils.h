@@ -10,6 +10,7 @@
 #define YCSB_C_UTILS_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <exception>
 #include <random>
@@ -42,6 +43,27 @@ inline uint64_t FNVHash64(uint64_t val) {
   return hash;
 }
 
+///
+/// Hashes vals[0, n) in place, same result as FNVHash64 on each value.
+/// Octets are processed across a block of values at a time so the inner loop
+/// has no dependency between lanes and can be vectorized.
+///
+inline void FNVHash64Batch(uint64_t *vals, size_t n) {
+  const size_t kBlock = 64;
+  uint64_t hash[kBlock];
+  for (size_t begin = 0; begin < n; begin += kBlock) {
+    const size_t len = std::min(kBlock, n - begin);
+    uint64_t *v = vals + begin;
+    for (size_t j = 0; j < len; ++j) hash[j] = kFNVOffsetBasis64;
+    for (int i = 0; i < 8; i++) {
+      for (size_t j = 0; j < len; ++j) {
+        hash[j] = (hash[j] ^ ((v[j] >> (8 * i)) & 0x00ff)) * kFNVPrime64;
+      }
+    }
+    for (size_t j = 0; j < len; ++j) v[j] = hash[j];
+  }
+}
+
 inline uint64_t Hash(uint64_t val) { return FNVHash64(val); }
 
 inline double RandomDouble(double min = 0.0, double max = 1.0) {
@@ -50,6 +72,18 @@ inline double RandomDouble(double min = 0.0, double max = 1.0) {
   return uniform(generator);
 }
 
+///
+/// Same as RandomDouble() over [0, 1), but every thread draws from its own
+/// engine, so concurrent callers never contend. Threads are seeded in the
+/// order they first call it.
+///
+inline double ThreadLocalRandomDouble() {
+  static std::atomic<uint64_t> next_seed(std::default_random_engine::default_seed);
+  thread_local std::default_random_engine generator(next_seed++);
+  thread_local std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  return uniform(generator);
+}
+
 ///
 /// Returns an ASCII code that can be printed to desplay
 ///
@@ -72,21 +72,33 @@ int HashtableDB::Scan(const string &table, const string &key, int len,
 
 int HashtableDB::Update(const string &table, const string &key,
     vector<KVPair> &values) {
+  return UpdateFields(table, key, values);
+}
+
+int HashtableDB::Update(const string &table, const string &key,
+    const vector<KVPairView> &values) {
+  return UpdateFields(table, key, values);
+}
+
+template <typename Pairs>
+int HashtableDB::UpdateFields(const string &table, const string &key,
+    const Pairs &values) {
   string key_index(table + key);
   FieldHashtable *field_table = key_table_->Get(key_index.c_str());
   if (!field_table) {
     field_table = NewFieldHashtable();
     key_table_->Insert(key_index.c_str(), field_table);
-    for (KVPair &field_pair : values) {
+    for (const auto &field_pair : values) {
       const char *value = CopyString(field_pair.second);
-      field_table->Insert(field_pair.first.c_str(), value);
+      field_table->Insert(string(field_pair.first).c_str(), value);
     }
   } else {
-    for (KVPair &field_pair : values) {
+    for (const auto &field_pair : values) {
       const char *value = CopyString(field_pair.second);
-      const char *old = field_table->Update(field_pair.first.c_str(), value);
+      const string field(field_pair.first);
+      const char *old = field_table->Update(field.c_str(), value);
       if (!old) {
-        field_table->Insert(field_pair.first.c_str(), value);
+        field_table->Insert(field.c_str(), value);
       } else {
         DeleteString(old);
       }
@@ -97,6 +109,17 @@ int HashtableDB::Update(const string &table, const string &key,
 
 int HashtableDB::Insert(const string &table, const string &key,
     vector<KVPair> &values) {
+  return InsertFields(table, key, values);
+}
+
+int HashtableDB::Insert(const string &table, const string &key,
+    const vector<KVPairView> &values) {
+  return InsertFields(table, key, values);
+}
+
+template <typename Pairs>
+int HashtableDB::InsertFields(const string &table, const string &key,
+    const Pairs &values) {
   string key_index(table + key);
   FieldHashtable *field_table = key_table_->Get(key_index.c_str());
   if (!field_table) {
@@ -104,9 +127,9 @@ int HashtableDB::Insert(const string &table, const string &key,
     key_table_->Insert(key_index.c_str(), field_table);
   }
 
-  for (KVPair &field_pair : values) {
+  for (const auto &field_pair : values) {
     const char *value = CopyString(field_pair.second);
-    bool ok = field_table->Insert(field_pair.first.c_str(), value);
+    bool ok = field_table->Insert(string(field_pair.first).c_str(), value);
     if (!ok) {
       DeleteString(value);
       return DB::kErrorConflict;
@@ -12,6 +12,7 @@
 #include "core/db.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include "lib/string_hashtable.h"
 
@@ -34,16 +35,30 @@ class HashtableDB : public DB {
              std::vector<KVPair> &values);
   int Delete(const std::string &table, const std::string &key);
 
+  // Values are copied straight from the views into the field table
+  int Update(const std::string &table, const std::string &key,
+             const std::vector<KVPairView> &values);
+  int Insert(const std::string &table, const std::string &key,
+             const std::vector<KVPairView> &values);
+
  protected:
   HashtableDB(KeyHashtable *table) : key_table_(table) { }
 
   virtual FieldHashtable *NewFieldHashtable() = 0;
   virtual void DeleteFieldHashtable(FieldHashtable *table) = 0;
 
-  virtual const char *CopyString(const std::string &str) = 0;
+  virtual const char *CopyString(std::string_view str) = 0;
   virtual void DeleteString(const char *str) = 0;
 
   KeyHashtable *key_table_;
+
+ private:
+  template <typename Pairs>
+  int UpdateFields(const std::string &table, const std::string &key,
+                   const Pairs &values);
+  template <typename Pairs>
+  int InsertFields(const std::string &table, const std::string &key,
+                   const Pairs &values);
 };
 
 } // ycsbc
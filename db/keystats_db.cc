@@ -1,15 +1,138 @@
 #include "db/keystats_db.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <numeric>
 #include <sstream>
+#include <unordered_set>
+#include <sys/mman.h>
 #include <nlohmann/json.hpp>
+#include <tbb/parallel_sort.h>
 
 using json = nlohmann::json;
 
 // portion of all keys
 static double g_hot_key_portion;
+// 当前线程后续操作所属请求的上下文
+static thread_local ycsbc::DB::OpContext t_op_context;
 
 namespace ycsbc {
 
+// 统计文件的缓冲写入：逐行格式化到大块缓冲区，攒满后整块写出，不逐行 std::endl 刷盘
+class StatsFileWriter
+{
+public:
+  explicit StatsFileWriter(const std::string& file_name)
+    : file_(file_name, std::ios::out)
+  {
+    this->buffer_.reserve(kBufferSize + 256);
+  }
+  ~StatsFileWriter() { this->Close(); }
+
+  bool is_open() const { return this->file_.is_open(); }
+
+  // @brief 写一行 key
+  void Write(const std::string& key)
+  {
+    this->buffer_.append(key);
+    this->buffer_.push_back('\n');
+    this->Spill();
+  }
+  // @brief 写一行 key,count
+  void Write(const std::string& key, const int64_t count)
+  {
+    char digits[24];
+    this->buffer_.append(key);
+    this->buffer_.push_back(',');
+    this->buffer_.append(digits, std::to_chars(digits, digits + sizeof(digits), count).ptr);
+    this->buffer_.push_back('\n');
+    this->Spill();
+  }
+  // @brief 原样写入二进制数据，大块数据不经缓冲区
+  void WriteBytes(const void* data, const size_t size)
+  {
+    if (size >= kBufferSize)
+    {
+      this->file_.write(this->buffer_.data(), this->buffer_.size());
+      this->buffer_.clear();
+      this->file_.write(static_cast<const char*>(data), size);
+      return;
+    }
+    this->buffer_.append(static_cast<const char*>(data), size);
+    this->Spill();
+  }
+  void Close()
+  {
+    if (!this->file_.is_open())
+      return;
+    this->file_.write(this->buffer_.data(), this->buffer_.size());
+    this->buffer_.clear();
+    this->file_.close();
+  }
+
+private:
+  static const size_t kBufferSize = 4 << 20;
+
+  void Spill()
+  {
+    if (this->buffer_.size() < kBufferSize)
+      return;
+    this->file_.write(this->buffer_.data(), this->buffer_.size());
+    this->buffer_.clear();
+  }
+
+  std::ofstream file_;
+  std::string buffer_;
+};
+
+// 二进制列式输出的文件头（见 KeyStatsDB::SetBinaryOutput）
+static const char kKeyStatsMagic[8] = {'Y', 'C', 'S', 'B', 'K', 'S', 'T', '1'};
+static const char kHotKeysMagic[8] = {'Y', 'C', 'S', 'B', 'H', 'O', 'T', '1'};
+
+// 按配置创建热识别模块；按 Key 数计的容量参数乘以 scale（采样重放时为采样率），频率阈值、时间窗口不变
+static module::HeatSeparator* CreateHeatSeparator(const json& module_config, double scale)
+{
+  auto scaled = [scale](size_t count) {
+    return std::max<size_t>(1, std::llround(count * scale));
+  };
+  std::string type = module_config["type"];
+  auto params = module_config["params"];
+  if (type == "lru")
+    return new module::HeatSeparatorLru(scaled(params["capacity"].get<size_t>()));
+  if (type == "lfu")
+    return new module::HeatSeparatorLfu(scaled(params["capacity"].get<size_t>()),
+                                        params["min_freq"].get<size_t>());
+  if (type == "lruk")
+    return new module::HeatSeparatorLruK(params["k"].get<uint32_t>(),
+                                         scaled(params["capacity"].get<size_t>()));
+  if (type == "window")
+    return new module::HeatSeparatorWindow(std::chrono::milliseconds(params["window_size"].get<int>()),
+                                           params["threshold"].get<uint32_t>());
+  if (type == "sketch_window")
+    return new module::HeatSeparatorSketch(scaled(params["window_size"].get<size_t>()),
+                                           params["epsilon"].get<double>(),
+                                           params["delta"].get<double>(),
+                                           params["threshold"].get<size_t>(),
+                                           params["enable_lru"].get<bool>());
+  if (type == "w_tinylfu")
+    return new module::HeatSepratorWTinyLFU(scaled(params["capacity"].get<size_t>()));
+  if (type == "lirs")
+    return new module::HeatSeparatorLIRS(scaled(params["capacity"].get<size_t>()));
+  if (type == "s3_fifo")
+    return new module::HeatSeparatorS3FIFO(scaled(params["capacity"].get<size_t>()));
+  if (type == "arc")
+    return new module::HeatSepratorWTinyLFU(scaled(params["capacity"].get<size_t>()));
+  return nullptr;
+}
+
+KeyStatsDB::~KeyStatsDB()
+{
+  if (this->dense_counts_)
+    munmap(this->dense_counts_, this->dense_key_count_ * sizeof(std::atomic<uint32_t>));
+}
+
 void KeyStatsDB::Init()
 {
   YCSB_C_LOG_INFO("A new thread of KeyStatsDB begins working");
@@ -38,95 +161,42 @@ void KeyStatsDB::Init()
       YCSB_C_LOG_ERROR("json parse error: %s", e.what());
       exit(EXIT_FAILURE);
     }
+    if (this->sample_rate_ < 1.0)
+      YCSB_C_LOG_INFO("Scaling separator capacities by sample rate %g", this->sample_rate_);
     // 创建热识别模块
-    size_t operationcount = config["operationcount"].get<size_t>();
     g_hot_key_portion = config["hot_key_portion"].get<double>();
     for (auto& module_config : config["heat_separators"]) 
     {
-      std::string type = module_config["type"];
-      if (type == "lru") 
-      {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSeparatorLru(
-            params["capacity"].get<size_t>()
-          )
-        );
-      }
-      else if (type == "lfu")
-      {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSeparatorLfu(
-            params["capacity"].get<size_t>(),
-            params["min_freq"].get<size_t>()
-          )
-        );
-      }
-      else if (type == "lruk") 
+      module::HeatSeparator* separator = CreateHeatSeparator(module_config, this->sample_rate_);
+      if (separator)
+        heat_separators.emplace_back(separator);
+    }
+    // 容量曲线：带容量参数的模块按 capacity_curve 中的每个容量（全量 Trace 下的 Key 数）各建一个实例，
+    // 与正式模块接收同样的访问；同时精确统计 LRU 栈距离
+    if (this->capacity_curve_)
+    {
+      std::vector<size_t> capacities = config.value("capacity_curve", std::vector<size_t>{
+          1000, 2000, 4000, 8000, 16000, 32000, 64000, 128000});
+      for (auto& module_config : config["heat_separators"])
       {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSeparatorLruK(
-            params["k"].get<uint32_t>(),
-            params["capacity"].get<size_t>()
-          )
-        );
-      }
-      else if (type == "window") {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSeparatorWindow(
-            std::chrono::milliseconds(params["window_size"].get<int>()),
-            params["threshold"].get<uint32_t>()
-          )
-        );
-      }
-      else if (type == "sketch_window") {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSeparatorSketch(
-            params["window_size"].get<size_t>(),
-            params["epsilon"].get<double>(),
-            params["delta"].get<double>(),
-            params["threshold"].get<size_t>(),
-            params["enable_lru"].get<bool>()
-          )
-        );
-      }
-      else if (type == "w_tinylfu") {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSepratorWTinyLFU(
-            params["capacity"].get<size_t>()
-          )
-        );
-      }
-      else if (type == "lirs") {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSeparatorLIRS(
-            params["capacity"].get<size_t>()
-          )
-        );
-      }
-      else if (type == "s3_fifo") {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSeparatorS3FIFO(
-            params["capacity"].get<size_t>()
-          )
-        );
-      }
-      else if (type == "arc") {
-        auto params = module_config["params"];
-        heat_separators.emplace_back(
-          new module::HeatSepratorWTinyLFU(
-            params["capacity"].get<size_t>()
-          )
-        );
+        std::string type = module_config["type"];
+        const char* param = (type == "sketch_window") ? "window_size" : "capacity";
+        if (!module_config["params"].contains(param))
+          continue;
+        for (size_t capacity : capacities)
+        {
+          json curve_config = module_config;
+          curve_config["params"][param] = capacity;
+          module::HeatSeparator* separator = CreateHeatSeparator(curve_config, this->sample_rate_);
+          if (separator)
+            this->curve_separators_.push_back({capacity, separator});
+        }
       }
+      this->stack_distance_.reset(new module::StackDistanceCounter());
+      YCSB_C_LOG_INFO("Capacity curve: %zu separator instances over %zu capacities",
+                      this->curve_separators_.size(), capacities.size());
     }
+    this->expiry_wheel_.reset(new module::ExpiryWheel());
     YCSB_C_LOG_INFO("Heat Separator Modules are initialized ");
   }
 
@@ -142,18 +212,10 @@ int KeyStatsDB::Read(const std::string &table, const std::string &key,
            const std::vector<std::string> *fields,
            std::vector<KVPair> &result)
 {
-  std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
 #ifdef DEBUG
   YCSB_C_LOG_INFO("READ: %s, key_size: %zu", key.c_str(), key.size());
 #endif
-  if (start_stats_.load())
-    this->key_stats_[key] += 1;
-
-  if (this->enable_hotspot_identification_.load())
-  {
-    for (auto& hs : this->heat_separators)
-      hs->Get(key);
-  }
+  this->RecordKey(key, kGet);
 
   return 0;
 }
@@ -170,59 +232,464 @@ int KeyStatsDB::Scan(const std::string &table, const std::string &key,
 int KeyStatsDB::Update(const std::string &table, const std::string &key,
              std::vector<KVPair> &values)
 {
-  std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
 #ifdef DEBUG
   YCSB_C_LOG_INFO("UPDATE: %s, key_size: %zu, value_size: %zu", key.c_str(), key.size(), values[0].second.size());
 #endif
+  this->RecordKey(key, kPut);
+
+  return 0;
+}
+
+int KeyStatsDB::Insert(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values)
+{
+#ifdef DEBUG
+  YCSB_C_LOG_INFO("INSERT: %s, key_size: %zu, value_size: %zu", key.c_str(), key.size(), values[0].second.size());
+#endif
+  this->RecordKey(key, kPut);
+  
+  return 0;
+}             
+
+int KeyStatsDB::Delete(const std::string &table, const std::string &key)
+{
+#ifdef DEBUG
+  YCSB_C_LOG_INFO("DELETE: %s", key.c_str());
+#endif
+  this->RecordKey(key, kDelete);
+  return 0;
+}
+
+int KeyStatsDB::Update(const std::string &table, const std::string &key,
+             const std::vector<KVPairView> &values)
+{
+#ifdef DEBUG
+  YCSB_C_LOG_INFO("UPDATE: %s, key_size: %zu, value_size: %zu", key.c_str(), key.size(), values[0].second.size());
+#endif
+  this->RecordKey(key, kPut);
+
+  return 0;
+}
+
+int KeyStatsDB::Insert(const std::string &table, const std::string &key,
+             const std::vector<KVPairView> &values)
+{
+#ifdef DEBUG
+  YCSB_C_LOG_INFO("INSERT: %s, key_size: %zu, value_size: %zu", key.c_str(), key.size(), values[0].second.size());
+#endif
+  this->RecordKey(key, kPut);
+
+  return 0;
+}
+
+void KeyStatsDB::SetOpContext(const OpContext &ctx)
+{
+  t_op_context = ctx;
+}
+
+void KeyStatsDB::SetReorderWindow(size_t window)
+{
+  std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
+  this->reorder_slots_.assign(window, PendingAccess());
+}
+
+void KeyStatsDB::RecordKey(const std::string &key, KeyAccess access)
+{
+  std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
+  if (this->reorder_slots_.empty() || t_op_context.sequence == kNoSequence)
+    this->ApplyKey(key, access, t_op_context.timestamp, t_op_context.ttl);
+  else
+    this->ReorderKey(t_op_context, key, access);
+}
+
+template <typename Key>
+void KeyStatsDB::ReorderKey(const OpContext &ctx, const Key &key, KeyAccess access)
+{
+  const uint64_t window = this->reorder_slots_.size();
+  const uint64_t sequence = ctx.sequence;
+  // 已越过的序号：迟到，直接统计
+  if (sequence < this->reorder_next_)
+  {
+    this->reorder_late_++;
+    this->ApplyKey(key, access, ctx.timestamp, ctx.ttl);
+    return;
+  }
+  // 超出窗口：按序统计窗口内已到达的请求，缺失的序号不再等待
+  if (sequence >= this->reorder_next_ + window)
+  {
+    uint64_t next = sequence - window + 1;
+    for (uint64_t seq = this->reorder_next_; seq < std::min(next, this->reorder_next_ + window); seq++)
+    {
+      PendingAccess& slot = this->reorder_slots_[seq % window];
+      if (slot.sequence == seq)
+        this->ApplyReorderSlot(slot);
+    }
+    this->reorder_next_ = next;
+  }
+  PendingAccess& slot = this->reorder_slots_[sequence % window];
+  slot.sequence = sequence;
+  slot.accesses = ctx.accesses;
+  slot.timestamp = ctx.timestamp;
+  slot.ttl = ctx.ttl;
+  this->HoldKey(slot, key, access);
+  this->reorder_held_++;
+  // 统计从 reorder_next_ 开始连续到齐的请求
+  while (true)
+  {
+    PendingAccess& next_slot = this->reorder_slots_[this->reorder_next_ % window];
+    if (next_slot.sequence != this->reorder_next_ ||
+        next_slot.keys.size() + next_slot.key_ids.size() < next_slot.accesses)
+      break;
+    this->ApplyReorderSlot(next_slot);
+    this->reorder_next_++;
+  }
+}
+
+void KeyStatsDB::ApplyReorderSlot(PendingAccess &slot)
+{
+  for (const auto& access : slot.keys)
+    this->ApplyKey(access.first, access.second, slot.timestamp, slot.ttl);
+  for (const auto& access : slot.key_ids)
+    this->ApplyKey(access.first, access.second, slot.timestamp, slot.ttl);
+  slot.sequence = kNoSequence;
+  slot.keys.clear();
+  slot.key_ids.clear();
+}
+
+void KeyStatsDB::FlushReorder()
+{
+  if (this->reorder_slots_.empty())
+    return;
+  // 阶段结束：按序统计窗口内剩余的请求，下一阶段的序号从 0 开始
+  const uint64_t window = this->reorder_slots_.size();
+  for (uint64_t seq = this->reorder_next_; seq < this->reorder_next_ + window; seq++)
+  {
+    PendingAccess& slot = this->reorder_slots_[seq % window];
+    if (slot.sequence == seq)
+      this->ApplyReorderSlot(slot);
+  }
+  if (this->reorder_held_)
+    YCSB_C_LOG_INFO("Reorder window %lu: %lu accesses reordered by trace sequence, %lu arrived too late",
+                    window, this->reorder_held_, this->reorder_late_);
+  this->reorder_next_ = 0;
+  this->reorder_held_ = 0;
+  this->reorder_late_ = 0;
+}
+
+void KeyStatsDB::ApplyKey(const std::string &key, KeyAccess access, uint64_t timestamp, uint32_t ttl)
+{
+  if (this->expiry_wheel_)
+    this->ExpireKeys(key, access, timestamp, ttl);
+  if (access == kDelete)
+  {
+    this->RemoveKey(key);
+    return;
+  }
+
+  this->access_count_++;
   if (start_stats_.load())
-    this->key_stats_[key] += 1;
+  {
+    int64_t& count = this->key_stats_[key];
+    count += 1;
+    if (this->stack_distance_)
+      this->stack_distance_->Access(StackKey(count));
+  }
 
   if (this->enable_hotspot_identification_.load())
   {
     for (auto& hs : this->heat_separators)
-      hs->Put(key);
+    {
+      if (access == kPut)
+        hs->Put(key);
+      else
+        hs->Get(key);
+    }
+    for (auto& curve : this->curve_separators_)
+    {
+      if (access == kPut)
+        curve.separator->Put(key);
+      else
+        curve.separator->Get(key);
+    }
   }
 
-  return 0;
+  for (size_t i = 0; i < this->burst_tracks_.size(); i++)
+  {
+    if (key == this->bursts_->burst(i).key_name)
+      this->TrackBurst(i, key);
+  }
 }
 
-int KeyStatsDB::Insert(const std::string &table, const std::string &key,
-             std::vector<KVPair> &values)
+void KeyStatsDB::RemoveKey(const std::string &key)
+{
+  // 与过期一致，删除后保留 Key 的统计，删除请求本身计为一次访问
+  this->delete_count_++;
+  this->access_count_++;
+  if (start_stats_.load())
+  {
+    int64_t& count = this->key_stats_[key];
+    count += 1;
+    if (this->stack_distance_)
+      this->stack_distance_->Remove(StackKey(count));
+  }
+  if (this->enable_hotspot_identification_.load())
+  {
+    for (auto& hs : this->heat_separators)
+      hs->Remove(key);
+    for (auto& curve : this->curve_separators_)
+      curve.separator->Remove(key);
+  }
+}
+
+void KeyStatsDB::ExpireKeys(const std::string &key, KeyAccess access, uint64_t timestamp, uint32_t ttl)
+{
+  this->expiry_wheel_->Advance(timestamp, this->expired_keys_);
+  for (const auto& expired : this->expired_keys_)
+  {
+    if (this->stack_distance_ && start_stats_.load())
+    {
+      if (this->key_ids_used_.load(std::memory_order_relaxed))
+      {
+        this->stack_distance_->Remove(module::Separator::DecodeKeyId(expired));
+      }
+      else
+      {
+        auto it = this->key_stats_.find(expired);
+        if (it != this->key_stats_.end())
+          this->stack_distance_->Remove(StackKey(it->second));
+      }
+    }
+    for (auto& hs : this->heat_separators)
+      hs->OnExpire(expired);
+    for (auto& curve : this->curve_separators_)
+      curve.separator->OnExpire(expired);
+  }
+  this->expired_keys_.clear();
+  // 与 memcached 一致：写入以新的 TTL 重设过期时刻，TTL 为 0 则不再过期；读不改变过期时刻
+  if (access == kPut && ttl)
+    this->expiry_wheel_->Schedule(key, timestamp + ttl);
+  else if (access != kGet && this->expiry_wheel_->GetScheduledCount())
+    this->expiry_wheel_->Cancel(key);
+}
+
+void KeyStatsDB::RecordKeyId(uint64_t key_id, KeyAccess access)
 {
+  // 紧凑计数且无需热识别与突发统计时只做一次原子加，不加锁（计数与顺序无关，不经重排窗口）
+  if (access != kDelete && key_id < this->dense_key_count_ &&
+      !this->enable_hotspot_identification_.load() && this->burst_tracks_.empty())
+  {
+    if (start_stats_.load())
+      this->dense_counts_[key_id].fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
-#ifdef DEBUG
-  YCSB_C_LOG_INFO("INSERT: %s, key_size: %zu, value_size: %zu", key.c_str(), key.size(), values[0].second.size());
-#endif
+  this->key_ids_used_.store(true, std::memory_order_relaxed);
+  if (this->reorder_slots_.empty() || t_op_context.sequence == kNoSequence)
+    this->ApplyKey(key_id, access, t_op_context.timestamp, t_op_context.ttl);
+  else
+    this->ReorderKey(t_op_context, key_id, access);
+}
+
+void KeyStatsDB::ApplyKey(uint64_t key_id, KeyAccess access, uint64_t timestamp, uint32_t ttl)
+{
+  // 过期时间轮中以编码后的 id 登记，与热识别模块的 id 接口一致
+  if (this->expiry_wheel_)
+    this->ExpireKeys(module::Separator::EncodeKeyId(key_id), access, timestamp, ttl);
+  if (access == kDelete)
+  {
+    this->RemoveKeyId(key_id);
+    return;
+  }
+
+  this->access_count_++;
   if (start_stats_.load())
-    this->key_stats_[key] += 1;
+  {
+    if (key_id < this->dense_key_count_)
+      this->dense_counts_[key_id].fetch_add(1, std::memory_order_relaxed);
+    else
+      this->key_id_stats_[key_id] += 1;
+    if (this->stack_distance_)
+      this->stack_distance_->Access(key_id);
+  }
 
   if (this->enable_hotspot_identification_.load())
   {
     for (auto& hs : this->heat_separators)
-      hs->Put(key);
+    {
+      if (access == kPut)
+        hs->Put(key_id);
+      else
+        hs->Get(key_id);
+    }
+    for (auto& curve : this->curve_separators_)
+    {
+      if (access == kPut)
+        curve.separator->Put(key_id);
+      else
+        curve.separator->Get(key_id);
+    }
   }
-  
+
+  for (size_t i = 0; i < this->burst_tracks_.size(); i++)
+  {
+    if (key_id == this->bursts_->burst(i).key_id)
+      this->TrackBurst(i, key_id);
+  }
+}
+
+template <typename Key>
+void KeyStatsDB::TrackBurst(size_t i, const Key &key)
+{
+  // 冷 Key 在突发开始前也可能被访问，只统计注入之后的访问
+  if (!this->bursts_->burst(i).injected())
+    return;
+  BurstTrack& track = this->burst_tracks_[i];
+  if (track.hits++ == 0)
+    track.first_access = this->access_count_;
+  if (!this->enable_hotspot_identification_.load())
+    return;
+  // 热识别模块在首个客户端线程 Init 时才创建
+  track.detected_access.resize(this->heat_separators.size(), 0);
+  track.detected_ns.resize(this->heat_separators.size(), 0);
+  // 每次访问突发 Key 后询问各模块，记录首次进入热集合的时刻
+  for (size_t j = 0; j < this->heat_separators.size(); j++)
+  {
+    if (track.detected_ns[j] == 0 && this->heat_separators[j]->IsHotKey(key))
+    {
+      track.detected_access[j] = this->access_count_;
+      track.detected_ns[j] = BurstInjector::NowNanos();
+    }
+  }
+}
+
+int KeyStatsDB::Read(const std::string &table, uint64_t key_id,
+           const std::vector<std::string> *fields,
+           std::vector<KVPair> &result)
+{
+#ifdef DEBUG
+  YCSB_C_LOG_INFO("READ: %lu", key_id);
+#endif
+  this->RecordKeyId(key_id, kGet);
   return 0;
-}             
+}
 
-int KeyStatsDB::Delete(const std::string &table, const std::string &key)
+int KeyStatsDB::Scan(const std::string &table, uint64_t key_id,
+           int len, const std::vector<std::string> *fields,
+           std::vector<std::vector<KVPair>> &result)
+{
+  YCSB_C_LOG_ERROR("SCAN is not support");
+  return 0;
+}
+
+int KeyStatsDB::Update(const std::string &table, uint64_t key_id,
+             const std::vector<KVPairView> &values)
 {
-  std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
 #ifdef DEBUG
-  YCSB_C_LOG_INFO("DELETE: %s", key.c_str());
+  YCSB_C_LOG_INFO("UPDATE: %lu, value_size: %zu", key_id, values[0].second.size());
 #endif
-  if (start_stats_.load())
-    this->key_stats_.erase(key);
+  this->RecordKeyId(key_id, kPut);
+  return 0;
+}
+
+int KeyStatsDB::Insert(const std::string &table, uint64_t key_id,
+             const std::vector<KVPairView> &values)
+{
+#ifdef DEBUG
+  YCSB_C_LOG_INFO("INSERT: %lu, value_size: %zu", key_id, values[0].second.size());
+#endif
+  this->RecordKeyId(key_id, kPut);
+  return 0;
+}
+
+int KeyStatsDB::Delete(const std::string &table, uint64_t key_id)
+{
+#ifdef DEBUG
+  YCSB_C_LOG_INFO("DELETE: %lu", key_id);
+#endif
+  this->RecordKeyId(key_id, kDelete);
   return 0;
 }
 
+void KeyStatsDB::RemoveKeyId(uint64_t key_id)
+{
+  this->delete_count_++;
+  this->access_count_++;
+  if (start_stats_.load())
+  {
+    if (key_id < this->dense_key_count_)
+      this->dense_counts_[key_id].fetch_add(1, std::memory_order_relaxed);
+    else
+      this->key_id_stats_[key_id] += 1;
+    if (this->stack_distance_)
+      this->stack_distance_->Remove(key_id);
+  }
+  if (this->enable_hotspot_identification_.load())
+  {
+    for (auto& hs : this->heat_separators)
+      hs->Remove(key_id);
+    for (auto& curve : this->curve_separators_)
+      curve.separator->Remove(key_id);
+  }
+}
+
 int KeyStatsDB::Special(const std::string &command)
 {
+  if ("PAUSE" == command || "STOP" == command)
+  {
+    std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
+    this->FlushReorder();
+    // 下一阶段从 Trace 开头重放，时钟重新开始
+    if (this->expiry_wheel_)
+      this->expiry_wheel_->Clear();
+  }
   if ("PAUSE" == command)
     this->start_stats_.store(true);
   return 0;
 }
 
+void KeyStatsDB::SetBursts(const BurstInjector *bursts)
+{
+  std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
+  this->bursts_ = bursts;
+  this->burst_tracks_.assign(bursts ? bursts->size() : 0, BurstTrack());
+}
+
+void KeyStatsDB::SetLeanCounting(uint64_t key_count)
+{
+  std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
+  if (this->dense_counts_ || key_count == 0)
+    return;
+  // 匿名映射的页在首次写入前不占物理内存，且内容为 0
+  size_t bytes = key_count * sizeof(std::atomic<uint32_t>);
+  void* counts = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (counts == MAP_FAILED)
+  {
+    YCSB_C_LOG_ERROR("Lean counting: mmap of %zu bytes failed", bytes);
+    exit(EXIT_FAILURE);
+  }
+  this->dense_counts_ = static_cast<std::atomic<uint32_t>*>(counts);
+  this->dense_key_count_ = key_count;
+  this->key_ids_used_.store(true);
+  YCSB_C_LOG_INFO("Lean counting: %lu keys, %.2f GB of counters", key_count, bytes / 1e9);
+}
+
+void KeyStatsDB::SetCapacityCurve(bool enabled)
+{
+  this->capacity_curve_ = enabled;
+}
+
+void KeyStatsDB::SetSampleRate(double rate)
+{
+  this->sample_rate_ = rate;
+}
+
+void KeyStatsDB::SetBinaryOutput(bool enabled)
+{
+  this->binary_output_ = enabled;
+}
+
 void KeyStatsDB::SetWorkloadFileName(const std::string &file_name)
 {
   std::vector<std::string> parts;
@@ -242,83 +709,615 @@ void KeyStatsDB::SetWorkloadFileName(const std::string &file_name)
   YCSB_C_LOG_INFO("Workload Name: %s", this->workload_name_.c_str());
 }
 
+bool KeyStatsDB::KeyDictLess(KeyStatRef a, KeyStatRef b)
+{
+  if (a->first.size() != b->first.size())
+    return a->first.size() < b->first.size();
+  return a->first < b->first;
+}
+
+bool KeyStatsDB::KeyCountGreater(KeyStatRef a, KeyStatRef b)
+{
+  if (a->second != b->second)
+    return a->second > b->second;
+  return KeyDictLess(a, b);
+}
+
 void KeyStatsDB::OutputStats()
 {
   std::lock_guard<std::mutex> lock(this->key_stats_mtx_);
-  
-  // 降序输出的 vector
-  std::vector<std::pair<std::string, int64_t>> key_stats_freq_descend(this->key_stats_.begin(), this->key_stats_.end());
-  // 降序
-  auto descend_cmp = [](const auto& a, const auto& b) {
-        return a.second > b.second;
-  };
-  std::sort(key_stats_freq_descend.begin(), key_stats_freq_descend.end(), descend_cmp);
-  std::vector<std::pair<std::string, int64_t>> key_stats_dict_ordered(this->key_stats_.begin(), this->key_stats_.end());
-  // 字典排序
-  auto dict_cmp = [](const auto& a, const auto& b) {
-      if (a.first.size() != b.first.size()) 
-        return a.first.size() < b.first.size();
-      return a.first < b.first;
-  };
-  std::sort(key_stats_dict_ordered.begin(), key_stats_dict_ordered.end(), dict_cmp);
+
+  if (this->delete_count_ || (this->expiry_wheel_ && this->expiry_wheel_->GetExpiredCount()))
+    YCSB_C_LOG_INFO("Deleted keys: %lu, TTL-expired keys removed from separators: %lu",
+                    this->delete_count_, this->expiry_wheel_ ? this->expiry_wheel_->GetExpiredCount() : 0);
+
+  KeyStatRows rows;
+  if (this->dense_key_count_ > 0)
+  {
+    std::unordered_set<std::string> true_hot_keys;
+    this->OutputDenseKeyStats(this->stack_distance_ ? &true_hot_keys : nullptr, rows);
+    std::vector<std::vector<std::string>> separator_hot_keys;
+    this->OutputSeparatorHotKeys(separator_hot_keys, rows);
+    if (this->stack_distance_)
+      this->OutputCapacityCurve(true_hot_keys);
+    if (!this->tenant_key_formats_.empty())
+      YCSB_C_LOG_INFO("Tenant stats are not supported with lean counting, skipped");
+    if (!this->burst_tracks_.empty())
+      this->OutputBurstStats();
+    return;
+  }
+
+  // 整数 Key 模式：按 Key 格式还原为字符串，输出与字符串模式一致
+  for (const auto& ks : this->key_id_stats_)
+    this->key_stats_[this->KeyName(ks.first)] += ks.second;
+  this->key_id_stats_.clear();
+
+  std::vector<KeyStatRef> key_stats_freq_descend;
+  key_stats_freq_descend.reserve(this->key_stats_.size());
+  for (const auto& ks : this->key_stats_)
+    key_stats_freq_descend.push_back(&ks);
 
   YCSB_C_LOG_INFO("===========\nTotal Key Num: %zu", key_stats_freq_descend.size());
+  if (this->sample_rate_ < 1.0)
+  {
+    uint64_t access_num = 0;
+    for (const auto& ks : this->key_stats_)
+      access_num += ks.second;
+    this->OutputSampling(key_stats_freq_descend.size(), access_num);
+  }
+
+  // Top-N 的键视为热 key：只需选出前 N 个并对这一段排序
+  size_t portion_threshold = static_cast<size_t>(key_stats_freq_descend.size() * g_hot_key_portion);
+  size_t hot_num = std::min(portion_threshold + 1, key_stats_freq_descend.size());
+  auto hot_end = key_stats_freq_descend.begin() + hot_num;
+  std::nth_element(key_stats_freq_descend.begin(), hot_end, key_stats_freq_descend.end(), KeyCountGreater);
+  std::sort(key_stats_freq_descend.begin(), hot_end, KeyCountGreater);
+  if (this->binary_output_)
+  {
+    tbb::parallel_sort(hot_end, key_stats_freq_descend.end(), KeyCountGreater);
+    this->OutputKeyStatsBinary(key_stats_freq_descend, hot_num, rows);
+  }
+  else
+    this->OutputKeyStatsCsv(key_stats_freq_descend, hot_num);
+  YCSB_C_LOG_INFO("Hot Key Portion: %lf", g_hot_key_portion);
+  YCSB_C_LOG_INFO("Hot Key Frequency Threshold: %zu", portion_threshold);
 
-  // 输出到文件
-  std::fstream output_file_original("./" + this->workload_name_ + "_key_stats.csv", std::ios::out);
-  std::fstream output_file_descend("./" + this->workload_name_ + "_key_stats_descend.csv", std::ios::out);
-  std::fstream output_file_dict_ordered("./" + this->workload_name_ + "_key_stats_dict_ordered.csv", std::ios::out);
-  std::fstream output_file_hotkeys("./" + this->workload_name_ + "_key_stats_hotkeys.csv", std::ios::out);
-  if (!output_file_original.is_open() || !output_file_descend.is_open() || !output_file_dict_ordered.is_open())
+  std::vector<std::vector<std::string>> separator_hot_keys;
+  this->OutputSeparatorHotKeys(separator_hot_keys, rows);
+  if (this->stack_distance_)
+  {
+    std::unordered_set<std::string> true_hot_keys;
+    for (size_t i = 0; i < hot_num; i++)
+      true_hot_keys.insert(key_stats_freq_descend[i]->first);
+    this->OutputCapacityCurve(true_hot_keys);
+  }
+
+  if (!this->tenant_key_formats_.empty())
+    this->OutputTenantStats(key_stats_freq_descend, portion_threshold, separator_hot_keys);
+  if (!this->burst_tracks_.empty())
+    this->OutputBurstStats();
+}
+
+void KeyStatsDB::OutputKeyStatsCsv(std::vector<KeyStatRef>& key_stats_freq_descend, size_t hot_num)
+{
+  StatsFileWriter output_file_original("./" + this->workload_name_ + "_key_stats.csv");
+  StatsFileWriter output_file_descend("./" + this->workload_name_ + "_key_stats_descend.csv");
+  StatsFileWriter output_file_dict_ordered("./" + this->workload_name_ + "_key_stats_dict_ordered.csv");
+  StatsFileWriter output_file_hotkeys("./" + this->workload_name_ + "_key_stats_hotkeys.csv");
+  if (!output_file_original.is_open() || !output_file_descend.is_open() || !output_file_dict_ordered.is_open()
+      || !output_file_hotkeys.is_open())
   {
     YCSB_C_LOG_ERROR("key_stats csv file open failed");
     exit(EXIT_FAILURE);    
   }
-  for (const auto& ks : this->key_stats_)
-    output_file_original << ks.first << "," << ks.second << std::endl;
-  output_file_original.close();
+  // 各文件在单独的线程上格式化、写出，与排序重叠
+  auto write_original = std::async(std::launch::async, [&]() {
+    for (const auto& ks : this->key_stats_)
+      output_file_original.Write(ks.first, ks.second);
+    output_file_original.Close();
+  });
+  auto hot_end = key_stats_freq_descend.begin() + hot_num;
+  auto write_hotkeys = std::async(std::launch::async, [&]() {
+    for (auto it = key_stats_freq_descend.begin(); it != hot_end; ++it)
+      output_file_hotkeys.Write((*it)->first);
+    output_file_hotkeys.Close();
+  });
+
+  // 全量降序、字典序文件：余下部分并行排序
+  tbb::parallel_sort(hot_end, key_stats_freq_descend.end(), KeyCountGreater);
+  auto write_descend = std::async(std::launch::async, [&]() {
+    for (KeyStatRef ks : key_stats_freq_descend)
+      output_file_descend.Write(ks->first, ks->second);
+    output_file_descend.Close();
+  });
+  std::vector<KeyStatRef> key_stats_dict_ordered(key_stats_freq_descend);
+  tbb::parallel_sort(key_stats_dict_ordered.begin(), key_stats_dict_ordered.end(), KeyDictLess);
+  for (KeyStatRef ks : key_stats_dict_ordered)
+    output_file_dict_ordered.Write(ks->first, ks->second);
+  output_file_dict_ordered.Close();
+
+  write_original.get();
   YCSB_C_LOG_INFO("%s_key_stats.csv is generated successfully", this->workload_name_.c_str());
-  for (const auto& ks : key_stats_freq_descend)
-    output_file_descend << ks.first << "," << ks.second << std::endl;
-  output_file_descend.close();
+  write_descend.get();
   YCSB_C_LOG_INFO("%s_key_stats_descend.csv is generated successfully", this->workload_name_.c_str());
-  for (const auto& ks : key_stats_dict_ordered)
-    output_file_dict_ordered << ks.first << "," << ks.second << std::endl;
-  output_file_dict_ordered.close();
   YCSB_C_LOG_INFO("%s_key_stats_dict_ordered.csv is generated successfully", this->workload_name_.c_str());
-  // Top-N 的键视为热 key
-  YCSB_C_LOG_INFO("Hot Key Portion: %lf", g_hot_key_portion);
-  size_t portion_threshold = static_cast<size_t>(key_stats_freq_descend.size() * g_hot_key_portion);
-  YCSB_C_LOG_INFO("Hot Key Frequency Threshold: %zu", portion_threshold);
-  for (size_t i = 0; i < key_stats_freq_descend.size(); i++)
+  write_hotkeys.get();
+  YCSB_C_LOG_INFO("%s_key_stats_hotkeys.csv is generated successfully", this->workload_name_.c_str());
+}
+
+void KeyStatsDB::OutputKeyStatsBinary(const std::vector<KeyStatRef>& key_stats_freq_descend, size_t hot_num,
+                                      KeyStatRows& rows)
+{
+  // 按字典序排列各行，名次即在降序中的下标
+  std::vector<std::pair<KeyStatRef, uint64_t>> ranked(key_stats_freq_descend.size());
+  for (size_t i = 0; i < ranked.size(); i++)
+    ranked[i] = {key_stats_freq_descend[i], i};
+  tbb::parallel_sort(ranked.begin(), ranked.end(),
+                     [](const auto& a, const auto& b) { return KeyDictLess(a.first, b.first); });
+  std::vector<uint64_t> offsets(ranked.size()), ranks(ranked.size());
+  std::vector<int64_t> counts(ranked.size());
+  rows.keys.resize(ranked.size());
+  uint64_t offset = 0;
+  for (size_t i = 0; i < ranked.size(); i++)
   {
-    if (i <= portion_threshold)
-      output_file_hotkeys << key_stats_freq_descend[i].first << std::endl;
+    rows.keys[i] = ranked[i].first;
+    offsets[i] = offset;
+    offset += ranked[i].first->first.size();
+    counts[i] = ranked[i].first->second;
+    ranks[i] = ranked[i].second;
   }
-  output_file_hotkeys.close();
-  YCSB_C_LOG_INFO("%s_key_stats_hotkeys.csv is generated successfully", this->workload_name_.c_str());
+  this->WriteKeyStatsBinary(offsets, counts, ranks, hot_num, &rows.keys);
+}
+
+void KeyStatsDB::WriteKeyStatsBinary(const std::vector<uint64_t>& keys, const std::vector<int64_t>& counts,
+                                     const std::vector<uint64_t>& ranks, uint64_t hot_rows,
+                                     const std::vector<KeyStatRef>* key_names)
+{
+  std::string file_name = "./" + this->workload_name_ + "_key_stats.bin";
+  StatsFileWriter bin_file(file_name);
+  if (!bin_file.is_open())
+  {
+    YCSB_C_LOG_ERROR("%s open failed", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  uint64_t key_bytes = 0, accesses = 0;
+  if (key_names)
+  {
+    for (KeyStatRef ks : *key_names)
+      key_bytes += ks->first.size();
+  }
+  for (int64_t count : counts)
+    accesses += count;
+  // 头部：magic | rows | hot_rows | key_kind | key_bytes | accesses | 保留 × 2
+  uint64_t header[8] = {0, keys.size(), hot_rows, key_names ? 0ull : 1ull, key_bytes, accesses, 0, 0};
+  std::memcpy(header, kKeyStatsMagic, sizeof(header[0]));
+  bin_file.WriteBytes(header, sizeof(header));
+  bin_file.WriteBytes(keys.data(), keys.size() * sizeof(uint64_t));
+  bin_file.WriteBytes(counts.data(), counts.size() * sizeof(int64_t));
+  bin_file.WriteBytes(ranks.data(), ranks.size() * sizeof(uint64_t));
+  if (key_names)
+  {
+    for (KeyStatRef ks : *key_names)
+      bin_file.WriteBytes(ks->first.data(), ks->first.size());
+  }
+  bin_file.Close();
+  YCSB_C_LOG_INFO("%s is generated successfully (%zu keys, %lu hot)", file_name.c_str(), keys.size(), hot_rows);
+}
+
+void KeyStatsDB::OutputSampling(size_t key_num, uint64_t access_num)
+{
+  if (this->sample_rate_ >= 1.0)
+    return;
+  // 采样率与按采样率放大后的全量估计，供 parse_keystats.py 还原计数
+  double estimated_keys = key_num / this->sample_rate_;
+  double estimated_accesses = access_num / this->sample_rate_;
+  YCSB_C_LOG_INFO("Sample rate %g: estimated %.0f keys, %.0f accesses in the full trace",
+                  this->sample_rate_, estimated_keys, estimated_accesses);
+  std::string file_name = "./" + this->workload_name_ + "_sampling.csv";
+  std::fstream sampling_file(file_name, std::ios::out);
+  if (!sampling_file.is_open())
+  {
+    YCSB_C_LOG_ERROR("%s open failed", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  sampling_file << "sample_rate,keys,accesses,estimated_keys,estimated_accesses" << std::endl;
+  sampling_file << this->sample_rate_ << "," << key_num << "," << access_num << ","
+                << std::llround(estimated_keys) << "," << std::llround(estimated_accesses) << std::endl;
+  sampling_file.close();
+  YCSB_C_LOG_INFO("%s is generated successfully", file_name.c_str());
+}
+
+void KeyStatsDB::OutputBurstStats()
+{
+  // 每个突发一行 key_stats（注入信息与访问次数），每个热识别模块一行识别延迟：
+  // delay_ops 为突发 Key 注入后首次到达至被识别之间的访问总数，
+  // delay_us 为注入时刻至被识别的时间，未识别时均为 -1
+  std::string file_name = "./" + this->workload_name_ + "_burst_stats.csv";
+  std::fstream burst_file(file_name, std::ios::out);
+  if (!burst_file.is_open())
+  {
+    YCSB_C_LOG_ERROR("%s open failed", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  burst_file << "burst,kind,key,start,ops,fraction,injected_op,hits,separator,delay_ops,delay_us" << std::endl;
+  for (size_t i = 0; i < this->burst_tracks_.size(); i++)
+  {
+    const BurstInjector::Burst& burst = this->bursts_->burst(i);
+    BurstTrack& track = this->burst_tracks_[i];
+    track.detected_access.resize(this->heat_separators.size(), 0);
+    track.detected_ns.resize(this->heat_separators.size(), 0);
+    const std::string key = this->key_ids_used_.load() ? this->KeyName(burst.key_id) : burst.key_name;
+    std::stringstream row;
+    row << i << "," << BurstInjector::KindName(burst.kind) << "," << key << ","
+        << burst.start << "," << burst.ops << "," << burst.fraction << ",";
+    if (burst.injected())
+      row << burst.injected_op.load();
+    else
+      row << -1;
+    row << "," << track.hits << ",";
+    YCSB_C_LOG_INFO("Burst %zu (%s key %s): injected %s, hits %lu", i, BurstInjector::KindName(burst.kind),
+                    key.c_str(), burst.injected() ? "yes" : "no", track.hits);
+    burst_file << row.str() << "key_stats,0,0" << std::endl;
+    for (size_t j = 0; j < this->heat_separators.size(); j++)
+    {
+      burst_file << row.str() << this->heat_separators[j]->GetName() << ",";
+      if (track.detected_ns[j] == 0)
+      {
+        burst_file << "-1,-1" << std::endl;
+        YCSB_C_LOG_INFO("  %s: not identified", this->heat_separators[j]->GetName().c_str());
+        continue;
+      }
+      uint64_t delay_ops = track.detected_access[j] - track.first_access;
+      double delay_us = (track.detected_ns[j] - burst.injected_ns.load()) / 1000.0;
+      burst_file << delay_ops << "," << delay_us << std::endl;
+      YCSB_C_LOG_INFO("  %s: identified after %lu ops, %.1f us", this->heat_separators[j]->GetName().c_str(),
+                      delay_ops, delay_us);
+    }
+  }
+  burst_file.close();
+  YCSB_C_LOG_INFO("%s is generated successfully", file_name.c_str());
+}
 
+void KeyStatsDB::OutputSeparatorHotKeys(std::vector<std::vector<std::string>>& separator_hot_keys,
+                                        const KeyStatRows& rows)
+{
   // 冷热识别模块输出到文件
-  std::vector<std::string> hot_keys;
+  separator_hot_keys.assign(this->heat_separators.size(), std::vector<std::string>());
   for (size_t i = 0; i < this->heat_separators.size(); i++)
   {
     // join file name
-    std::string file_name = "./" + this->workload_name_ + "_hotkeys_" + this->heat_separators[i]->GetName() + ".csv";
-    hot_keys.clear();
-    this->heat_separators[i]->GetHotKeys(hot_keys);
-    std::fstream hk_file(file_name, std::ios::out);
+    std::string file_name = "./" + this->workload_name_ + "_hotkeys_" + this->heat_separators[i]->GetName()
+                          + (this->binary_output_ ? ".bin" : ".csv");
+    std::vector<std::string>& hot_keys = separator_hot_keys[i];
+    std::vector<uint64_t> hot_key_ids;
+    if (this->key_ids_used_.load())
+    {
+      this->heat_separators[i]->GetHotKeyIds(hot_key_ids);
+      for (auto key_id : hot_key_ids)
+        hot_keys.push_back(this->KeyName(key_id));
+    }
+    else
+      this->heat_separators[i]->GetHotKeys(hot_keys);
+    StatsFileWriter hk_file(file_name);
     if (!hk_file.is_open())
     {
       YCSB_C_LOG_ERROR("%s open failed", file_name.c_str());
       exit(EXIT_FAILURE);
     }
-    for (auto const& h_k : hot_keys)
-      hk_file << h_k << std::endl;
-    hk_file.close();
+    if (this->binary_output_)
+    {
+      // 热 Key 换算为 _key_stats.bin 中的行号（各行有序，二分查找）
+      std::vector<int64_t> hot_rows;
+      if (this->dense_key_count_ > 0)
+      {
+        for (auto key_id : hot_key_ids)
+        {
+          auto it = std::lower_bound(rows.key_ids.begin(), rows.key_ids.end(), key_id);
+          hot_rows.push_back((it != rows.key_ids.end() && *it == key_id) ? it - rows.key_ids.begin() : -1);
+        }
+      }
+      else
+      {
+        auto key_less = [](KeyStatRef ks, const std::string& key) {
+          if (ks->first.size() != key.size())
+            return ks->first.size() < key.size();
+          return ks->first < key;
+        };
+        for (const auto& key : hot_keys)
+        {
+          auto it = std::lower_bound(rows.keys.begin(), rows.keys.end(), key, key_less);
+          hot_rows.push_back((it != rows.keys.end() && (*it)->first == key) ? it - rows.keys.begin() : -1);
+        }
+      }
+      // 头部：magic | rows
+      uint64_t header[2] = {0, hot_rows.size()};
+      std::memcpy(header, kHotKeysMagic, sizeof(header[0]));
+      hk_file.WriteBytes(header, sizeof(header));
+      hk_file.WriteBytes(hot_rows.data(), hot_rows.size() * sizeof(int64_t));
+    }
+    else
+    {
+      for (auto const& h_k : hot_keys)
+        hk_file.Write(h_k);
+    }
+    hk_file.Close();
 
     YCSB_C_LOG_INFO("%s is generated successfully", file_name.c_str());
   }
 }
 
+void KeyStatsDB::OutputCapacityCurve(const std::unordered_set<std::string>& true_hot_keys)
+{
+  // 容量按全量 Trace 计：采样重放时栈距离与实例容量均为采样内的值，除以采样率还原
+  const double scale = 1.0 / this->sample_rate_;
+  std::string mrc_name = "./" + this->workload_name_ + "_mrc.csv";
+  std::fstream mrc_file(mrc_name, std::ios::out);
+  if (!mrc_file.is_open())
+  {
+    YCSB_C_LOG_ERROR("%s open failed", mrc_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  // LRU 命中率曲线：容量按约 5% 的间隔取点，至只剩冷缺失为止
+  std::vector<double> hit_ratios = this->stack_distance_->GetHitRatios();
+  std::vector<size_t> points;
+  for (size_t c = 1; c < hit_ratios.size(); c = std::max(c + 1, static_cast<size_t>(c * 1.05)))
+    points.push_back(c);
+  if (!hit_ratios.empty())
+    points.push_back(hit_ratios.size());
+  mrc_file << "capacity,hit_ratio,miss_ratio" << std::endl;
+  for (size_t c : points)
+    mrc_file << std::llround(c * scale) << "," << hit_ratios[c - 1] << "," << 1 - hit_ratios[c - 1] << std::endl;
+  mrc_file.close();
+  YCSB_C_LOG_INFO("LRU stack distances over %lu accesses (%lu cold misses): %s is generated successfully",
+                  this->stack_distance_->GetAccessCount(), this->stack_distance_->GetColdMisses(), mrc_name.c_str());
+
+  // 各模块在各容量下识别出的热 Key 与真实热 Key（Top hot_key_portion）比较
+  std::string curve_name = "./" + this->workload_name_ + "_capacity_curve.csv";
+  std::fstream curve_file(curve_name, std::ios::out);
+  if (!curve_file.is_open())
+  {
+    YCSB_C_LOG_ERROR("%s open failed", curve_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  curve_file << "separator,capacity,identified,precision,recall" << std::endl;
+  for (auto& curve : this->curve_separators_)
+  {
+    std::vector<std::string> hot_keys;
+    if (this->key_ids_used_.load())
+    {
+      std::vector<uint64_t> hot_key_ids;
+      curve.separator->GetHotKeyIds(hot_key_ids);
+      for (auto key_id : hot_key_ids)
+        hot_keys.push_back(this->KeyName(key_id));
+    }
+    else
+      curve.separator->GetHotKeys(hot_keys);
+    // 部分模块返回的热 Key 可能重复
+    std::unordered_set<std::string> identified(hot_keys.begin(), hot_keys.end());
+    size_t hit = 0;
+    for (const auto& key : identified)
+      hit += true_hot_keys.count(key);
+    double precision = identified.empty() ? 0 : static_cast<double>(hit) / identified.size();
+    double recall = true_hot_keys.empty() ? 0 : static_cast<double>(hit) / true_hot_keys.size();
+    curve_file << curve.separator->GetName() << "," << curve.capacity << "," << identified.size() << ","
+               << precision << "," << recall << std::endl;
+  }
+  curve_file.close();
+  YCSB_C_LOG_INFO("%s is generated successfully", curve_name.c_str());
+}
+
+void KeyStatsDB::OutputDenseKeyStats(std::unordered_set<std::string>* true_hot_keys, KeyStatRows& rows)
+{
+  // 紧凑计数模式：不构造 <string, count> 表，按 id 流式输出；
+  // 降序只对非零 Key 的 id 排序（8 字节/Key），字典序文件在此模式下不输出
+  std::vector<uint64_t> dense_ids;
+  uint64_t access_num = 0;
+  for (uint64_t id = 0; id < this->dense_key_count_; id++)
+  {
+    uint32_t count = this->dense_counts_[id].load(std::memory_order_relaxed);
+    if (count)
+    {
+      dense_ids.push_back(id);
+      access_num += count;
+    }
+  }
+  auto dense_count = [this](uint64_t id) {
+    return this->dense_counts_[id].load(std::memory_order_relaxed);
+  };
+  // 计数相同时按 id，使输出与排序算法、线程数无关；
+  // 二进制输出时 dense_ids 保持升序（即 _key_stats.bin 的行序），改为对行号排序，归并时直接得到各行的名次
+  std::vector<uint64_t> dense_order;
+  if (this->binary_output_)
+  {
+    dense_order.resize(dense_ids.size());
+    std::iota(dense_order.begin(), dense_order.end(), 0);
+    tbb::parallel_sort(dense_order.begin(), dense_order.end(), [&](uint64_t a, uint64_t b) {
+      uint32_t count_a = dense_count(dense_ids[a]), count_b = dense_count(dense_ids[b]);
+      return count_a != count_b ? count_a > count_b : a < b;
+    });
+  }
+  else
+  {
+    tbb::parallel_sort(dense_ids.begin(), dense_ids.end(), [&](uint64_t a, uint64_t b) {
+      uint32_t count_a = dense_count(a), count_b = dense_count(b);
+      return count_a != count_b ? count_a > count_b : a < b;
+    });
+  }
+  // 降序中第 d 个紧凑计数 Key
+  auto dense_at = [&](size_t d) {
+    return dense_order.empty() ? dense_ids[d] : dense_ids[dense_order[d]];
+  };
+  // 超出计数数组的 Key（运行中插入等），按 id 升序排在紧凑计数 Key 之后
+  std::vector<std::pair<uint64_t, int64_t>> sparse(this->key_id_stats_.begin(), this->key_id_stats_.end());
+  std::sort(sparse.begin(), sparse.end());
+  std::vector<size_t> sparse_order(sparse.size());
+  std::iota(sparse_order.begin(), sparse_order.end(), 0);
+  std::sort(sparse_order.begin(), sparse_order.end(), [&](size_t a, size_t b) {
+    return sparse[a].second != sparse[b].second ? sparse[a].second > sparse[b].second : a < b;
+  });
+
+  // CSV 输出时使用
+  std::unique_ptr<StatsFileWriter> output_file_descend, output_file_hotkeys;
+  if (!this->binary_output_)
+  {
+    StatsFileWriter output_file_original("./" + this->workload_name_ + "_key_stats.csv");
+    output_file_descend.reset(new StatsFileWriter("./" + this->workload_name_ + "_key_stats_descend.csv"));
+    output_file_hotkeys.reset(new StatsFileWriter("./" + this->workload_name_ + "_key_stats_hotkeys.csv"));
+    if (!output_file_original.is_open() || !output_file_descend->is_open() || !output_file_hotkeys->is_open())
+    {
+      YCSB_C_LOG_ERROR("key_stats csv file open failed");
+      exit(EXIT_FAILURE);
+    }
+    for (uint64_t id = 0; id < this->dense_key_count_; id++)
+    {
+      uint32_t count = dense_count(id);
+      if (count)
+        output_file_original.Write(this->KeyName(id), count);
+    }
+    for (const auto& ks : this->key_id_stats_)
+      output_file_original.Write(this->KeyName(ks.first), ks.second);
+    output_file_original.Close();
+    YCSB_C_LOG_INFO("%s_key_stats.csv is generated successfully", this->workload_name_.c_str());
+  }
+
+  YCSB_C_LOG_INFO("Hot Key Portion: %lf", g_hot_key_portion);
+  size_t key_num = dense_ids.size() + sparse.size();
+  for (const auto& ks : sparse)
+    access_num += ks.second;
+  this->OutputSampling(key_num, access_num);
+  size_t portion_threshold = static_cast<size_t>(key_num * g_hot_key_portion);
+  YCSB_C_LOG_INFO("Hot Key Frequency Threshold: %zu", portion_threshold);
+  std::vector<uint64_t> ranks(this->binary_output_ ? key_num : 0);
+  // 归并两个降序序列
+  size_t d = 0, s = 0;
+  for (size_t i = 0; i < key_num; i++)
+  {
+    uint64_t id, row;
+    int64_t count;
+    if (s == sparse.size() || (d < dense_ids.size() && dense_count(dense_at(d)) >= sparse[sparse_order[s]].second))
+    {
+      row = dense_order.empty() ? d : dense_order[d];
+      id = dense_at(d++);
+      count = dense_count(id);
+    }
+    else
+    {
+      row = dense_ids.size() + sparse_order[s];
+      id = sparse[sparse_order[s]].first;
+      count = sparse[sparse_order[s++]].second;
+    }
+    if (this->binary_output_)
+    {
+      ranks[row] = i;
+      if (i <= portion_threshold && true_hot_keys)
+        true_hot_keys->insert(this->KeyName(id));
+      continue;
+    }
+    const std::string key = this->KeyName(id);
+    output_file_descend->Write(key, count);
+    if (i <= portion_threshold)
+    {
+      output_file_hotkeys->Write(key);
+      if (true_hot_keys)
+        true_hot_keys->insert(key);
+    }
+  }
+  if (this->binary_output_)
+  {
+    rows.key_ids = std::move(dense_ids);
+    std::vector<int64_t> counts;
+    counts.reserve(key_num);
+    for (uint64_t id : rows.key_ids)
+      counts.push_back(dense_count(id));
+    for (const auto& ks : sparse)
+    {
+      rows.key_ids.push_back(ks.first);
+      counts.push_back(ks.second);
+    }
+    this->WriteKeyStatsBinary(rows.key_ids, counts, ranks, std::min(portion_threshold + 1, key_num), nullptr);
+    return;
+  }
+  output_file_descend->Close();
+  YCSB_C_LOG_INFO("%s_key_stats_descend.csv is generated successfully", this->workload_name_.c_str());
+  output_file_hotkeys->Close();
+  YCSB_C_LOG_INFO("%s_key_stats_hotkeys.csv is generated successfully", this->workload_name_.c_str());
+  YCSB_C_LOG_INFO("%s_key_stats_dict_ordered.csv is skipped with lean counting", this->workload_name_.c_str());
+}
+
+int KeyStatsDB::TenantOfKey(const std::string &key) const
+{
+  for (size_t t = 0; t < this->tenant_key_formats_.size(); t++)
+  {
+    const std::string& prefix = this->tenant_key_formats_[t].prefix;
+    if (key.compare(0, prefix.size(), prefix) == 0)
+      return static_cast<int>(t);
+  }
+  return -1;
+}
+
+void KeyStatsDB::OutputTenantStats(
+    const std::vector<KeyStatRef>& key_stats_freq_descend,
+    size_t portion_threshold,
+    const std::vector<std::vector<std::string>>& separator_hot_keys)
+{
+  // 多租户：按 Key 前缀归属租户，统计各租户的 Key 数、访问量、真实热 Key 数，
+  // 以及每个热识别模块识别出的该租户热 Key 数与其中的真实热 Key 数，
+  // 用于观察重负载租户是否挤占其他租户的热 Key
+  size_t tenant_num = this->tenant_key_formats_.size();
+  std::vector<size_t> keys(tenant_num, 0), hot(tenant_num, 0);
+  std::vector<int64_t> accesses(tenant_num, 0);
+  std::unordered_set<std::string> true_hot_keys;
+  for (size_t i = 0; i < key_stats_freq_descend.size(); i++)
+  {
+    int t = this->TenantOfKey(key_stats_freq_descend[i]->first);
+    if (t < 0)
+      continue;
+    keys[t]++;
+    accesses[t] += key_stats_freq_descend[i]->second;
+    if (i <= portion_threshold)
+    {
+      hot[t]++;
+      true_hot_keys.insert(key_stats_freq_descend[i]->first);
+    }
+  }
+
+  std::string file_name = "./" + this->workload_name_ + "_tenant_stats.csv";
+  std::fstream tenant_file(file_name, std::ios::out);
+  if (!tenant_file.is_open())
+  {
+    YCSB_C_LOG_ERROR("%s open failed", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  tenant_file << "tenant,prefix,keys,accesses,hot_keys,separator,identified,true_positive" << std::endl;
+  for (size_t t = 0; t < tenant_num; t++)
+  {
+    YCSB_C_LOG_INFO("Tenant %zu (%s): keys %zu, accesses %ld, hot keys %zu", t,
+                    this->tenant_key_formats_[t].prefix.c_str(), keys[t], accesses[t], hot[t]);
+    tenant_file << t << "," << this->tenant_key_formats_[t].prefix << "," << keys[t] << ","
+                << accesses[t] << "," << hot[t] << ",key_stats," << hot[t] << "," << hot[t] << std::endl;
+  }
+  for (size_t i = 0; i < separator_hot_keys.size(); i++)
+  {
+    std::vector<size_t> identified(tenant_num, 0), true_positive(tenant_num, 0);
+    for (const auto& key : separator_hot_keys[i])
+    {
+      int t = this->TenantOfKey(key);
+      if (t < 0)
+        continue;
+      identified[t]++;
+      if (true_hot_keys.count(key))
+        true_positive[t]++;
+    }
+    for (size_t t = 0; t < tenant_num; t++)
+    {
+      tenant_file << t << "," << this->tenant_key_formats_[t].prefix << "," << keys[t] << ","
+                  << accesses[t] << "," << hot[t] << "," << this->heat_separators[i]->GetName() << ","
+                  << identified[t] << "," << true_positive[t] << std::endl;
+    }
+  }
+  tenant_file.close();
+  YCSB_C_LOG_INFO("%s is generated successfully", file_name.c_str());
+}
+
 } // ycsbc
 
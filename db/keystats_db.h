@@ -9,11 +9,14 @@
 #include "core/properties.h"
 
 #include <atomic>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <vector>
 
 #include "core/utils.h"
+#include "core/burst_injector.h"
 #include "modules/separator.h"
 #include "modules/heat_separator_lru_k.h"
 #include "modules/heat_separator_sketch_window.h"
@@ -24,11 +27,15 @@
 #include "modules/heat_separator_lirs.h"
 #include "modules/heat_separator_s3_fifo.h"
 #include "modules/heat_separator_arc.h"
+#include "modules/stack_distance.h"
+#include "modules/expiry_wheel.h"
 
 namespace ycsbc {
 
 class KeyStatsDB : public DB {
 public:
+  ~KeyStatsDB();
+
   void Init();
 
   void SetHotspotEnabled(bool new_val);
@@ -47,17 +54,99 @@ public:
   int Insert(const std::string &table, const std::string &key,
              std::vector<KVPair> &values);
 
+  // 删除与 TTL 过期一致：保留该 Key 的计数（删除本身计为一次访问），并将其从各热识别模块与栈距离中移除。
+  // 带 TTL 的写入按 SetOpContext 传入的 Trace 时间戳在过期时间轮中登记过期时刻（写入以新 TTL 覆盖，
+  // TTL 为 0 不过期，读不改变），时钟随请求时间戳推进，到期的 Key 经 HeatSeparator::OnExpire 移出热识别模块。
+  // 整数 Key 与字符串 Key 同样经过重排窗口与过期处理，结束时输出删除与过期移除的 Key 数
   int Delete(const std::string &table, const std::string &key);
 
+  // value 视图版本：统计不关心 value，直接忽略，不做任何拷贝
+  int Update(const std::string &table, const std::string &key,
+             const std::vector<KVPairView> &values);
+
+  int Insert(const std::string &table, const std::string &key,
+             const std::vector<KVPairView> &values);
+
+  // 整数 Key 模式（keytype=integer），直接以 Key id 统计，不构造字符串
+  int Read(const std::string &table, uint64_t key_id,
+           const std::vector<std::string> *fields,
+           std::vector<KVPair> &result);
+
+  int Scan(const std::string &table, uint64_t key_id,
+           int len, const std::vector<std::string> *fields,
+           std::vector<std::vector<KVPair>> &result);
+
+  int Update(const std::string &table, uint64_t key_id,
+             const std::vector<KVPairView> &values);
+
+  int Insert(const std::string &table, uint64_t key_id,
+             const std::vector<KVPairView> &values);
+
+  int Delete(const std::string &table, uint64_t key_id);
+
   int Special(const std::string &command);
 
+  // 记录当前线程后续操作所属请求的 Trace 序号
+  void SetOpContext(const OpContext &ctx);
+
   void SetWorkloadFileName(const std::string &file_name);
+  // 热 Key 突发：记录各热识别模块首次识别出突发 Key 的延迟
+  void SetBursts(const BurstInjector *bursts);
+  // 紧凑计数模式（keystatscounting=lean，仅 keytype=integer）：Key id 小于 key_count 的 Key 以 4 字节计数器
+  // 直接按 id 索引计数（匿名 mmap 按需分配，4 亿 Key 约 1.6 GB），适用于十亿级 Key；其余 Key 仍使用哈希表。
+  // 不需要热识别与突发统计时无锁计数，输出时按 id 流式写出、只对 id 排序，不输出字典序文件
+  void SetLeanCounting(uint64_t key_count);
+  // 保序（keystatsreorderwindow）：带 Trace 序号的访问在 window 个序号的窗口内按序号重排后再统计、交给热识别模块，
+  // RMW 的两次访问作为一条请求；窗口不小于 线程数 × tracebatch 时与 Trace 顺序完全一致，
+  // 迟于窗口到达的访问直接应用并计数输出；0 表示按到达顺序
+  void SetReorderWindow(size_t window);
+  // 空间采样（samplerate < 1）：只重放哈希采中的 Key，热识别模块的容量按采样率等比缩小，
+  // 统计结果中的 Key 数、访问数可除以采样率估计全量
+  void SetSampleRate(double rate);
+  // 容量曲线（keystatscurve=true，需开启热识别）：一遍统计 LRU 命中率随容量的变化（树状数组精确统计 Run 阶段的
+  // 栈距离），输出 <workload>_mrc.csv；带容量参数的热识别模块（sketch_window 为 window_size）按
+  // separator_config.json 的 capacity_curve 中每个容量各建一个实例接收同样的访问，输出 <workload>_capacity_curve.csv
+  // （各容量下识别出的热 Key 数及准确率、召回率）。容量按全量 Trace 计，采样时实例容量乘以采样率、栈距离除以采样率。
+  // parse_keystats.py 据此绘制 <workload>_capacity_curves.png
+  void SetCapacityCurve(bool enabled);
+  // 二进制列式输出（keystatsformat=binary，默认 csv）：以 <workload>_key_stats.bin 代替 key_stats 的四个 CSV，
+  // 以 <workload>_hotkeys_<模块>.bin 代替各热识别模块的热 Key CSV，numpy 可按偏移直接 memmap，无需解析文本。
+  // 所有整数均为小端 64 位。_key_stats.bin：64 字节头部
+  //   magic "YCSBKST1" | rows | hot_rows | key_kind | key_bytes | accesses | 保留 × 2
+  // 之后依次为 key[rows]、count[rows]（有符号）、rank[rows] 三列，key_kind 为 0 时最后是 key_bytes 字节的 Key 串。
+  // 每行一个 Key：key_kind 为 0（字符串 Key）时按字典序（先长度后内容）排列，key 列为该 Key 在 Key 串中的起始偏移，
+  // 下一行的偏移（末行为 key_bytes）即其结束位置；key_kind 为 1（紧凑计数）时按 Key id 升序，key 列为 Key id。
+  // rank 为按访问次数降序（计数相同时按行序）的名次，rank < hot_rows 即真实热 Key。
+  // _hotkeys_<模块>.bin：16 字节头部 magic "YCSBHOT1" | rows，之后为 row[rows]（有符号），
+  // 即识别出的热 Key 在 _key_stats.bin 中的行号，不在统计中的 Key 为 -1。
+  // parse_keystats.py 检测到 _key_stats.bin 时按行号直接计算召回率、准确率
+  void SetBinaryOutput(bool enabled);
+  // 输出统计：只对指向统计表项的指针排序、不复制 Key；热 Key 文件按 hot_key_portion 用 nth_element 选出前 N 个
+  // 后只排这一段，全量降序、字典序文件用 TBB parallel_sort；各 CSV 经 4 MB 缓冲区整块写出，并分别在单独线程上
+  // 写出、与排序重叠。计数相同的 Key 按字典序（紧凑计数模式按 Key id）排列，输出与线程数无关
   void OutputStats();
 
 private:
+  // Key 的访问类型
+  enum KeyAccess : uint8_t
+  {
+    kGet,
+    kPut,
+    kDelete
+  };
+
   std::mutex key_stats_mtx_;
   // 引入 哈希表 存储 Key 对应的统计计数
   std::unordered_map<std::string, int64_t> key_stats_;
+  // 输出时排序的是指向 key_stats_ 表项的指针，不复制 Key
+  typedef const std::pair<const std::string, int64_t>* KeyStatRef;
+  // 整数 Key 模式下 Key id 对应的统计计数
+  std::unordered_map<uint64_t, int64_t> key_id_stats_;
+  // 紧凑计数数组（匿名 mmap，按需分配物理页），dense_key_count_ 为 0 时未启用
+  std::atomic<uint32_t>* dense_counts_ = nullptr;
+  uint64_t dense_key_count_ = 0;
+  // 是否以 Key id 接口访问过（热识别模块中存的是编码后的 id）
+  std::atomic<bool> key_ids_used_{false};
   // 已经初始化的标志位
   std::atomic<bool> has_init_{false};
   // 开始统计的标志位
@@ -66,9 +155,117 @@ private:
   std::atomic<bool> enable_hotspot_identification_{false};
 
   std::string workload_name_ = "";
+  double sample_rate_ = 1.0;
 
   // 热识别算法模块
   std::vector<module::HeatSeparator*> heat_separators;
+
+  // 容量曲线：LRU 栈距离与按各容量创建的热识别模块实例
+  bool capacity_curve_ = false;
+  std::unique_ptr<module::StackDistanceCounter> stack_distance_;
+  // 字符串 Key 在栈距离中的 id：其 key_stats_ 表项的地址。rehash 不移动表项，表项删除前地址不变，不同 Key 不会碰撞
+  static uint64_t StackKey(const int64_t &count) { return reinterpret_cast<uintptr_t>(&count); }
+  struct CurveSeparator
+  {
+    size_t capacity;
+    module::HeatSeparator* separator;
+  };
+  std::vector<CurveSeparator> curve_separators_;
+
+  // 二进制列式输出
+  bool binary_output_ = false;
+  // 二进制输出时 _key_stats.bin 各行的 Key：字符串 Key 模式为字典序的表项，紧凑计数模式为升序的 Key id
+  struct KeyStatRows
+  {
+    std::vector<KeyStatRef> keys;
+    std::vector<uint64_t> key_ids;
+  };
+
+  // TTL 过期：带 TTL 的写入按请求的 Trace 时间戳登记过期时刻，时钟随请求推进，
+  // 到期的 Key 经 OnExpire 从各热识别模块中移除
+  std::unique_ptr<module::ExpiryWheel> expiry_wheel_;
+  std::vector<std::string> expired_keys_;
+  uint64_t delete_count_ = 0;
+
+  // 已记录的访问总数，作为识别延迟的操作数时钟
+  uint64_t access_count_ = 0;
+  // 热 Key 突发及其识别情况
+  const BurstInjector *bursts_ = nullptr;
+  struct BurstTrack
+  {
+    // 注入后突发 Key 的访问次数
+    uint64_t hits = 0;
+    // 注入后突发 Key 首次到达时的访问总数
+    uint64_t first_access = 0;
+    // 每个热识别模块首次识别时的访问总数与时间，未识别为 0
+    std::vector<uint64_t> detected_access;
+    std::vector<int64_t> detected_ns;
+  };
+  std::vector<BurstTrack> burst_tracks_;
+
+  // 重排窗口：槽位 i 存放序号 ≡ i (mod window) 的请求的全部访问
+  struct PendingAccess
+  {
+    uint64_t sequence = kNoSequence;
+    // 请求的访问数（读改写为 2），全部到达后才可统计
+    uint32_t accesses = 1;
+    uint64_t timestamp = 0;
+    uint32_t ttl = 0;
+    std::vector<std::pair<std::string, KeyAccess>> keys;
+    std::vector<std::pair<uint64_t, KeyAccess>> key_ids;
+  };
+  std::vector<PendingAccess> reorder_slots_;
+  // 下一个待统计的序号
+  uint64_t reorder_next_ = 0;
+  // 经窗口暂存的访问数、越过窗口后才到达（未能按序统计）的访问数
+  uint64_t reorder_held_ = 0;
+  uint64_t reorder_late_ = 0;
+
+  void RecordKey(const std::string &key, KeyAccess access);
+  // timestamp、ttl 为访问所属请求的 Trace 时间戳与 TTL
+  void ApplyKey(const std::string &key, KeyAccess access, uint64_t timestamp, uint32_t ttl);
+  template <typename Key>
+  void ReorderKey(const OpContext &ctx, const Key &key, KeyAccess access);
+  static void HoldKey(PendingAccess &slot, const std::string &key, KeyAccess access) { slot.keys.emplace_back(key, access); }
+  static void HoldKey(PendingAccess &slot, uint64_t key_id, KeyAccess access) { slot.key_ids.emplace_back(key_id, access); }
+  // @brief 删除：计为一次访问，保留计数，从栈距离与热识别模块中移除
+  void RemoveKey(const std::string &key);
+  // @brief 时钟推进到 timestamp，移除已过期的 Key；带 TTL 的写入登记过期时刻。整数 Key 以 EncodeKeyId 编码后登记
+  void ExpireKeys(const std::string &key, KeyAccess access, uint64_t timestamp, uint32_t ttl);
+  void ApplyReorderSlot(PendingAccess &slot);
+  void FlushReorder();
+  // 整数 Key 的访问，与字符串 Key 相同地经过重排窗口与过期处理
+  void RecordKeyId(uint64_t key_id, KeyAccess access);
+  void ApplyKey(uint64_t key_id, KeyAccess access, uint64_t timestamp, uint32_t ttl);
+  void RemoveKeyId(uint64_t key_id);
+  template <typename Key>
+  void TrackBurst(size_t i, const Key &key);
+  void OutputBurstStats();
+  // 字典序（先长度后内容）；降序时计数相同按字典序，使输出与排序算法、线程数无关
+  static bool KeyDictLess(KeyStatRef a, KeyStatRef b);
+  static bool KeyCountGreater(KeyStatRef a, KeyStatRef b);
+  // 按 CSV 输出 key_stats 的四个文件，key_stats_freq_descend 的前 hot_num 个已排好
+  void OutputKeyStatsCsv(std::vector<KeyStatRef>& key_stats_freq_descend, size_t hot_num);
+  // 按二进制列式输出 _key_stats.bin，key_stats_freq_descend 已全部排好
+  void OutputKeyStatsBinary(const std::vector<KeyStatRef>& key_stats_freq_descend, size_t hot_num,
+                            KeyStatRows& rows);
+  // 写出 _key_stats.bin，key_names 为空时 key 列为 Key id
+  void WriteKeyStatsBinary(const std::vector<uint64_t>& keys, const std::vector<int64_t>& counts,
+                           const std::vector<uint64_t>& ranks, uint64_t hot_rows,
+                           const std::vector<KeyStatRef>* key_names);
+  // true_hot_keys 不为空时收集真实热 Key
+  void OutputDenseKeyStats(std::unordered_set<std::string>* true_hot_keys, KeyStatRows& rows);
+  void OutputCapacityCurve(const std::unordered_set<std::string>& true_hot_keys);
+  void OutputSampling(size_t key_num, uint64_t access_num);
+  // 二进制输出时热 Key 按 rows 换算为 _key_stats.bin 中的行号
+  void OutputSeparatorHotKeys(std::vector<std::vector<std::string>>& separator_hot_keys,
+                              const KeyStatRows& rows);
+
+  // 多租户：Key 所属租户（按 Key 前缀），不属于任何租户时返回 -1
+  int TenantOfKey(const std::string &key) const;
+  void OutputTenantStats(const std::vector<KeyStatRef>& key_stats_freq_descend,
+                         size_t portion_threshold,
+                         const std::vector<std::vector<std::string>>& separator_hot_keys);
 };
 
 } // ycsbc
@@ -11,6 +11,7 @@
 
 #include "db/hashtable_db.h"
 
+#include <cstring>
 #include <string>
 #include <vector>
 #include "lib/tbb_rand_hashtable.h"
@@ -43,9 +44,10 @@ class TbbRandDB : public HashtableDB {
     delete table;
   }
 
-  const char *CopyString(const std::string &str) {
+  const char *CopyString(std::string_view str) {
     char *value = new char[str.length() + 1];
-    strcpy(value, str.c_str());
+    memcpy(value, str.data(), str.length());
+    value[str.length()] = '\0';
     return value;
   }
 
@@ -0,0 +1,78 @@
+#include "expiry_wheel.h"
+
+#include <algorithm>
+
+namespace module
+{
+
+ExpiryWheel::ExpiryWheel()
+  : slots_(kSlots)
+{}
+
+void ExpiryWheel::Schedule(const std::string& key, const uint64_t expire_at)
+{
+  this->deadlines_[key] = expire_at;
+  // 已经过去的时刻（线程间请求乱序到达）放到下一秒处理
+  uint64_t slot_time = (this->started_ && expire_at <= this->now_) ? this->now_ + 1 : expire_at;
+  this->slots_[slot_time % kSlots].push_back({key, expire_at});
+}
+
+void ExpiryWheel::Cancel(const std::string& key)
+{
+  // 槽中的旧条目到期时发现已无登记，直接丢弃
+  this->deadlines_.erase(key);
+}
+
+void ExpiryWheel::Drain(const uint64_t t, std::vector<std::string>& expired)
+{
+  std::vector<Entry>& slot = this->slots_[t % kSlots];
+  size_t kept = 0;
+  for (size_t i = 0; i < slot.size(); i++)
+  {
+    auto iter = this->deadlines_.find(slot[i].key);
+    // 已取消或过期时刻已被重设
+    if (iter == this->deadlines_.end() || iter->second != slot[i].expire_at)
+      continue;
+    if (slot[i].expire_at <= this->now_)
+    {
+      expired.push_back(std::move(slot[i].key));
+      this->deadlines_.erase(iter);
+      this->expired_count_++;
+      continue;
+    }
+    // 下一圈才到期
+    if (kept != i)
+      slot[kept] = std::move(slot[i]);
+    kept++;
+  }
+  slot.resize(kept);
+}
+
+void ExpiryWheel::Advance(const uint64_t now, std::vector<std::string>& expired)
+{
+  if (!this->started_)
+  {
+    this->started_ = true;
+    this->now_ = now;
+    return;
+  }
+  if (now <= this->now_)
+    return;
+  // 跨度超过一圈时每个槽只需处理一次
+  uint64_t steps = std::min<uint64_t>(now - this->now_, kSlots);
+  uint64_t from = now - steps + 1;
+  this->now_ = now;
+  for (uint64_t t = from; t <= now; t++)
+    this->Drain(t, expired);
+}
+
+void ExpiryWheel::Clear()
+{
+  for (auto& slot : this->slots_)
+    slot.clear();
+  this->deadlines_.clear();
+  this->started_ = false;
+  this->now_ = 0;
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef _EXPIRY_WHEEL_H_
+#define _EXPIRY_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace module
+{
+
+/**
+ * 过期时间轮：按 Trace 时间（秒）记录 Key 的过期时刻，时钟推进时取出到期的 Key。
+ * 每秒一个槽，过期时刻落在 (时刻 mod 槽数) 号槽；超出一圈的 Key 留在槽中等下一圈。
+ * 重设或取消过期时刻时不去槽中查找旧条目，只更新 deadlines_，旧条目在所在槽到期时丢弃，
+ * 因此登记、取消均为 O(1)，推进的开销与经过的槽数及其中的条目数成正比，均摊 O(1)
+ */
+class ExpiryWheel
+{
+private:
+  // 槽数（秒），约 18 小时一圈
+  static constexpr size_t kSlots = 1 << 16;
+
+  struct Entry
+  {
+    std::string key;
+    uint64_t expire_at;
+  };
+
+  std::vector<std::vector<Entry>> slots_;
+  // Key --> 当前有效的过期时刻
+  std::unordered_map<std::string, uint64_t> deadlines_;
+  // 已处理到的时刻，首次推进时以其为起点
+  uint64_t now_ = 0;
+  bool started_ = false;
+  uint64_t expired_count_ = 0;
+
+  // @brief 处理时刻 t 所在槽：到期且仍有效的 Key 追加到 expired，其余未到期的留下
+  void Drain(const uint64_t t, std::vector<std::string>& expired);
+
+public:
+  ExpiryWheel();
+
+  // @brief 登记 Key 在 expire_at 过期，覆盖之前的过期时刻
+  void Schedule(const std::string& key, const uint64_t expire_at);
+  // @brief Key 被删除或改为不过期
+  void Cancel(const std::string& key);
+  // @brief 时钟推进到 now（不回退），已到期的 Key 追加到 expired
+  void Advance(const uint64_t now, std::vector<std::string>& expired);
+  // @brief 清空全部登记，下次推进重新确定起点（Trace 从头重放时）
+  void Clear();
+
+  size_t GetScheduledCount() const { return this->deadlines_.size(); }
+  uint64_t GetExpiredCount() const { return this->expired_count_; }
+};
+
+}
+
+#endif
@@ -5,46 +5,53 @@ namespace module
 {
 
 HeatSeparatorLfu::HeatSeparatorLfu(const size_t capacity, const size_t min_freq)
-  : capacity(capacity), min_freq(min_freq)
+  : capacity(capacity)
 {
   std::cout << "Lfu Heat Separator is initialized, min_freq = " << min_freq << ", capacity = " << capacity << std::endl;
 
   this->algorithm_name = "lfu";
 }
 
+void HeatSeparatorLfu::Touch(KeyPos& item)
+{
+  auto bucket = item.bucket;
+  auto next = std::next(bucket);
+  if (next == this->freq_buckets.end() || next->freq != bucket->freq + 1)
+    next = this->freq_buckets.insert(next, FreqBucket{bucket->freq + 1, {}});
+  // 节点移入下一个桶的头部，桶内迭代器仍有效
+  next->keys.splice(next->keys.begin(), bucket->keys, item.pos);
+  item.bucket = next;
+  if (bucket->keys.empty())
+    this->freq_buckets.erase(bucket);
+}
+
 Status HeatSeparatorLfu::Put(const std::string& key)
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
 
   // 存在，更新频率
-  if (this->key_freq_iter_map.find(key) != this->key_freq_iter_map.end())
+  auto iter = this->key_pos_map.find(key);
+  if (iter != this->key_pos_map.end())
   {
-    auto& item = this->key_freq_iter_map[key];
-    this->freq_key_map[item.first].erase(item.second);
-    if (this->freq_key_map[item.first].empty() 
-        && 
-        item.first == this->min_freq)
-      this->min_freq++;
-    item.first++;
-    this->freq_key_map[item.first].push_front(key);
-    item.second = this->freq_key_map[item.first].begin();
-    this->key_freq_iter_map[key] = item;
-
+    this->Touch(iter->second);
     return SUCCESS;
   }
 
-  // 缓存满时淘汰 min_freq 链表的尾部
-  if (this->key_freq_iter_map.size() >= capacity) 
+  // 缓存满时淘汰最低频链表的尾部
+  if (this->key_pos_map.size() >= capacity && !this->freq_buckets.empty())
   {
-    auto old_key = this->freq_key_map[this->min_freq].back();
-    this->key_freq_iter_map.erase(old_key);
-    this->freq_key_map[this->min_freq].pop_back();
+    auto min_bucket = this->freq_buckets.begin();
+    this->key_pos_map.erase(min_bucket->keys.back());
+    min_bucket->keys.pop_back();
+    if (min_bucket->keys.empty())
+      this->freq_buckets.erase(min_bucket);
   }
-  // 插入新数据
-  this->min_freq = 1;
-  this->freq_key_map[this->min_freq].push_front(key);
-  this->key_freq_iter_map[key] = std::pair<size_t, std::list<std::string>::iterator>(
-                                  min_freq, this->freq_key_map[min_freq].begin());
+  // 插入新数据，频率为 1
+  if (this->freq_buckets.empty() || this->freq_buckets.front().freq != 1)
+    this->freq_buckets.push_front(FreqBucket{1, {}});
+  auto bucket = this->freq_buckets.begin();
+  bucket->keys.push_front(key);
+  this->key_pos_map.emplace(key, KeyPos{bucket, bucket->keys.begin()});
 
   return SUCCESS;
 }
@@ -53,36 +60,31 @@ Status HeatSeparatorLfu::Get(const std::string& key)
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
 
-  if (this->key_freq_iter_map.find(key) == this->key_freq_iter_map.end())
+  auto iter = this->key_pos_map.find(key);
+  if (iter == this->key_pos_map.end())
     return ERROR;
-  
-  auto& item = this->key_freq_iter_map[key];
-  this->freq_key_map[item.first].erase(item.second);
-  if (this->freq_key_map[item.first].empty() 
-      && 
-      item.first == this->min_freq)
-    this->min_freq++;
-  item.first++;
-  this->freq_key_map[item.first].push_front(key);
-  item.second = this->freq_key_map[item.first].begin();
-  this->key_freq_iter_map[key] = item;
+  this->Touch(iter->second);
 
   return SUCCESS;
 }
 
 bool HeatSeparatorLfu::IsHotKey(const std::string& key)
 {
-  return true;
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+
+  // 与 GetHotKeys 一致：缓存中且频率不超过 capacity 的 Key
+  auto iter = this->key_pos_map.find(key);
+  return (iter != this->key_pos_map.end() && iter->second.bucket->freq <= this->capacity);
 }
 
 Status HeatSeparatorLfu::GetHotKeys(std::vector<std::string>& hot_keys)
 {
   // 从最高频向低频遍历
-  for (auto freq = capacity; freq >= 1; freq--) 
+  for (auto bucket = this->freq_buckets.rbegin(); bucket != this->freq_buckets.rend(); ++bucket) 
   {
-    if (this->freq_key_map.find(freq) == this->freq_key_map.end()) 
+    if (bucket->freq > capacity) 
       continue;
-    for (auto& k : this->freq_key_map[freq]) 
+    for (auto& k : bucket->keys) 
     {
       hot_keys.push_back(k);
     }
@@ -91,6 +93,21 @@ Status HeatSeparatorLfu::GetHotKeys(std::vector<std::string>& hot_keys)
   return SUCCESS;
 }
 
+Status HeatSeparatorLfu::Remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+
+  auto map_iter = this->key_pos_map.find(key);
+  if (map_iter == this->key_pos_map.end())
+    return NOT_FOUND;
+  auto bucket = map_iter->second.bucket;
+  bucket->keys.erase(map_iter->second.pos);
+  if (bucket->keys.empty())
+    this->freq_buckets.erase(bucket);
+  this->key_pos_map.erase(map_iter);
+  return SUCCESS;
+}
+
 void HeatSeparatorLfu::Display()
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
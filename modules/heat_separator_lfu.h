@@ -15,11 +15,25 @@ class HeatSeparatorLfu : public HeatSeparator
 {
 private:
   size_t capacity;
-  size_t min_freq;
-  // 频率到 key 映射，可能会有同频
-  std::unordered_map<size_t, std::list<std::string>> freq_key_map;
-  // key 到频率和迭代器映射
-  std::unordered_map<std::string, std::pair<size_t, std::list<std::string>::iterator>> key_freq_iter_map;
+  // 同频的 key 链表，可能会有同频
+  struct FreqBucket
+  {
+    size_t freq;
+    std::list<std::string> keys;
+  };
+  // 频率桶按频率升序排列，首个桶即最低频：访问时 key 移入相邻的下一个桶，淘汰取首个桶的尾部，
+  // 删除、过期清空了最低频的桶时首个桶即下一个频率，均为 O(1)
+  std::list<FreqBucket> freq_buckets;
+  // key 到所在频率桶和桶内迭代器映射
+  struct KeyPos
+  {
+    std::list<FreqBucket>::iterator bucket;
+    std::list<std::string>::iterator pos;
+  };
+  std::unordered_map<std::string, KeyPos> key_pos_map;
+
+  // @brief key 的频率加 1，移入下一个频率桶
+  void Touch(KeyPos& item);
 
 public:
   HeatSeparatorLfu(const size_t capacity, const size_t min_freq);
@@ -29,6 +43,7 @@ public:
 
   bool IsHotKey(const std::string& key);
   Status GetHotKeys(std::vector<std::string>& hot_keys);
+  Status Remove(const std::string& key);
 
   void Display();
 };
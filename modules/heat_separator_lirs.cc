@@ -113,6 +113,13 @@ Status HeatSeparatorLIRS::Get(const std::string& key)
 }
 
 // 获取所有热Keys (LIR块)
+bool HeatSeparatorLIRS::IsHotKey(const std::string& key)
+{
+    // 与 GetHotKeys 一致：LIR 块即热数据
+    auto iter = this->key_node_map_.find(key);
+    return (iter != this->key_node_map_.end() && iter->second->type == LIR);
+}
+
 Status HeatSeparatorLIRS::GetHotKeys(std::vector<std::string>& hot_keys)
 {
     for (auto node : stack_s_)
@@ -124,8 +131,33 @@ Status HeatSeparatorLIRS::GetHotKeys(std::vector<std::string>& hot_keys)
 }
 
 
+Status HeatSeparatorLIRS::Remove(const std::string& key)
+{
+  auto iter = this->key_node_map_.find(key);
+  if (iter == this->key_node_map_.end())
+    return NOT_FOUND;
+
+  LIRSNode* node = iter->second;
+  // 驻留块（LIR、HIR）释放容量，驻留 HIR 块同时在队列 Q 中
+  if (node->type != NHIR)
+    this->used_size_--;
+  if (node->type == HIR)
+    this->RemoveFromQueue(node);
+  if (node->stack_pos != this->stack_s_.end())
+    this->stack_s_.erase(node->stack_pos);
+  this->key_node_map_.erase(iter);
+  delete node;
+  // 移除的是栈底 LIR 块时，栈底需重新剪枝
+  this->PruneStack();
+  return SUCCESS;
+}
+
 void HeatSeparatorLIRS::FreeOne() 
 {
+  // LIR 块占满容量、驻留 HIR 队列为空时先将栈底 LIR 降级，否则调用方的淘汰循环无法结束（小容量时出现）。
+  // 此处不剪枝：调用方 Get 正在重新激活的 NHIR 块可能在栈底，剪枝会将其释放
+  if (this->queue_q_.empty())
+    this->DemoteBottomLIR();
   if (this->queue_q_.empty()) return;
     
   LIRSNode* node = queue_q_.back();
@@ -173,12 +205,17 @@ void HeatSeparatorLIRS::DemoteBottomLIR()
 {
   if (stack_s_.empty()) return;
   
-  LIRSNode* bottom = stack_s_.back();
-  if (bottom->type == LIR) 
+  // 栈底可能还有未剪枝的非 LIR 块，降级最靠近栈底的 LIR
+  for (auto iter = stack_s_.rbegin(); iter != stack_s_.rend(); ++iter)
   {
-    bottom->type = HIR;
-    queue_q_.push_front(bottom);
-    bottom->queue_pos = queue_q_.begin();
+    LIRSNode* bottom = *iter;
+    if (bottom->type == LIR) 
+    {
+      bottom->type = HIR;
+      queue_q_.push_front(bottom);
+      bottom->queue_pos = queue_q_.begin();
+      return;
+    }
   }
 }
 
@@ -55,8 +55,9 @@ public:
   Status Put(const std::string& key);
   Status Get(const std::string& key);
 
-  bool IsHotKey(const std::string& key) { return false; }
+  bool IsHotKey(const std::string& key);
   Status GetHotKeys(std::vector<std::string>& hot_keys);
+  Status Remove(const std::string& key);
 
   void Display() {}
 
@@ -61,6 +61,18 @@ Status HeatSeparatorLru::GetHotKeys(std::vector<std::string>& hot_keys)
   return ((hot_keys.size() == this->cache_queue.size()) ? SUCCESS : ERROR);
 }
 
+Status HeatSeparatorLru::Remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+
+  auto map_iter = this->key_cache_map.find(key);
+  if (map_iter == this->key_cache_map.end())
+    return NOT_FOUND;
+  this->cache_queue.erase(map_iter->second);
+  this->key_cache_map.erase(map_iter);
+  return SUCCESS;
+}
+
 void HeatSeparatorLru::Display()
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
@@ -117,6 +117,22 @@ Status HeatSeparatorLruK::GetHotKeys(std::vector<std::string>& hot_keys)
   return SUCCESS;
 }
 
+Status HeatSeparatorLruK::Remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+
+  auto map_iter = this->key_cache_map.find(key);
+  if (map_iter == this->key_cache_map.end())
+    return NOT_FOUND;
+  // 访问次数未到 k 时在历史队列中，否则在缓存队列中
+  if (map_iter->second.access_count < this->k)
+    this->history_queue.erase(map_iter->second.history_iter);
+  else
+    this->cache_queue.erase(map_iter->second.cache_iter);
+  this->key_cache_map.erase(map_iter);
+  return SUCCESS;
+}
+
 void HeatSeparatorLruK::Display()
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
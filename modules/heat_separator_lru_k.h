@@ -47,6 +47,7 @@ public:
 
   bool IsHotKey(const std::string& key);
   Status GetHotKeys(std::vector<std::string>& hot_keys);
+  Status Remove(const std::string& key);
 
   void Display();
 };
@@ -45,6 +45,7 @@ Status HeatSeparatorS3FIFO::Put(const std::string& key)
     ghost_map_.erase(hash_val);
     std::cout << "erase map" << std::endl;
     this->main_queue_.data.emplace_back(key);
+    this->main_queue_.data.back().is_in_main_queue = true;
     this->key_map_[key] = std::prev(this->main_queue_.data.end());
     
     if (this->main_queue_.data.size() > this->main_queue_.max_size)
@@ -76,6 +77,17 @@ Status HeatSeparatorS3FIFO::Get(const std::string& key)
   return SUCCESS;
 }
 
+bool HeatSeparatorS3FIFO::IsHotKey(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+
+  // 与 GetHotKeys 一致：主队列中且被再次访问过的 Key
+  auto iter = this->key_map_.find(key);
+  if (iter == this->key_map_.end())
+    return false;
+  return (iter->second->is_in_main_queue && iter->second->frequency >= 1);
+}
+
 Status HeatSeparatorS3FIFO::GetHotKeys(std::vector<std::string>& hot_keys)
 {
   for (auto& node : this->main_queue_.data) {
@@ -85,6 +97,21 @@ Status HeatSeparatorS3FIFO::GetHotKeys(std::vector<std::string>& hot_keys)
   return SUCCESS;
 }
 
+Status HeatSeparatorS3FIFO::Remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+
+  auto iter = this->key_map_.find(key);
+  if (iter == this->key_map_.end())
+    return NOT_FOUND;
+  if (iter->second->is_in_main_queue)
+    this->main_queue_.data.erase(iter->second);
+  else
+    this->small_queue_.data.erase(iter->second);
+  this->key_map_.erase(iter);
+  return SUCCESS;
+}
+
 size_t HeatSeparatorS3FIFO::GhostHash(const std::string& key)
 {
   return std::hash<std::string>{}(key);
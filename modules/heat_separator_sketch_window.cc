@@ -76,6 +76,23 @@ uint64_t CountMinSketch::GetKeyCount(const std::string& key)
   return min_count;
 }
 
+Status CountMinSketch::Remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+  std::vector<size_t> cols(this->depth);
+  uint64_t min_count = static_cast<uint64_t>(INT64_MAX);
+  for (size_t i = 0; i < this->depth; ++i)
+  {
+    cols[i] = this->hash_funcs[i](key) % this->width;
+    min_count = std::min(min_count, this->counter_table[i][cols[i]]);
+  }
+  if (min_count == 0)
+    return NOT_FOUND;
+  for (size_t i = 0; i < this->depth; ++i)
+    this->counter_table[i][cols[i]] -= min_count;
+  return SUCCESS;
+}
+
 void CountMinSketch::Display()
 {
   std::cout << "Count Min Sketch has no info to display" << std::endl;
@@ -127,6 +144,17 @@ Status LRUCache::Get(const std::string& key)
   return this->Put(key);
 }
 
+Status LRUCache::Remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+  auto map_iter = this->key_cache_map.find(key);
+  if (map_iter == this->key_cache_map.end())
+    return NOT_FOUND;
+  this->key_access_list.erase(map_iter->second);
+  this->key_cache_map.erase(map_iter);
+  return SUCCESS;
+}
+
 Status LRUCache::GetAllKeys(std::vector<std::string>& keys)
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
@@ -211,6 +239,13 @@ Status HeatSeparatorSketch::GetHotKeys(std::vector<std::string>& hot_keys)
   return SUCCESS;
 }
 
+Status HeatSeparatorSketch::Remove(const std::string& key)
+{
+  Status res1 = this->lru_window.Remove(key);
+  Status res2 = this->count_min_sketch.Remove(key);
+  return (res1 == SUCCESS || res2 == SUCCESS) ? SUCCESS : NOT_FOUND;
+}
+
 void HeatSeparatorSketch::Display()
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
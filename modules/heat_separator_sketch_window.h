@@ -37,6 +37,8 @@ public:
   bool IsHotKey(const std::string& key);
   uint64_t GetKeyCount(const std::string& key);
   Status GetHotKeys(std::vector<std::string>& hot_keys) { return SUCCESS; };
+  // @brief 各行扣除 Key 的估计计数（不小于真实计数），估计值归零；同列的其他 Key 可能被少计，计数不会为负
+  Status Remove(const std::string& key);
 
   void Display();
 };
@@ -63,6 +65,7 @@ public:
 
   Status GetAllKeys(std::vector<std::string>& keys);
   bool IsContain(const std::string& key);
+  Status Remove(const std::string& key);
 
   void SetWindowSize(const size_t size);
 
@@ -92,6 +95,8 @@ public:
 
   bool IsHotKey(const std::string& key);
   Status GetHotKeys(std::vector<std::string>& hot_keys);
+  // @brief 移出时间窗口并扣除 CMS 中的计数
+  Status Remove(const std::string& key);
 
   void Display();
 };
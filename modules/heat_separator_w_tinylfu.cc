@@ -30,7 +30,7 @@ Status HeatSepratorWTinyLFU::Get(const std::string& key)
 
 bool HeatSepratorWTinyLFU::IsHotKey(const std::string& key)
 {
-  return false;
+  return this->w_tinyflu.IsHotKey(key);
 }
 
 Status HeatSepratorWTinyLFU::GetHotKeys(std::vector<std::string>& hot_keys)
@@ -38,6 +38,11 @@ Status HeatSepratorWTinyLFU::GetHotKeys(std::vector<std::string>& hot_keys)
   return (this->w_tinyflu.GetHotKeys(hot_keys) ? SUCCESS : ERROR);
 }
 
+Status HeatSepratorWTinyLFU::Remove(const std::string& key)
+{
+  return (this->w_tinyflu.Del(key).second ? SUCCESS : NOT_FOUND);
+}
+
 void HeatSepratorWTinyLFU::Display()
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
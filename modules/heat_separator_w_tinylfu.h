@@ -229,12 +229,12 @@ struct LRUNode
 {
 public:
 	uint32_t _key;
-  T _raw_key;
+  std::string _raw_key;	//原始 key，值的类型 T 不一定是 key 的类型
 	T _value;
 	uint32_t _conflict;	//在key出现冲突时的辅助hash值
 	bool _flag;	//用于标记在缓存中的位置
 
-	explicit LRUNode(uint32_t key = -1, const T& raw_key = T(), const T& value = T(), uint32_t conflict = 0, bool flag = PROBATION)
+	explicit LRUNode(uint32_t key = -1, const std::string& raw_key = std::string(), const T& value = T(), uint32_t conflict = 0, bool flag = PROBATION)
 		: _key(key)
     , _raw_key(raw_key)
 		, _value(value)
@@ -281,6 +281,15 @@ public:
 		bool flag = false; //是否置换数据
 		LRUNode_t delNode;
 
+		//拓展：数据已存在则原地更新并移动到队首，链表中不留重复的副本
+		auto res = _hashmap.find(node._key);
+		if (res != _hashmap.end())
+		{
+			*res->second = node;
+			_lrulist.splice(_lrulist.begin(), _lrulist, res->second);
+			return std::make_pair(delNode, flag);
+		}
+
 		//数据已满，淘汰末尾元素
 		if (_lrulist.size() == _capacity)
 		{
@@ -292,10 +301,23 @@ public:
 		}
 		//插入数据
 		_lrulist.push_front(node);
-		_hashmap.insert(make_pair (node._key, _lrulist.begin()));
+		_hashmap[node._key] = _lrulist.begin();
 		return std::make_pair(delNode, flag);
 	}
 
+	// 拓展：按 key 哈希及原始 key 移除节点
+	bool erase(uint32_t key, const std::string& raw_key)
+	{
+		auto res = _hashmap.find(key);
+		if (res == _hashmap.end() || res->second->_raw_key != raw_key)
+		{
+			return false;
+		}
+		_lrulist.erase(res->second);
+		_hashmap.erase(res);
+		return true;
+	}
+
 	size_t capacity() const
 	{
 		return _capacity;
@@ -385,11 +407,19 @@ public:
 		newNode._flag = PROBATION;
 		LRUNode_t delNode;
 
+		//拓展：数据已存在则先移除原节点，再作为新节点放入，段中不留重复的副本
+		auto res = _hashmap.find(newNode._key);
+		if (res != _hashmap.end())
+		{
+			eraseNode(res->second);
+			_hashmap.erase(res);
+		}
+
 		//如果还有剩余空间就直接插入
 		if (_probationList.size() < _probationCapacity || size() < _probationCapacity + _protectionCapacity)
 		{
 			_probationList.push_front(newNode);
-			_hashmap.insert(make_pair(newNode._key, _probationList.begin()));
+			_hashmap[newNode._key] = _probationList.begin();
 
 			return std::make_pair(delNode, false);
 		}
@@ -401,7 +431,7 @@ public:
 		_probationList.pop_back();
 
 		_probationList.push_front(newNode);
-		_hashmap.insert(make_pair(newNode._key, _probationList.begin()));
+		_hashmap[newNode._key] = _probationList.begin();
 
 		return std::make_pair(delNode, true);
 	}
@@ -423,6 +453,26 @@ public:
 		return _protectionList.size() + _probationList.size();
 	}
 
+	// 拓展：按 key 哈希及原始 key 判断是否位于 SLRU 中
+	bool contains(uint32_t key, const std::string& raw_key) const
+	{
+		auto res = _hashmap.find(key);
+		return (res != _hashmap.end() && res->second->_raw_key == raw_key);
+	}
+
+	// 拓展：按 key 哈希及原始 key 移除节点，节点的 _flag 标记其所在的段
+	bool erase(uint32_t key, const std::string& raw_key)
+	{
+		auto res = _hashmap.find(key);
+		if (res == _hashmap.end() || res->second->_raw_key != raw_key)
+		{
+			return false;
+		}
+		eraseNode(res->second);
+		_hashmap.erase(res);
+		return true;
+	}
+
 	std::list<LRUNode_t> get_protection_list()
 	{
 		return this->_protectionList;
@@ -440,6 +490,18 @@ private:
 
 	std::list<LRUNode_t> _probationList;
 	std::list<LRUNode_t> _protectionList;
+
+	void eraseNode(typename std::list<LRUNode_t>::iterator pos)
+	{
+		if (pos->_flag == PROTECTION)
+		{
+			_protectionList.erase(pos);
+		}
+		else
+		{
+			_probationList.erase(pos);
+		}
+	}
 };
 
 enum CACHE_ZONE
@@ -481,7 +543,7 @@ public:
 		uint32_t conflictHash = Hash(key.c_str(), key.size(), CONFLICT_HASH_SEED);
 
 		std::unique_lock<std::shared_mutex> wLock(_rwMutex);	
-		return del(keyHash, conflictHash);
+		return del(keyHash, key, conflictHash);
 	}
 
 	bool Put(const std::string& key, const V& value)
@@ -526,6 +588,15 @@ public:
 		return h;
 	}
 
+  // 拓展外部实现，与 GetHotKeys 一致：位于 SLRU 中的 Key 为热 Key
+  bool IsHotKey(const std::string& key)
+  {
+    uint32_t keyHash = Hash(key.c_str(), key.size(), KEY_HASH_SEED);
+
+    std::shared_lock<std::shared_mutex> rLock(_rwMutex);
+    return _slru.contains(keyHash, key);
+  }
+
   // 拓展外部实现，获取所有热 Keys
   bool GetHotKeys(std::vector<std::string>& hot_keys)
   {
@@ -598,12 +669,16 @@ private:
 		return std::make_pair(node._value, true);
 	}
 
-	std::pair<V, bool> del(uint32_t keyHash, uint32_t conflictHash)
+	std::pair<V, bool> del(uint32_t keyHash, const std::string& key, uint32_t conflictHash)
 	{
+		// 拓展：先按原始 key 从两个区域中移除，区域中的节点不一定仍记录在 _dataMap 中
+		bool erased = _wlru.erase(keyHash, key);
+		erased = _slru.erase(keyHash, key) || erased;
+
 		auto res = _dataMap.find(keyHash);
 		if (res == _dataMap.end())
 		{
-			return std::make_pair(V(), false);
+			return std::make_pair(V(), erased);
 		}
 
 		LRUNode_t node = res->second;
@@ -611,14 +686,14 @@ private:
 		//再次验证conflictHash是否相同，防止由于keyHash冲突导致的误删除
 		if (node._conflict != conflictHash)
 		{
-			return std::make_pair(V(), false);
+			return std::make_pair(V(), erased);
 		}
 		
 		_dataMap.erase(keyHash);
 		return std::make_pair(node._value, true);
 	}
 
-	bool put(uint32_t keyHash, const V& key, const V& value, uint32_t conflictHash)
+	bool put(uint32_t keyHash, const std::string& key, const V& value, uint32_t conflictHash)
 	{
 
 		LRUNode_t newNode(keyHash, key, value, conflictHash, WINDOWS_LRU);
@@ -665,12 +740,12 @@ private:
 			return false;
 		}
 		_dataMap[keyHash] = newNode;
-		_slru.put(newNode);
+		std::pair<LRUNode_t, bool> slruRes = _slru.put(newNode);
 
-		//如果满了，此时发生了淘汰，将淘汰节点删去
-		if (_dataMap[res.first._key]._flag == SEGMENT_LRU)
+		//如果满了，此时发生了淘汰，将淘汰节点删去（拓展：已在 SLRU 中的 Key 重新放入时不淘汰）
+		if (slruRes.second && _dataMap[slruRes.first._key]._flag == SEGMENT_LRU)
 		{
-			_dataMap.erase(victimRes.first._key);
+			_dataMap.erase(slruRes.first._key);
 		}
 
 		return true;
@@ -702,6 +777,7 @@ public:
 
   bool IsHotKey(const std::string& key);
   Status GetHotKeys(std::vector<std::string>& hot_keys);
+  Status Remove(const std::string& key);
 
   void Display();
 };
@@ -23,14 +23,19 @@ Status HeatSeparatorWindow::RecordAccess(const std::string& key)
   {
     auto old_record = this->key_access_queue.front();
     this->key_access_queue.pop_front();
-    // map 清理机制，map 空间有限不能记录所有 key
-    if (--key_access_count[old_record.key] == 0)
-      this->key_access_count.erase(old_record.key);
+    // map 清理机制，map 空间有限不能记录所有 key；被移除的 Key 在移除前的记录已不再计数
+    auto count_iter = this->key_access_count.find(old_record.key);
+    if (count_iter != this->key_access_count.end() && old_record.seq >= count_iter->second.since &&
+        --count_iter->second.count == 0)
+      this->key_access_count.erase(count_iter);
   }
 
   // update key access records
-  this->key_access_queue.push_back({key, now});
-  this->key_access_count[key]++;
+  uint64_t seq = this->access_seq++;
+  this->key_access_queue.push_back({key, now, seq});
+  auto& access_count = this->key_access_count[key];
+  if (access_count.count++ == 0)
+    access_count.since = seq;
 
   return SUCCESS;
 }
@@ -53,20 +58,28 @@ Status HeatSeparatorWindow::Get(const std::string& key)
 
 bool HeatSeparatorWindow::IsHotKey(const std::string& key)
 {
-  auto access_count = this->key_access_count[key];
-  return access_count >= this->threshold;
+  auto count_iter = this->key_access_count.find(key);
+  return (count_iter != this->key_access_count.end() && count_iter->second.count >= this->threshold);
 }
 
 Status HeatSeparatorWindow::GetHotKeys(std::vector<std::string>& hot_keys)
 {
   for (auto map_iter = this->key_access_count.begin(); map_iter != this->key_access_count.end(); map_iter++)
   {
-    if (map_iter->second >= this->threshold)
+    if (map_iter->second.count >= this->threshold)
       hot_keys.push_back(map_iter->first);
   }
   return SUCCESS;
 }
 
+Status HeatSeparatorWindow::Remove(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->separator_mtx_);
+
+  // 只清除计数，访问记录留在队列中随窗口滑出；Key 重新访问时从新的序号计起，旧记录滑出不再扣减
+  return (this->key_access_count.erase(key) ? SUCCESS : NOT_FOUND);
+}
+
 void HeatSeparatorWindow::Display()
 {
   std::lock_guard<std::mutex> lock(this->separator_mtx_);
@@ -76,7 +89,8 @@ void HeatSeparatorWindow::Display()
   std::cout << "Key Access Queue: " << std::endl;
   for (auto iter = this->key_access_queue.begin(); iter != this->key_access_queue.end(); iter++)
   {
-    auto access_count = this->key_access_count[iter->key];
+    auto count_iter = this->key_access_count.find(iter->key);
+    uint32_t access_count = (count_iter != this->key_access_count.end()) ? count_iter->second.count : 0;
     std::cout << "  " << std::setw(20) << iter->key;
     if (access_count)
       std::cout << ", " << std::setw(10) << access_count << ", " << std::setw(10) << 
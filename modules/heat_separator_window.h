@@ -20,15 +20,24 @@ private:
     std::string key;
     // timestamp
     std::chrono::steady_clock::time_point timestamp;
+    // 访问序号
+    uint64_t seq;
+  };
+  struct AccessCount
+  {
+    uint32_t count = 0;
+    // 计数起始的访问序号，更早的记录属于 Remove 之前，滑出时不再扣减
+    uint64_t since = 0;
   };
 
   // 采样窗口大小
   std::chrono::milliseconds window_size;
   uint32_t threshold;
   // Key 访问计数
-  std::unordered_map<std::string, uint32_t> key_access_count;
+  std::unordered_map<std::string, AccessCount> key_access_count;
   // Key 访问记录队列
   std::deque<AccessEntry> key_access_queue;
+  uint64_t access_seq = 0;
 
   Status RecordAccess(const std::string& key);
 
@@ -40,6 +49,7 @@ public:
 
   bool IsHotKey(const std::string& key);
   Status GetHotKeys(std::vector<std::string>& hot_keys);
+  Status Remove(const std::string& key);
 
   void Display();
 };
@@ -6,6 +6,9 @@
 #include <algorithm>
 #include <atomic>
 #include <mutex>
+#include <string>
+#include <cstdint>
+#include <cstring>
 
 namespace module
 {
@@ -33,10 +36,39 @@ public:
   virtual bool IsHotKey(const std::string& key) = 0;
   // @brief 返回所有热数据
   virtual Status GetHotKeys(std::vector<std::string>& hot_keys) = 0;
+  // @brief 移除 Key（已被删除或过期），不在其中时返回 NOT_FOUND
+  virtual Status Remove(const std::string& key) { return NOT_FOUND; }
 
   virtual void Display() = 0;
 
+  // @brief 整数 Key id 接口（keytype=integer）
+  // 默认将 id 编码为 8 字节定长串后复用字符串实现：短串无堆分配、哈希更快
+  virtual Status Put(uint64_t key_id) { return this->Put(EncodeKeyId(key_id)); }
+  virtual Status Get(uint64_t key_id) { return this->Get(EncodeKeyId(key_id)); }
+  virtual bool IsHotKey(uint64_t key_id) { return this->IsHotKey(EncodeKeyId(key_id)); }
+  virtual Status Remove(uint64_t key_id) { return this->Remove(EncodeKeyId(key_id)); }
+  // @brief 返回所有热数据的 Key id，仅在以 id 接口写入时有效
+  virtual Status GetHotKeyIds(std::vector<uint64_t>& hot_key_ids)
+  {
+    std::vector<std::string> hot_keys;
+    Status s = this->GetHotKeys(hot_keys);
+    for (auto& k : hot_keys)
+      hot_key_ids.push_back(DecodeKeyId(k));
+    return s;
+  }
+
   std::string GetName() { return this->algorithm_name; }
+
+  static std::string EncodeKeyId(uint64_t key_id)
+  {
+    return std::string(reinterpret_cast<const char*>(&key_id), sizeof(key_id));
+  }
+  static uint64_t DecodeKeyId(const std::string& key)
+  {
+    uint64_t key_id = 0;
+    std::memcpy(&key_id, key.data(), std::min(key.size(), sizeof(key_id)));
+    return key_id;
+  }
 };
 
 /**
@@ -47,6 +79,9 @@ class HeatSeparator : public Separator
 protected:
 
 public:
+  // @brief 过期淘汰钩子：Key 的 TTL 到期时由 ExpiryWheel 的持有者调用，默认等同于删除，
+  //        让过期 Key 不再占用识别容量
+  virtual void OnExpire(const std::string& key) { this->Remove(key); }
 };
 
 /**
@@ -0,0 +1,95 @@
+#include "stack_distance.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace module
+{
+
+StackDistanceCounter::StackDistanceCounter()
+  : tree_(kMinSlots + 1, 0)
+{}
+
+void StackDistanceCounter::Update(uint64_t pos, const int32_t delta)
+{
+  // 树状数组下标从 1 开始
+  for (pos++; pos < this->tree_.size(); pos += pos & (~pos + 1))
+    this->tree_[pos] += delta;
+}
+
+uint64_t StackDistanceCounter::Prefix(uint64_t pos) const
+{
+  // [0, pos] 的和
+  uint64_t sum = 0;
+  for (pos++; pos > 0; pos -= pos & (~pos + 1))
+    sum += this->tree_[pos];
+  return sum;
+}
+
+void StackDistanceCounter::Compact()
+{
+  std::vector<std::pair<uint64_t, uint64_t>> order;
+  order.reserve(this->last_access_.size());
+  for (const auto& entry : this->last_access_)
+    order.emplace_back(entry.second, entry.first);
+  std::sort(order.begin(), order.end());
+  size_t slots = kMinSlots;
+  while (slots < order.size() * 2)
+    slots *= 2;
+  this->tree_.assign(slots + 1, 0);
+  for (uint64_t t = 0; t < order.size(); t++)
+  {
+    this->last_access_[order[t].second] = t;
+    this->Update(t, 1);
+  }
+  this->now_ = order.size();
+}
+
+void StackDistanceCounter::Access(const uint64_t key)
+{
+  if (this->now_ + 1 >= this->tree_.size())
+    this->Compact();
+  this->accesses_++;
+  auto it = this->last_access_.find(key);
+  if (it == this->last_access_.end())
+  {
+    this->cold_misses_++;
+    this->last_access_.emplace(key, this->now_);
+  }
+  else
+  {
+    // 上次访问之后（不含）到现在被访问过的不同 Key 数
+    uint64_t distance = this->Prefix(this->now_ - 1) - this->Prefix(it->second);
+    if (distance >= this->distances_.size())
+      this->distances_.resize(distance + 1, 0);
+    this->distances_[distance]++;
+    this->Update(it->second, -1);
+    it->second = this->now_;
+  }
+  this->Update(this->now_, 1);
+  this->now_++;
+}
+
+void StackDistanceCounter::Remove(const uint64_t key)
+{
+  auto it = this->last_access_.find(key);
+  if (it == this->last_access_.end())
+    return;
+  this->Update(it->second, -1);
+  this->last_access_.erase(it);
+}
+
+std::vector<double> StackDistanceCounter::GetHitRatios() const
+{
+  std::vector<double> ratios(this->distances_.size(), 0);
+  uint64_t hits = 0;
+  for (size_t d = 0; d < this->distances_.size(); d++)
+  {
+    hits += this->distances_[d];
+    // 容量 d + 1 时栈距离不超过 d 的访问命中
+    ratios[d] = this->accesses_ ? static_cast<double>(hits) / this->accesses_ : 0;
+  }
+  return ratios;
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef _STACK_DISTANCE_H_
+#define _STACK_DISTANCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace module
+{
+
+/**
+ * LRU 栈距离（精确）：访问一个 Key 时，距其上次访问之间访问过的不同 Key 数即栈距离，
+ * 容量为 C 的 LRU 命中当且仅当栈距离 < C，一遍即得全部容量下的命中率（Mattson）。
+ * 每个 Key 在其最近一次访问的时刻上记 1，用树状数组（Fenwick）求区间和，单次访问 O(log n)；
+ * 时刻用尽时按先后重新编号为 [0, Key 数)，内存与不同 Key 数成正比，与访问数无关
+ */
+class StackDistanceCounter
+{
+private:
+  static const size_t kMinSlots = 1 << 16;
+
+  // Key --> 最近一次访问的时刻
+  std::unordered_map<uint64_t, uint64_t> last_access_;
+  std::vector<uint32_t> tree_;
+  uint64_t now_ = 0;
+  // distances_[d]：栈距离为 d 的访问数
+  std::vector<uint64_t> distances_;
+  uint64_t cold_misses_ = 0;
+  uint64_t accesses_ = 0;
+
+  void Update(uint64_t pos, const int32_t delta);
+  uint64_t Prefix(uint64_t pos) const;
+  // @brief 时刻重新编号，树状数组按 Key 数重建
+  void Compact();
+
+public:
+  StackDistanceCounter();
+
+  void Access(const uint64_t key);
+  // @brief Key 被删除或过期：移出栈，之后再访问为冷缺失
+  void Remove(const uint64_t key);
+
+  uint64_t GetAccessCount() const { return this->accesses_; }
+  uint64_t GetColdMisses() const { return this->cold_misses_; }
+  // @brief 最大的有限栈距离 + 1，容量不小于它时只有冷缺失
+  size_t GetMaxUsefulCapacity() const { return this->distances_.size(); }
+  // @brief 各容量（1, 2, ..., GetMaxUsefulCapacity()）下的命中率
+  std::vector<double> GetHitRatios() const;
+};
+
+}
+
+#endif
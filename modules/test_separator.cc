@@ -3,12 +3,211 @@
 #include "heat_separator_window.h"
 #include "heat_separator_sketch_window.h"
 #include "heat_separator_heap.h"
+#include "heat_separator_lirs.h"
+#include "heat_separator_lru.h"
+#include "heat_separator_lfu.h"
+#include "heat_separator_s3_fifo.h"
+#include "heat_separator_w_tinylfu.h"
+#include "expiry_wheel.h"
 
 #include <random>
 #include <chrono>
+#include <thread>
 
 using namespace module;
 
+static int failures = 0;
+
+static void Check(const bool ok, const std::string& what)
+{
+  std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << std::endl;
+  if (!ok)
+    failures++;
+}
+
+static void TestLIRSSmallCapacity()
+{
+  // 小容量时 LIR 块占满、驻留 HIR 队列为空，FreeOne 曾无法淘汰而死循环（以 ctest 超时报告）
+  bool bounded = true;
+  for (size_t capacity = 1; capacity <= 20; capacity++)
+  {
+    std::mt19937 gen(capacity);
+    HeatSeparatorLIRS lirs(capacity);
+    for (int i = 0; i < 3000; i++)
+    {
+      std::string key = std::to_string(gen() % (capacity * 4 + 1));
+      int op = gen() % 10;
+      if (op < 5)
+        lirs.Put(key);
+      else if (op < 9)
+        lirs.Get(key);
+      else
+        lirs.Remove(key);
+    }
+    std::vector<std::string> hot_keys;
+    lirs.GetHotKeys(hot_keys);
+    bounded = bounded && hot_keys.size() <= capacity;
+  }
+  Check(bounded, "LIRS evicts at capacities 1..20 and keeps at most capacity LIR keys");
+}
+
+static bool HasHotKey(HeatSeparator& separator, const std::string& key)
+{
+  std::vector<std::string> hot_keys;
+  separator.GetHotKeys(hot_keys);
+  return std::find(hot_keys.begin(), hot_keys.end(), key) != hot_keys.end();
+}
+
+static void TestRemove()
+{
+  HeatSeparatorLru lru(8);
+  // 频率超过 capacity 的 Key 不算热 Key
+  HeatSeparatorLfu lfu(16, 1);
+  HeatSeparatorLruK lru_k(2, 8);
+  HeatSeparatorWindow window(std::chrono::milliseconds(60000), 3);
+  HeatSeparatorSketch sketch_window(8, 0.01, 0.01, 3, true);
+  HeatSepratorWTinyLFU w_tinylfu(100);
+  HeatSeparatorLIRS lirs(8);
+  HeatSeparatorS3FIFO s3_fifo(8);
+  for (HeatSeparator* separator : std::vector<HeatSeparator*>{&lru, &lfu, &lru_k, &window, &sketch_window,
+                                                              &w_tinylfu, &lirs, &s3_fifo})
+  {
+    for (int i = 0; i < 5; i++)
+    {
+      separator->Put("hot");
+      separator->Put("cold" + std::to_string(i));
+      separator->Get("hot");
+    }
+    bool hot = separator->IsHotKey("hot") && HasHotKey(*separator, "hot");
+    bool removed = separator->Remove("hot") == SUCCESS;
+    bool gone = !separator->IsHotKey("hot") && !HasHotKey(*separator, "hot") && separator->Remove("hot") != SUCCESS;
+    Check(hot && removed && gone, separator->GetName() + " Remove drops a hot key");
+  }
+
+  // 删除后 CMS 的计数一并扣除，再访问一次不应立即成为热 Key
+  for (int i = 0; i < 5; i++)
+    sketch_window.Put("key");
+  sketch_window.Remove("key");
+  sketch_window.Put("key");
+  Check(!sketch_window.IsHotKey("key"), "sketch_window Remove clears the key's count-min counts");
+
+  // 删除前的访问记录滑出窗口时不再扣减删除后的计数
+  HeatSeparatorWindow short_window(std::chrono::milliseconds(200), 3);
+  for (int i = 0; i < 3; i++)
+    short_window.Put("key");
+  short_window.Remove("key");
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  for (int i = 0; i < 3; i++)
+    short_window.Put("key");
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  // 触发窗口清理：删除前的 3 条记录滑出，删除后的 3 条仍在窗口内
+  short_window.Put("other");
+  Check(short_window.IsHotKey("key"), "window Remove does not undercount later accesses");
+
+  // 删除清空最低频的桶后，淘汰取下一个频率的桶
+  HeatSeparatorLfu small_lfu(3, 1);
+  for (int i = 0; i < 3; i++)
+    small_lfu.Put("a");
+  small_lfu.Put("b");
+  small_lfu.Put("c");
+  small_lfu.Remove("b");
+  small_lfu.Remove("c");
+  small_lfu.Put("d");
+  small_lfu.Put("e");
+  small_lfu.Put("f");
+  Check(small_lfu.IsHotKey("a") && !small_lfu.IsHotKey("d") && small_lfu.IsHotKey("e") && small_lfu.IsHotKey("f"),
+        "lfu evicts the least frequent key after its bucket was emptied by Remove");
+
+  // 同一 Key 放入两次只保留一个节点，删除后不残留副本
+  external_module::LRUCache<std::string> wlru(4);
+  external_module::SegmentLRUCache<std::string> slru(2, 2);
+  external_module::LRUNode<std::string> node(1, "twice", "0");
+  wlru.put(node);
+  wlru.put(node);
+  slru.put(node);
+  slru.put(node);
+  bool single = wlru.size() == 1 && slru.size() == 1;
+  bool erased = wlru.erase(1, "twice") && slru.erase(1, "twice");
+  Check(single && erased && wlru.size() == 0 && slru.size() == 0 && !slru.contains(1, "twice"),
+        "w_tinylfu caches keep one node per key and erase it");
+
+  // 窗口容量为 1：twice 两次经窗口进入 SLRU
+  HeatSepratorWTinyLFU small_w_tinylfu(100);
+  for (const char* key : {"a", "twice", "x", "twice"})
+    small_w_tinylfu.Put(key);
+  std::vector<std::string> before, after;
+  small_w_tinylfu.GetHotKeys(before);
+  small_w_tinylfu.Remove("twice");
+  small_w_tinylfu.GetHotKeys(after);
+  Check(before.size() == 2 && after == std::vector<std::string>{"x"} && !small_w_tinylfu.IsHotKey("twice"),
+        "w_tinylfu Remove drops a key that was put twice");
+}
+
+static void TestExpiryWheel()
+{
+  std::vector<std::string> expired;
+  ExpiryWheel wheel;
+  wheel.Schedule("a", 10);
+  wheel.Schedule("b", 20);
+  wheel.Schedule("c", 12);
+  wheel.Cancel("c");
+  // 首次推进只确定起点
+  wheel.Advance(5, expired);
+  wheel.Advance(9, expired);
+  Check(expired.empty(), "ExpiryWheel expires nothing before the deadline");
+  wheel.Advance(10, expired);
+  Check(expired == std::vector<std::string>{"a"}, "ExpiryWheel expires a key at its deadline");
+  expired.clear();
+  wheel.Advance(25, expired);
+  Check(expired == std::vector<std::string>{"b"} && wheel.GetScheduledCount() == 0,
+        "ExpiryWheel skips cancelled keys");
+  expired.clear();
+
+  // 重设过期时刻：只按最后一次登记过期
+  wheel.Schedule("d", 30);
+  wheel.Schedule("d", 40);
+  wheel.Advance(35, expired);
+  Check(expired.empty(), "ExpiryWheel ignores a rescheduled deadline");
+  wheel.Advance(40, expired);
+  Check(expired == std::vector<std::string>{"d"}, "ExpiryWheel expires a key at its new deadline");
+  expired.clear();
+
+  // 已经过去的时刻在下一秒过期
+  wheel.Schedule("e", 30);
+  wheel.Advance(41, expired);
+  Check(expired == std::vector<std::string>{"e"}, "ExpiryWheel expires a past deadline on the next tick");
+  expired.clear();
+
+  // 超过一圈（65536 秒）的 Key 留到下一圈
+  wheel.Schedule("f", 41 + 70000);
+  wheel.Advance(41 + 69999, expired);
+  Check(expired.empty(), "ExpiryWheel keeps a deadline more than one lap away");
+  wheel.Advance(41 + 70000, expired);
+  Check(expired == std::vector<std::string>{"f"}, "ExpiryWheel expires a deadline after a full lap");
+  expired.clear();
+
+  wheel.Schedule("g", 80000);
+  wheel.Clear();
+  wheel.Advance(100, expired);
+  wheel.Advance(90000, expired);
+  Check(expired.empty() && wheel.GetScheduledCount() == 0, "ExpiryWheel is empty after Clear");
+  Check(wheel.GetExpiredCount() == 5, "ExpiryWheel counts expired keys");
+}
+
+// @brief 自检，供 ctest 调用
+static int RunChecks()
+{
+  TestLIRSSmallCapacity();
+  TestRemove();
+  TestExpiryWheel();
+  if (failures)
+  {
+    std::cerr << failures << " check(s) failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
 void usage()
 {
   std::cerr << "Separator Algorithm: " << std::endl;
@@ -16,6 +215,7 @@ void usage()
   std::cerr << "  Window: 1" << std::endl;
   std::cerr << "  Sketch: 2" << std::endl;
   std::cerr << "  Heap:   3" << std::endl;
+  std::cerr << "  Self-checks: check" << std::endl;
 }
 
 int main(int argc, char *argv[])
@@ -26,6 +226,8 @@ int main(int argc, char *argv[])
     usage();
     exit(EXIT_FAILURE);
   }
+  if (std::string(argv[1]) == "check")
+    return RunChecks();
   int algorithm_arg = std::atoi(argv[1]); 
   
   unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
@@ -38,7 +240,7 @@ int main(int argc, char *argv[])
   else if (algorithm_arg == 1)
     heat_separator = new HeatSeparatorWindow(std::chrono::milliseconds(5), 3);
   else if (algorithm_arg == 2)
-    heat_separator = new HeatSeparatorSketch(50, 0.001, 0.01, 3);
+    heat_separator = new HeatSeparatorSketch(50, 0.001, 0.01, 3, true);
   // else if (algorithm_arg == 3)
   //   heat_separator = new HeatSeparatorHeap(10, 3);
 
@@ -0,0 +1,125 @@
+#include "twitter_trace_analysis.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace module;
+
+static int failures = 0;
+
+static void Check(const bool ok, const std::string& what)
+{
+  std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << std::endl;
+  if (!ok)
+    failures++;
+}
+
+// splitmix64，HyperLogLog 要求输入为混合充分的哈希
+static uint64_t Mix(uint64_t x)
+{
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+static bool Near(const double value, const double expected, const double relative)
+{
+  return std::fabs(value - expected) <= relative * expected;
+}
+
+static void TestHyperLogLog()
+{
+  // precision 14：标准误差约 0.8%，按 4 倍放宽
+  for (uint64_t n : {100ULL, 10000ULL, 1000000ULL})
+  {
+    HyperLogLog hll(14);
+    for (uint64_t i = 0; i < n; i++)
+      hll.Add(Mix(i));
+    Check(Near(hll.Estimate(), n, 0.035), "HyperLogLog estimates " + std::to_string(n) + " distinct keys: " +
+                                              std::to_string(hll.Estimate()));
+  }
+
+  HyperLogLog once(14), repeated(14);
+  for (uint64_t i = 0; i < 50000; i++)
+  {
+    once.Add(Mix(i));
+    for (int r = 0; r < 4; r++)
+      repeated.Add(Mix(i));
+  }
+  Check(once.Estimate() == repeated.Estimate(), "HyperLogLog ignores repeated keys");
+
+  // 两个线程各自统计不相交的 Key，合并后为并集
+  HyperLogLog left(14), right(14), overlap(14);
+  for (uint64_t i = 0; i < 200000; i++)
+    (i % 2 ? left : right).Add(Mix(i));
+  for (uint64_t i = 0; i < 100000; i++)
+    overlap.Add(Mix(i));
+  left.Merge(right);
+  Check(Near(left.Estimate(), 200000, 0.035), "HyperLogLog merges disjoint key sets");
+  left.Merge(overlap);
+  Check(Near(left.Estimate(), 200000, 0.035), "HyperLogLog merge does not count shared keys twice");
+
+  left.Clear();
+  Check(left.Estimate() == 0, "HyperLogLog is empty after Clear");
+}
+
+static void TestQuantileSketch()
+{
+  QuantileSketch empty;
+  Check(empty.Quantile(0.5) == 0 && empty.Count() == 0 && empty.Mean() == 0, "QuantileSketch without values returns 0");
+
+  // 1..100000 均匀分布：分位数的相对误差不超过 1%（另加取整的 1）
+  const uint64_t n = 100000;
+  QuantileSketch sketch;
+  for (uint64_t v = 1; v <= n; v++)
+    sketch.Add(v);
+  bool within = true;
+  for (double q : {0.0, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0})
+  {
+    double exact = 1 + std::floor(q * (n - 1));
+    double value = static_cast<double>(sketch.Quantile(q));
+    if (std::fabs(value - exact) > 0.01 * exact + 1)
+    {
+      std::cout << "  q=" << q << " exact=" << exact << " sketch=" << value << std::endl;
+      within = false;
+    }
+  }
+  Check(within, "QuantileSketch quantiles are within 1% of the exact values");
+  Check(sketch.Count() == n && sketch.Max() == n && Near(sketch.Mean(), (n + 1) / 2.0, 1e-9),
+        "QuantileSketch keeps count, max and mean exactly");
+  Check(sketch.Quantile(1.0) <= n, "QuantileSketch never exceeds the maximum");
+
+  // 0 单独计数：一半为 0 时中位数以下都是 0
+  QuantileSketch zeros;
+  for (uint64_t v = 0; v < 1000; v++)
+    zeros.Add(v % 2 ? 1000 : 0);
+  Check(zeros.Quantile(0.25) == 0 && Near(zeros.Quantile(0.75), 1000, 0.01), "QuantileSketch counts zeros separately");
+
+  // 按线程分开统计再合并，与一次统计相同
+  QuantileSketch whole, part_a, part_b;
+  for (uint64_t i = 0; i < 50000; i++)
+  {
+    uint64_t v = Mix(i) % 1000000;
+    whole.Add(v);
+    (i % 3 ? part_a : part_b).Add(v);
+  }
+  part_a.Merge(part_b);
+  bool same = part_a.Count() == whole.Count() && part_a.Max() == whole.Max();
+  for (double q : {0.01, 0.5, 0.9, 0.999})
+    same = same && part_a.Quantile(q) == whole.Quantile(q);
+  Check(same, "QuantileSketch merge matches a single sketch");
+}
+
+int main()
+{
+  TestHyperLogLog();
+  TestQuantileSketch();
+  if (failures)
+  {
+    std::cerr << failures << " check(s) failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
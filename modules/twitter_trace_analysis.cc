@@ -0,0 +1,405 @@
+#include "twitter_trace_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <tbb/parallel_for.h>
+
+namespace module
+{
+
+namespace
+{
+
+// 与 TwitterTraceOperation 的取值顺序一致
+const char* const kOperationNames[TraceAnalyzer::kOperationCount] = {
+  "get", "gets", "set", "add", "replace", "cas", "append", "prepend", "delete", "incr", "decr"
+};
+
+// splitmix64 的混合函数：Key 哈希的各位再打散，供 HyperLogLog 与线程划分使用
+uint64_t Mix64(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// 按下标均分 [0, n) 为 thread_count 份，在 arena 的常驻工作线程上并行执行 fn(t, begin, end)；
+// 每批请求都会调用，不为每批创建线程
+template <typename Fn>
+void RunParallel(tbb::task_arena& arena, const size_t thread_count, const size_t n, Fn fn)
+{
+  if (thread_count == 1)
+  {
+    fn(0, 0, n);
+    return;
+  }
+  arena.execute([&] {
+    tbb::parallel_for(size_t(0), thread_count, [&](size_t t) {
+      fn(t, n * t / thread_count, n * (t + 1) / thread_count);
+    });
+  });
+}
+
+}
+
+HyperLogLog::HyperLogLog(const uint32_t precision)
+  : precision_(precision), registers_(size_t(1) << precision, 0)
+{}
+
+void HyperLogLog::Add(const uint64_t hash)
+{
+  size_t idx = hash >> (64 - this->precision_);
+  uint64_t rest = hash << this->precision_;
+  uint8_t rank = rest ? static_cast<uint8_t>(__builtin_clzll(rest) + 1) : static_cast<uint8_t>(64 - this->precision_ + 1);
+  if (rank > this->registers_[idx])
+    this->registers_[idx] = rank;
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other)
+{
+  for (size_t i = 0; i < this->registers_.size(); i++)
+    this->registers_[i] = std::max(this->registers_[i], other.registers_[i]);
+}
+
+void HyperLogLog::Clear()
+{
+  std::fill(this->registers_.begin(), this->registers_.end(), 0);
+}
+
+double HyperLogLog::Estimate() const
+{
+  double m = static_cast<double>(this->registers_.size());
+  double sum = 0;
+  size_t zeros = 0;
+  for (uint8_t r : this->registers_)
+  {
+    sum += std::ldexp(1.0, -r);
+    zeros += (r == 0);
+  }
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  // 小基数时线性计数更准
+  if (estimate <= 2.5 * m && zeros)
+    estimate = m * std::log(m / zeros);
+  return estimate;
+}
+
+QuantileSketch::QuantileSketch() {}
+
+void QuantileSketch::Add(const uint64_t value)
+{
+  static const double kLogGamma = std::log((1 + kAccuracy) / (1 - kAccuracy));
+  this->count_++;
+  this->sum_ += value;
+  this->max_ = std::max(this->max_, value);
+  if (value == 0)
+  {
+    this->zero_count_++;
+    return;
+  }
+  size_t idx = static_cast<size_t>(std::ceil(std::log(static_cast<double>(value)) / kLogGamma));
+  if (idx >= this->buckets_.size())
+    this->buckets_.resize(idx + 1, 0);
+  this->buckets_[idx]++;
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other)
+{
+  if (other.buckets_.size() > this->buckets_.size())
+    this->buckets_.resize(other.buckets_.size(), 0);
+  for (size_t i = 0; i < other.buckets_.size(); i++)
+    this->buckets_[i] += other.buckets_[i];
+  this->zero_count_ += other.zero_count_;
+  this->count_ += other.count_;
+  this->sum_ += other.sum_;
+  this->max_ = std::max(this->max_, other.max_);
+}
+
+uint64_t QuantileSketch::Quantile(const double q) const
+{
+  static const double kGamma = (1 + kAccuracy) / (1 - kAccuracy);
+  if (this->count_ == 0)
+    return 0;
+  uint64_t rank = static_cast<uint64_t>(q * (this->count_ - 1));
+  if (rank < this->zero_count_)
+    return 0;
+  uint64_t seen = this->zero_count_;
+  for (size_t i = 0; i < this->buckets_.size(); i++)
+  {
+    seen += this->buckets_[i];
+    if (seen > rank)
+    {
+      // 桶 i 覆盖 (gamma^(i-1), gamma^i]，取使相对误差最小的代表值
+      double value = 2 * std::pow(kGamma, static_cast<double>(i)) / (kGamma + 1);
+      return std::min(this->max_, static_cast<uint64_t>(std::llround(value)));
+    }
+  }
+  return this->max_;
+}
+
+std::string QuantileSketch::Summary() const
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(1) << this->Mean() << "," << this->Quantile(0.5) << ","
+     << this->Quantile(0.9) << "," << this->Quantile(0.99) << "," << this->Quantile(0.999) << "," << this->max_;
+  return ss.str();
+}
+
+TraceAnalyzer::TraceAnalyzer(const size_t thread_count, const uint64_t window_sec)
+  : thread_count_(std::max<size_t>(1, thread_count)), window_sec_(std::max<uint64_t>(1, window_sec)),
+    threads_(thread_count_), arena_(static_cast<int>(thread_count_))
+{}
+
+void TraceAnalyzer::Add(const std::vector<Request>& requests)
+{
+  if (requests.empty())
+    return;
+  if (this->first_timestamp_ == UINT64_MAX)
+    this->first_timestamp_ = requests.front().timestamp;
+  this->hashes_.resize(requests.size());
+  // 与 Key 无关的统计按下标划分，同时算出各请求 Key 的哈希
+  RunParallel(this->arena_, this->thread_count_, requests.size(), [&](size_t t, size_t begin, size_t end) {
+    this->CountRequests(this->threads_[t], requests, begin, end);
+  });
+  // Key 相关的统计按哈希划分，每个线程按 Trace 顺序处理归属自己的 Key
+  RunParallel(this->arena_, this->thread_count_, this->thread_count_, [&](size_t t, size_t, size_t) {
+    this->CountKeys(this->threads_[t], t, requests);
+  });
+}
+
+void TraceAnalyzer::CountRequests(ThreadStats& stats, const std::vector<Request>& requests,
+                                  const size_t begin, const size_t end)
+{
+  for (size_t i = begin; i < end; i++)
+  {
+    const Request& req = requests[i];
+    this->hashes_[i] = Mix64(TraceKeyDict::Hash(req.anonymized_key));
+    stats.requests++;
+    if (static_cast<size_t>(req.operation) < kOperationCount)
+      stats.op_counts[req.operation]++;
+    stats.key_sizes.Add(req.key_size);
+    stats.value_sizes.Add(req.value_size);
+    if (req.ttl)
+      stats.ttls.Add(req.ttl);
+    stats.min_timestamp = std::min<uint64_t>(stats.min_timestamp, req.timestamp);
+    stats.max_timestamp = std::max<uint64_t>(stats.max_timestamp, req.timestamp);
+  }
+}
+
+void TraceAnalyzer::CountKeys(ThreadStats& stats, const size_t thread_id, const std::vector<Request>& requests)
+{
+  const size_t capacity = std::max<size_t>(1, kSampledKeys / this->thread_count_);
+  for (size_t i = 0; i < requests.size(); i++)
+  {
+    uint64_t hash = this->hashes_[i];
+    if (hash % this->thread_count_ != thread_id)
+      continue;
+    const Request& req = requests[i];
+    // 时间戳回退的请求计入当前窗口
+    int64_t window = req.timestamp > this->first_timestamp_ ?
+                     static_cast<int64_t>((req.timestamp - this->first_timestamp_) / this->window_sec_) : 0;
+    if (window > stats.window)
+    {
+      if (stats.window >= 0)
+        this->CloseWindow(stats);
+      stats.window = window;
+    }
+    stats.window_row.requests++;
+    stats.window_row.bytes += req.key_size + req.value_size;
+    stats.window_keys.Add(hash);
+    stats.keys.Add(hash);
+
+    // 按 Key 哈希采样，阈值只降不升，表中的 Key 自首次出现起即被完整统计
+    uint64_t sample_hash = Mix64(hash);
+    if (sample_hash >= stats.sample_threshold)
+      continue;
+    SampledKey& key = stats.sampled[sample_hash];
+    key.count++;
+    if (req.ttl)
+    {
+      if (key.ttl && key.ttl != req.ttl)
+        key.ttl_changed = true;
+      key.ttl = req.ttl;
+    }
+    if (stats.sampled.size() > capacity)
+      this->ShrinkSample(stats, capacity);
+  }
+}
+
+void TraceAnalyzer::CloseWindow(ThreadStats& stats)
+{
+  stats.window_row.distinct_keys = stats.window_keys.Estimate();
+  // 两个估计的误差不同，累计值不小于窗口内的值
+  stats.window_row.cumulative_keys = std::max(stats.keys.Estimate(), stats.window_row.distinct_keys);
+  stats.windows[stats.window] = stats.window_row;
+  stats.window_row = WindowRow();
+  stats.window_keys.Clear();
+}
+
+void TraceAnalyzer::ShrinkSample(ThreadStats& stats, const size_t capacity)
+{
+  std::vector<uint64_t> hashes;
+  hashes.reserve(stats.sampled.size());
+  for (const auto& key : stats.sampled)
+    hashes.push_back(key.first);
+  size_t keep = capacity * 3 / 4;
+  std::nth_element(hashes.begin(), hashes.begin() + keep, hashes.end());
+  stats.sample_threshold = hashes[keep];
+  for (auto it = stats.sampled.begin(); it != stats.sampled.end();)
+  {
+    if (it->first >= stats.sample_threshold)
+      it = stats.sampled.erase(it);
+    else
+      ++it;
+  }
+}
+
+void TraceAnalyzer::Finish()
+{
+  uint64_t threshold = UINT64_MAX;
+  for (auto& stats : this->threads_)
+  {
+    if (stats.window >= 0)
+      this->CloseWindow(stats);
+    stats.window = -1;
+    threshold = std::min(threshold, stats.sample_threshold);
+
+    this->total_.requests += stats.requests;
+    for (size_t op = 0; op < kOperationCount; op++)
+      this->total_.op_counts[op] += stats.op_counts[op];
+    this->total_.key_sizes.Merge(stats.key_sizes);
+    this->total_.value_sizes.Merge(stats.value_sizes);
+    this->total_.ttls.Merge(stats.ttls);
+    this->total_.min_timestamp = std::min(this->total_.min_timestamp, stats.min_timestamp);
+    this->total_.max_timestamp = std::max(this->total_.max_timestamp, stats.max_timestamp);
+    this->total_.keys.Merge(stats.keys);
+  }
+
+  // 各线程的 Key 集合互不相交，窗口内的计数直接相加；线程在某窗口没有请求时沿用其此前的累计值
+  std::vector<double> cumulative(this->threads_.size(), 0);
+  std::vector<std::map<uint64_t, WindowRow>::const_iterator> its;
+  for (const auto& stats : this->threads_)
+    its.push_back(stats.windows.begin());
+  while (true)
+  {
+    uint64_t window = UINT64_MAX;
+    for (size_t t = 0; t < this->threads_.size(); t++)
+    {
+      if (its[t] != this->threads_[t].windows.end())
+        window = std::min(window, its[t]->first);
+    }
+    if (window == UINT64_MAX)
+      break;
+    WindowRow row;
+    for (size_t t = 0; t < this->threads_.size(); t++)
+    {
+      if (its[t] != this->threads_[t].windows.end() && its[t]->first == window)
+      {
+        row.requests += its[t]->second.requests;
+        row.bytes += its[t]->second.bytes;
+        row.distinct_keys += its[t]->second.distinct_keys;
+        cumulative[t] = its[t]->second.cumulative_keys;
+        ++its[t];
+      }
+      row.cumulative_keys += cumulative[t];
+    }
+    this->windows_[window] = row;
+  }
+
+  // 各线程的采样阈值统一为最小值，使全局采样率一致
+  this->sample_rate_ = threshold == UINT64_MAX ? 1.0 : std::ldexp(static_cast<double>(threshold), -64);
+  this->sampled_keys_.clear();
+  for (const auto& stats : this->threads_)
+  {
+    for (const auto& key : stats.sampled)
+    {
+      if (key.first < threshold)
+        this->sampled_keys_.push_back(key.second);
+    }
+  }
+}
+
+bool TraceAnalyzer::WriteReport(const std::string& prefix) const
+{
+  std::ofstream report(prefix + "_analysis.txt");
+  std::ofstream windows(prefix + "_windows.csv");
+  if (!report.is_open() || !windows.is_open())
+  {
+    YCSB_C_LOG_ERROR("Cannot write analysis report: %s", prefix.c_str());
+    return false;
+  }
+  const ThreadStats& total = this->total_;
+  uint64_t requests = std::max<uint64_t>(1, total.requests);
+  report << std::fixed << std::setprecision(2);
+  report << "requests: " << total.requests << std::endl;
+  if (total.requests)
+    report << "timestamps: " << total.min_timestamp << " - " << total.max_timestamp
+           << " (" << total.max_timestamp - total.min_timestamp << " s)" << std::endl;
+  report << "distinct_keys (hyperloglog, ~0.8% error): " << std::llround(total.keys.Estimate()) << std::endl;
+
+  report << std::endl << "[operations] count,percent" << std::endl;
+  for (size_t op = 0; op < kOperationCount; op++)
+  {
+    if (total.op_counts[op])
+      report << kOperationNames[op] << ": " << total.op_counts[op] << ","
+             << 100.0 * total.op_counts[op] / requests << std::endl;
+  }
+
+  report << std::endl << "[sizes] count,mean,p50,p90,p99,p999,max (1% relative error)" << std::endl;
+  report << "key_size: " << total.key_sizes.Count() << "," << total.key_sizes.Summary() << std::endl;
+  report << "value_size: " << total.value_sizes.Count() << "," << total.value_sizes.Summary() << std::endl;
+  report << "request_ttl (ttl > 0): " << total.ttls.Count() << "," << total.ttls.Summary() << std::endl;
+
+  // 采样 Key 的精确计数，比例直接推广到全部 Key
+  size_t one_hit = 0, with_ttl = 0, ttl_changed = 0;
+  uint64_t sampled_requests = 0;
+  QuantileSketch key_ttls;
+  for (const auto& key : this->sampled_keys_)
+  {
+    one_hit += (key.count == 1);
+    sampled_requests += key.count;
+    if (key.ttl)
+    {
+      with_ttl++;
+      key_ttls.Add(key.ttl);
+    }
+    ttl_changed += key.ttl_changed;
+  }
+  size_t sampled = std::max<size_t>(1, this->sampled_keys_.size());
+  report << std::endl << "[keys] sampled by key hash" << std::endl;
+  report << "sample_rate: " << std::setprecision(6) << this->sample_rate_ << std::setprecision(2) << std::endl;
+  report << "sampled_keys: " << this->sampled_keys_.size() << " (estimated keys: "
+         << std::llround(this->sampled_keys_.size() / this->sample_rate_) << ")" << std::endl;
+  report << "one_hit_wonders: " << 100.0 * one_hit / sampled << "% of keys, "
+         << 100.0 * one_hit / std::max<uint64_t>(1, sampled_requests) << "% of requests" << std::endl;
+  report << "keys_with_ttl: " << 100.0 * with_ttl / sampled << "%" << std::endl;
+  report << "keys_with_changing_ttl: " << 100.0 * ttl_changed / sampled << "%" << std::endl;
+  report << "key_ttl (last ttl of each key): " << key_ttls.Count() << "," << key_ttls.Summary() << std::endl;
+
+  QuantileSketch window_keys, window_bytes;
+  windows << "window,start,requests,distinct_keys,cumulative_keys,working_set_bytes" << std::endl;
+  for (const auto& entry : this->windows_)
+  {
+    const WindowRow& row = entry.second;
+    // 工作集字节数：不同 Key 数 × 窗口内请求的平均对象大小（Key + value）
+    double object_bytes = row.requests ? static_cast<double>(row.bytes) / row.requests : 0;
+    uint64_t distinct = std::llround(row.distinct_keys);
+    uint64_t ws_bytes = std::llround(row.distinct_keys * object_bytes);
+    window_keys.Add(distinct);
+    window_bytes.Add(ws_bytes);
+    windows << entry.first << "," << this->first_timestamp_ + entry.first * this->window_sec_ << ","
+            << row.requests << "," << distinct << "," << std::llround(row.cumulative_keys) << "," << ws_bytes << std::endl;
+  }
+  report << std::endl << "[windows] " << this->window_sec_ << " s each, mean,p50,p90,p99,p999,max over windows (see "
+         << prefix << "_windows.csv)" << std::endl;
+  report << "windows: " << this->windows_.size() << std::endl;
+  report << "distinct_keys_per_window: " << window_keys.Summary() << std::endl;
+  report << "working_set_bytes_per_window: " << window_bytes.Summary() << std::endl;
+  return report.good() && windows.good();
+}
+
+}
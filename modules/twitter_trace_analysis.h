@@ -0,0 +1,159 @@
+#ifndef _TWITTER_TRACE_ANALYSIS_H_
+#define _TWITTER_TRACE_ANALYSIS_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <tbb/task_arena.h>
+
+#include "twitter_trace_reader.h"
+
+/**
+ * Trace 特征分析（twitter_trace_analyzer）
+ * 一遍扫描、多线程并行、内存有界：请求按 Key 哈希归属线程，各线程的 Key 集合互不相交；
+ * 基数用 HyperLogLog 估计，分布用对数分桶的分位数草图，单次访问 Key 比例与每 Key TTL
+ * 由固定容量的 Key 哈希采样表（容量满时降低采样阈值）精确统计后按采样率推广。
+ * 用法：twitter_trace_analyzer <trace> <report_prefix> [window_sec] [threads] [delimiter] [merge]，
+ * 输入可为文本、压缩、多文件或二进制 Trace；统计操作比例，Key / value 大小与请求 TTL 的分布，不同 Key 数，
+ * 每个窗口（默认 3600 s）的不同 Key 数、累计不同 Key 数与工作集字节数，单次访问 Key 比例、带 TTL 的 Key 比例
+ * 与每 Key TTL 分布；输出 <report_prefix>_analysis.txt 汇总报告与 <report_prefix>_windows.csv 时间序列
+ */
+
+namespace module
+{
+
+/**
+ * HyperLogLog 基数估计，2^precision 个 6 位寄存器（按字节存），相对误差约 1.04 / sqrt(2^precision)
+ */
+class HyperLogLog
+{
+private:
+  uint32_t precision_;
+  std::vector<uint8_t> registers_;
+
+public:
+  explicit HyperLogLog(const uint32_t precision = 14);
+
+  // @brief hash 需为混合充分的 64 位哈希
+  void Add(const uint64_t hash);
+  void Merge(const HyperLogLog& other);
+  void Clear();
+  double Estimate() const;
+};
+
+/**
+ * 分位数草图：值按 gamma = (1 + a) / (1 - a) 对数分桶，分位数的相对误差不超过 a，可合并
+ */
+class QuantileSketch
+{
+private:
+  static constexpr double kAccuracy = 0.01;
+
+  std::vector<uint64_t> buckets_;
+  uint64_t zero_count_ = 0;
+  uint64_t count_ = 0;
+  double sum_ = 0;
+  uint64_t max_ = 0;
+
+public:
+  QuantileSketch();
+
+  void Add(const uint64_t value);
+  void Merge(const QuantileSketch& other);
+  // @brief q ∈ [0, 1]，没有值时返回 0
+  uint64_t Quantile(const double q) const;
+  uint64_t Count() const { return this->count_; }
+  uint64_t Max() const { return this->max_; }
+  double Mean() const { return this->count_ ? this->sum_ / this->count_ : 0; }
+  // @brief "mean,p50,p90,p99,p999,max"
+  std::string Summary() const;
+};
+
+/**
+ * 一遍并行的 Trace 特征统计
+ */
+class TraceAnalyzer
+{
+public:
+  static const size_t kOperationCount = TwitterTraceOperation::DECR + 1;
+  // 采样表总容量（Key 数），按线程均分
+  static const size_t kSampledKeys = 1 << 20;
+
+  // window_sec：按时间戳划分统计窗口的长度（秒）
+  TraceAnalyzer(const size_t thread_count, const uint64_t window_sec);
+
+  // @brief 统计一批按 Trace 顺序排列的请求（批内并行，批间顺序）
+  void Add(const std::vector<Request>& requests);
+  // @brief 关闭各线程尚未结束的窗口并汇总
+  void Finish();
+  // @brief 写出 <prefix>_analysis.txt（汇总报告）与 <prefix>_windows.csv（各窗口的时间序列）
+  bool WriteReport(const std::string& prefix) const;
+
+private:
+  struct SampledKey
+  {
+    uint32_t count = 0;
+    uint32_t ttl = 0;
+    // TTL 是否在请求间变化过
+    bool ttl_changed = false;
+  };
+
+  struct WindowRow
+  {
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+    double distinct_keys = 0;
+    // 至窗口结束时累计的不同 Key 数
+    double cumulative_keys = 0;
+  };
+
+  // 各线程的局部统计，汇总时合并
+  struct ThreadStats
+  {
+    // 与 Key 无关的统计（按请求下标划分）
+    uint64_t requests = 0;
+    uint64_t op_counts[kOperationCount] = {};
+    QuantileSketch key_sizes;
+    QuantileSketch value_sizes;
+    QuantileSketch ttls;
+    uint64_t min_timestamp = UINT64_MAX;
+    uint64_t max_timestamp = 0;
+
+    // 归属本线程的 Key 的统计（按 Key 哈希划分）
+    HyperLogLog keys{14};
+    HyperLogLog window_keys{12};
+    int64_t window = -1;
+    WindowRow window_row;
+    std::map<uint64_t, WindowRow> windows;
+    std::unordered_map<uint64_t, SampledKey> sampled;
+    // 采中条件：Key 哈希 < sample_threshold
+    uint64_t sample_threshold = UINT64_MAX;
+  };
+
+  const size_t thread_count_;
+  const uint64_t window_sec_;
+  std::vector<ThreadStats> threads_;
+  // 当前批次各请求 Key 的混合哈希
+  std::vector<uint64_t> hashes_;
+  uint64_t first_timestamp_ = UINT64_MAX;
+  // 各批次共用的工作线程
+  tbb::task_arena arena_;
+
+  // 汇总结果
+  ThreadStats total_;
+  std::map<uint64_t, WindowRow> windows_;
+  double sample_rate_ = 1.0;
+  std::vector<SampledKey> sampled_keys_;
+
+  void CountRequests(ThreadStats& stats, const std::vector<Request>& requests, const size_t begin, const size_t end);
+  void CountKeys(ThreadStats& stats, const size_t thread_id, const std::vector<Request>& requests);
+  void CloseWindow(ThreadStats& stats);
+  // @brief 采样表超出容量时降低阈值，淘汰哈希较大的 1/4
+  void ShrinkSample(ThreadStats& stats, const size_t capacity);
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "twitter_trace_analysis.h"
+#include "twitter_trace_binary.h"
+#include "twitter_trace_source.h"
+#include "core/timer.h"
+
+#include <thread>
+
+using namespace module;
+
+// 每批读取并统计的请求数
+static const size_t kBatchRequests = 1 << 20;
+
+void usage()
+{
+  std::cerr << "Usage: twitter_trace_analyzer <trace> <report_prefix> [window_sec] [threads] [delimiter] [merge]" << std::endl;
+  std::cerr << "  Characterize a Twitter Cache-trace in one parallel pass with bounded memory" << std::endl;
+  std::cerr << "  trace:         a binary trace, or text: a file, a comma-separated list or a glob, gzip / zstd allowed" << std::endl;
+  std::cerr << "  report_prefix: writes <report_prefix>_analysis.txt and <report_prefix>_windows.csv" << std::endl;
+  std::cerr << "  window_sec:    length of the windows for distinct keys and working sets (default: 3600)" << std::endl;
+  std::cerr << "  threads:       analysis threads (default: hardware concurrency)" << std::endl;
+  std::cerr << "  delimiter:     field delimiter of text traces (default: ',')" << std::endl;
+  std::cerr << "  merge:         concat | timestamp, how several input files are combined (default: concat)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Missing Argument" << std::endl;
+    usage();
+    exit(EXIT_FAILURE);
+  }
+  std::string input_path = argv[1];
+  std::string report_prefix = argv[2];
+  uint64_t window_sec = (argc > 3) ? std::stoull(argv[3]) : 3600;
+  size_t thread_count = (argc > 4) ? std::stoull(argv[4]) : std::thread::hardware_concurrency();
+  char delimiter = (argc > 5 && argv[5][0]) ? argv[5][0] : ',';
+  std::string merge = (argc > 6) ? argv[6] : "concat";
+  if (merge != "concat" && merge != "timestamp")
+  {
+    std::cerr << "Unknown merge mode: " << merge << std::endl;
+    usage();
+    exit(EXIT_FAILURE);
+  }
+
+  utils::Timer timer;
+  std::vector<std::string> input_paths = ExpandTraceFiles(input_path);
+  if (input_paths.empty())
+  {
+    YCSB_C_LOG_ERROR("No trace file given: %s", input_path.c_str());
+    exit(EXIT_FAILURE);
+  }
+  TraceAnalyzer analyzer(thread_count, window_sec);
+  std::vector<Request> requests;
+  bool no_error = true;
+  size_t input_bytes = 0;
+  if (input_paths.size() == 1 && TraceBinaryFile::IsBinaryTrace(input_paths[0]))
+  {
+    TraceBinaryFile binary;
+    if (!binary.Open(input_paths[0]))
+      exit(EXIT_FAILURE);
+    uint64_t record_count = binary.GetRecordCount();
+    for (uint64_t begin = 0; begin < record_count; begin += kBatchRequests)
+    {
+      requests.resize(std::min<uint64_t>(kBatchRequests, record_count - begin));
+      for (size_t i = 0; i < requests.size(); i++)
+        binary.GetRequest(begin + i, requests[i]);
+      analyzer.Add(requests);
+    }
+    input_bytes = record_count * sizeof(TraceBinaryRecord);
+  }
+  else
+  {
+    // 文本 Trace 经 TraceRequestSource 读取：后台线程读取、解压，块内并行解析
+    TraceRequestSource source(delimiter, merge == "timestamp");
+    if (!source.Open(input_paths))
+      exit(EXIT_FAILURE);
+    TraceKeyDict batch_keys;
+    while (true)
+    {
+      requests.clear();
+      batch_keys.Clear();
+      if (source.Read(requests, batch_keys, kBatchRequests) == 0)
+        break;
+      analyzer.Add(requests);
+    }
+    input_bytes = source.GetByteCount();
+    no_error = source.NoError();
+  }
+  analyzer.Finish();
+  if (!analyzer.WriteReport(report_prefix))
+    exit(EXIT_FAILURE);
+
+  double duration = timer.GetDurationSec();
+  YCSB_C_LOG_INFO("Analyzed %s (%.1f MB) in %.3f s: %.1f MB/s", input_path.c_str(), input_bytes / 1e6,
+                  duration, duration > 0 ? input_bytes / 1e6 / duration : 0);
+  YCSB_C_LOG_INFO("Report written to %s_analysis.txt and %s_windows.csv", report_prefix.c_str(), report_prefix.c_str());
+  if (!no_error)
+    YCSB_C_LOG_ERROR("Some lines were skipped due to invalid format");
+  return no_error ? 0 : EXIT_FAILURE;
+}
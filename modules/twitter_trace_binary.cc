@@ -0,0 +1,242 @@
+#include "twitter_trace_binary.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace module
+{
+
+// 每次批量写出的记录数
+static const size_t kWriteBatchRecords = 1 << 16;
+
+TraceBinaryWriter::TraceBinaryWriter(const uint64_t chunk_records)
+  : chunk_records_(chunk_records ? chunk_records : kTraceBinaryChunkRecords)
+{
+  this->buffer_.reserve(kWriteBatchRecords);
+}
+
+TraceBinaryWriter::~TraceBinaryWriter()
+{
+  if (this->file_)
+    fclose(this->file_);
+}
+
+bool TraceBinaryWriter::Open(const std::string& path)
+{
+  this->file_ = fopen(path.c_str(), "wb");
+  if (!this->file_)
+  {
+    YCSB_C_LOG_ERROR("Error opening binary trace file: %s", path.c_str());
+    return false;
+  }
+  this->path_ = path;
+  // 先占位文件头，Close 时回填
+  TraceBinaryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  return fwrite(&header, sizeof(header), 1, this->file_) == 1;
+}
+
+bool TraceBinaryWriter::Append(const Request& req)
+{
+  if (this->record_count_ % this->chunk_records_ == 0)
+    this->chunk_offsets_.push_back(sizeof(TraceBinaryHeader) + this->record_count_ * sizeof(TraceBinaryRecord));
+
+  uint32_t key_id = this->keys_.Intern(req.anonymized_key);
+  if (key_id == TraceKeyDict::kNoKey)
+  {
+    YCSB_C_LOG_ERROR("Too many distinct keys for binary trace: %zu", this->keys_.Size());
+    return false;
+  }
+
+  TraceBinaryRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.timestamp = static_cast<uint32_t>(req.timestamp);
+  record.key_id = key_id;
+  record.key_size = req.key_size;
+  record.value_size = req.value_size;
+  record.client_id = req.client_id;
+  record.ttl = req.ttl;
+  record.operation = static_cast<uint8_t>(req.operation);
+  this->buffer_.push_back(record);
+  this->record_count_++;
+
+  if (this->buffer_.size() == kWriteBatchRecords)
+    return this->FlushRecords();
+  return true;
+}
+
+bool TraceBinaryWriter::FlushRecords()
+{
+  size_t written = fwrite(this->buffer_.data(), sizeof(TraceBinaryRecord), this->buffer_.size(), this->file_);
+  bool ok = (written == this->buffer_.size());
+  this->buffer_.clear();
+  if (!ok)
+    YCSB_C_LOG_ERROR("Error writing binary trace file: %s", this->path_.c_str());
+  return ok;
+}
+
+bool TraceBinaryWriter::Close()
+{
+  if (!this->file_)
+    return false;
+  bool ok = this->FlushRecords();
+
+  TraceBinaryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kTraceBinaryMagic, sizeof(header.magic));
+  header.version = kTraceBinaryVersion;
+  header.record_size = sizeof(TraceBinaryRecord);
+  header.record_count = this->record_count_;
+  header.key_count = this->keys_.Size();
+  header.chunk_records = this->chunk_records_;
+  header.chunk_count = this->chunk_offsets_.size();
+  header.records_offset = sizeof(TraceBinaryHeader);
+  // 记录为 32 字节，其后的偏移数组自然 8 字节对齐
+  header.chunk_offsets_offset = header.records_offset + header.record_count * sizeof(TraceBinaryRecord);
+  header.key_offsets_offset = header.chunk_offsets_offset + header.chunk_count * sizeof(uint64_t);
+  header.key_bytes_offset = header.key_offsets_offset + (header.key_count + 1) * sizeof(uint64_t);
+
+  std::vector<uint64_t> key_offsets;
+  key_offsets.reserve(this->keys_.Size() + 1);
+  uint64_t key_bytes = 0;
+  for (size_t i = 0; i < this->keys_.Size(); i++)
+  {
+    key_offsets.push_back(key_bytes);
+    key_bytes += this->keys_.Get(i).size();
+  }
+  key_offsets.push_back(key_bytes);
+  header.key_bytes_size = key_bytes;
+
+  ok = ok && fwrite(this->chunk_offsets_.data(), sizeof(uint64_t), this->chunk_offsets_.size(), this->file_) == this->chunk_offsets_.size();
+  ok = ok && fwrite(key_offsets.data(), sizeof(uint64_t), key_offsets.size(), this->file_) == key_offsets.size();
+  for (size_t i = 0; i < this->keys_.Size(); i++)
+  {
+    std::string_view key = this->keys_.Get(i);
+    ok = ok && fwrite(key.data(), 1, key.size(), this->file_) == key.size();
+  }
+  ok = ok && fseek(this->file_, 0, SEEK_SET) == 0;
+  ok = ok && fwrite(&header, sizeof(header), 1, this->file_) == 1;
+  ok = (fclose(this->file_) == 0) && ok;
+  this->file_ = nullptr;
+  if (!ok)
+    YCSB_C_LOG_ERROR("Error writing binary trace file: %s", this->path_.c_str());
+  return ok;
+}
+
+TraceBinaryFile::~TraceBinaryFile()
+{
+  this->Close();
+}
+
+bool TraceBinaryFile::IsBinaryTrace(const std::string& path)
+{
+  char magic[sizeof(kTraceBinaryMagic)];
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  bool is_binary = fread(magic, sizeof(magic), 1, file) == 1 &&
+                   std::memcmp(magic, kTraceBinaryMagic, sizeof(magic)) == 0;
+  fclose(file);
+  return is_binary;
+}
+
+bool TraceBinaryFile::Open(const std::string& path)
+{
+  this->Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    YCSB_C_LOG_ERROR("Error opening binary trace file: %s", path.c_str());
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TraceBinaryHeader))
+  {
+    YCSB_C_LOG_ERROR("Invalid binary trace file: %s", path.c_str());
+    close(fd);
+    return false;
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+  {
+    YCSB_C_LOG_ERROR("Error mapping binary trace file: %s", path.c_str());
+    return false;
+  }
+  this->data_ = static_cast<const char*>(addr);
+  this->size_ = size;
+
+  // 校验文件头与各段边界
+  const TraceBinaryHeader* header = reinterpret_cast<const TraceBinaryHeader*>(this->data_);
+  if (std::memcmp(header->magic, kTraceBinaryMagic, sizeof(header->magic)) == 0 &&
+      header->version != kTraceBinaryVersion)
+  {
+    YCSB_C_LOG_ERROR("Binary trace %s has version %u, expected %u; convert the text trace again",
+                     path.c_str(), header->version, kTraceBinaryVersion);
+    this->Close();
+    return false;
+  }
+  bool valid = std::memcmp(header->magic, kTraceBinaryMagic, sizeof(header->magic)) == 0 &&
+               header->version == kTraceBinaryVersion &&
+               header->record_size == sizeof(TraceBinaryRecord) &&
+               header->records_offset + header->record_count * sizeof(TraceBinaryRecord) <= header->chunk_offsets_offset &&
+               header->chunk_offsets_offset + header->chunk_count * sizeof(uint64_t) <= header->key_offsets_offset &&
+               header->key_offsets_offset + (header->key_count + 1) * sizeof(uint64_t) <= header->key_bytes_offset &&
+               header->key_bytes_offset + header->key_bytes_size <= size;
+  if (!valid)
+  {
+    YCSB_C_LOG_ERROR("Invalid binary trace file: %s", path.c_str());
+    this->Close();
+    return false;
+  }
+  this->header_ = header;
+  this->records_ = reinterpret_cast<const TraceBinaryRecord*>(this->data_ + header->records_offset);
+  this->chunk_offsets_ = reinterpret_cast<const uint64_t*>(this->data_ + header->chunk_offsets_offset);
+  this->key_offsets_ = reinterpret_cast<const uint64_t*>(this->data_ + header->key_offsets_offset);
+  this->key_bytes_ = this->data_ + header->key_bytes_offset;
+
+  // 校验 Key 字典偏移单调且不越界，以及每条记录的 key_id 都在字典范围内；
+  // 读取时按 key_id 直接索引，不再逐次检查
+  for (uint64_t id = 0; valid && id < header->key_count; id++)
+    valid = this->key_offsets_[id] <= this->key_offsets_[id + 1];
+  valid = valid && this->key_offsets_[header->key_count] <= header->key_bytes_size;
+  for (uint64_t i = 0; valid && i < header->record_count; i++)
+    valid = this->records_[i].key_id < header->key_count;
+  if (!valid)
+  {
+    YCSB_C_LOG_ERROR("Invalid binary trace file: %s (key dictionary or key id out of range)", path.c_str());
+    this->Close();
+    return false;
+  }
+  return true;
+}
+
+void TraceBinaryFile::Close()
+{
+  if (this->data_)
+    munmap(const_cast<char*>(this->data_), this->size_);
+  this->data_ = nullptr;
+  this->size_ = 0;
+  this->header_ = nullptr;
+  this->records_ = nullptr;
+  this->chunk_offsets_ = nullptr;
+  this->key_offsets_ = nullptr;
+  this->key_bytes_ = nullptr;
+}
+
+void TraceBinaryFile::GetRequest(const uint64_t index, Request& req) const
+{
+  const TraceBinaryRecord& record = this->records_[index];
+  req.timestamp = record.timestamp;
+  req.anonymized_key = this->GetKey(record.key_id);
+  req.key_id = record.key_id;
+  req.key_size = record.key_size;
+  req.value_size = record.value_size;
+  req.client_id = record.client_id;
+  req.operation = static_cast<TwitterTraceOperation>(record.operation);
+  req.ttl = record.ttl;
+}
+
+}
@@ -0,0 +1,146 @@
+#ifndef _TWITTER_TRACE_BINARY_H_
+#define _TWITTER_TRACE_BINARY_H_
+
+#include <cstdio>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "twitter_trace_reader.h"
+
+/**
+ * Twitter Cache-trace 二进制格式
+ * 文本 Trace 每次运行都要重新解析，且比所需大 3~4 倍；二进制格式将 Key 收进字典，
+ * 请求为定长记录，可直接 mmap 使用，启动近乎瞬时，且多次运行共享页缓存。
+ * 由 twitter_trace_converter <trace.csv> <trace.bin> [分隔符] [分块记录数] 转换；tracefile 指向二进制文件时
+ * TwitterTraceReader 按魔数识别并直接映射，无需解析。版本不符的旧文件需重新转换
+ *
+ * 文件布局（本机字节序）：
+ *   TraceBinaryHeader
+ *   TraceBinaryRecord[record_count]
+ *   uint64_t chunk_offsets[chunk_count]   每 chunk_records 条记录一个分块，值为分块首条记录的文件偏移
+ *   uint64_t key_offsets[key_count + 1]   Key i 位于 key_bytes[key_offsets[i], key_offsets[i + 1])
+ *   char key_bytes[key_bytes_size]
+ */
+
+namespace module
+{
+
+struct TraceBinaryHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t record_count;
+  uint64_t key_count;
+  uint64_t chunk_records;
+  uint64_t chunk_count;
+  uint64_t records_offset;
+  uint64_t chunk_offsets_offset;
+  uint64_t key_offsets_offset;
+  uint64_t key_bytes_offset;
+  uint64_t key_bytes_size;
+  uint64_t reserved;
+};
+
+struct TraceBinaryRecord
+{
+  uint32_t timestamp;
+  uint32_t key_id;
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t client_id;
+  uint32_t ttl;
+  uint8_t operation;
+  uint8_t reserved[7];
+};
+
+static_assert(sizeof(TraceBinaryHeader) == 96, "unexpected TraceBinaryHeader layout");
+static_assert(sizeof(TraceBinaryRecord) == 32, "unexpected TraceBinaryRecord layout");
+
+static const char kTraceBinaryMagic[8] = {'T', 'W', 'T', 'R', 'B', 'I', 'N', '\0'};
+// 版本 2：记录增加 client_id（32 字节）
+static const uint32_t kTraceBinaryVersion = 2;
+// 默认每个分块的记录数
+static const uint64_t kTraceBinaryChunkRecords = 1 << 20;
+
+/**
+ * 顺序写出二进制 Trace：记录边追加边写出，只有 Key 字典常驻内存
+ */
+class TraceBinaryWriter
+{
+private:
+  FILE* file_ = nullptr;
+  std::string path_;
+  uint64_t chunk_records_;
+  uint64_t record_count_ = 0;
+  // Key --> id
+  TraceKeyDict keys_;
+  std::vector<uint64_t> chunk_offsets_;
+  std::vector<TraceBinaryRecord> buffer_;
+
+  bool FlushRecords();
+
+public:
+  TraceBinaryWriter(const uint64_t chunk_records = kTraceBinaryChunkRecords);
+  ~TraceBinaryWriter();
+
+  bool Open(const std::string& path);
+  bool Append(const Request& req);
+  // @brief 写出分块偏移、Key 字典与文件头
+  bool Close();
+
+  uint64_t GetRecordCount() const { return this->record_count_; }
+  uint64_t GetKeyCount() const { return this->keys_.Size(); }
+};
+
+/**
+ * 只读映射二进制 Trace（MAP_SHARED，多次运行共享页缓存）
+ */
+class TraceBinaryFile
+{
+private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  const TraceBinaryHeader* header_ = nullptr;
+  const TraceBinaryRecord* records_ = nullptr;
+  const uint64_t* chunk_offsets_ = nullptr;
+  const uint64_t* key_offsets_ = nullptr;
+  const char* key_bytes_ = nullptr;
+
+public:
+  TraceBinaryFile() {}
+  ~TraceBinaryFile();
+  TraceBinaryFile(const TraceBinaryFile&) = delete;
+  TraceBinaryFile& operator=(const TraceBinaryFile&) = delete;
+
+  // @brief 按文件头魔数判断是否为二进制 Trace
+  static bool IsBinaryTrace(const std::string& path);
+
+  bool Open(const std::string& path);
+  void Close();
+
+  uint64_t GetRecordCount() const { return this->header_ ? this->header_->record_count : 0; }
+  uint64_t GetKeyCount() const { return this->header_ ? this->header_->key_count : 0; }
+  uint64_t GetChunkRecords() const { return this->header_ ? this->header_->chunk_records : 0; }
+  uint64_t GetChunkCount() const { return this->header_ ? this->header_->chunk_count : 0; }
+  // @brief 分块首条记录（按记录下标）
+  const TraceBinaryRecord* GetChunk(const uint64_t chunk) const
+  {
+    return reinterpret_cast<const TraceBinaryRecord*>(this->data_ + this->chunk_offsets_[chunk]);
+  }
+
+  const TraceBinaryRecord& GetRecord(const uint64_t index) const { return this->records_[index]; }
+  std::string_view GetKey(const uint32_t key_id) const
+  {
+    return std::string_view(this->key_bytes_ + this->key_offsets_[key_id],
+                            this->key_offsets_[key_id + 1] - this->key_offsets_[key_id]);
+  }
+  // @brief 将第 index 条记录展开为 Request（Key 指向映射的文件，不拷贝）
+  void GetRequest(const uint64_t index, Request& req) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include "twitter_trace_reader.h"
+#include "twitter_trace_binary.h"
+#include "twitter_trace_source.h"
+#include "core/timer.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace module;
+
+// 每次解析的文本窗口大小，解析结果写出后即释放，内存占用与 Trace 长度无关（Key 字典除外）
+static const size_t kWindowBytes = 256 << 20;
+// 压缩或多文件输入每次读取的请求数
+static const size_t kWindowRequests = 1 << 22;
+
+void usage()
+{
+  std::cerr << "Usage: twitter_trace_converter <trace.csv> <trace.bin> [delimiter] [chunk_records] [merge]" << std::endl;
+  std::cerr << "  Convert a Twitter Cache-trace CSV into the binary trace format" << std::endl;
+  std::cerr << "  trace.csv:     a file, a comma-separated list or a glob; gzip / zstd input is decompressed" << std::endl;
+  std::cerr << "  delimiter:     field delimiter (default: ',')" << std::endl;
+  std::cerr << "  chunk_records: records per chunk (default: " << kTraceBinaryChunkRecords << ")" << std::endl;
+  std::cerr << "  merge:         concat | timestamp, how several input files are combined (default: concat)" << std::endl;
+}
+
+// @brief 压缩或多个输入文件：经 TraceRequestSource 读取（后台线程解压）后写出
+bool ConvertSource(const std::vector<std::string>& paths, const char delimiter, const bool merge_by_timestamp,
+                   TraceBinaryWriter& writer, size_t& line_cnt, size_t& input_bytes, bool& no_error)
+{
+  TraceRequestSource source(delimiter, merge_by_timestamp);
+  if (!source.Open(paths))
+    return false;
+  std::vector<Request> requests;
+  TraceKeyDict window_keys;
+  while (true)
+  {
+    requests.clear();
+    window_keys.Clear();
+    if (source.Read(requests, window_keys, kWindowRequests) == 0)
+      break;
+    for (const auto& req : requests)
+    {
+      if (!writer.Append(req))
+        return false;
+    }
+  }
+  line_cnt = source.GetLineCount();
+  input_bytes = source.GetByteCount();
+  no_error = source.NoError();
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Missing Argument" << std::endl;
+    usage();
+    exit(EXIT_FAILURE);
+  }
+  std::string input_path = argv[1];
+  std::string output_path = argv[2];
+  char delimiter = (argc > 3 && argv[3][0]) ? argv[3][0] : ',';
+  uint64_t chunk_records = (argc > 4) ? std::stoull(argv[4]) : kTraceBinaryChunkRecords;
+  std::string merge = (argc > 5) ? argv[5] : "concat";
+  if (merge != "concat" && merge != "timestamp")
+  {
+    std::cerr << "Unknown merge mode: " << merge << std::endl;
+    usage();
+    exit(EXIT_FAILURE);
+  }
+
+  utils::Timer timer;
+  std::vector<std::string> input_paths = ExpandTraceFiles(input_path);
+  if (input_paths.empty())
+  {
+    YCSB_C_LOG_ERROR("No trace file given: %s", input_path.c_str());
+    exit(EXIT_FAILURE);
+  }
+  if (input_paths.size() > 1 || DetectTraceCompression(input_paths[0]) != TraceCompression::NONE)
+  {
+    TraceBinaryWriter writer(chunk_records);
+    size_t line_cnt = 0;
+    size_t input_bytes = 0;
+    bool no_error = true;
+    if (!writer.Open(output_path) ||
+        !ConvertSource(input_paths, delimiter, merge == "timestamp", writer, line_cnt, input_bytes, no_error) ||
+        !writer.Close())
+      exit(EXIT_FAILURE);
+    struct stat out_st;
+    size_t output_size = (stat(output_path.c_str(), &out_st) == 0) ? static_cast<size_t>(out_st.st_size) : 0;
+    YCSB_C_LOG_INFO("Converted %lu requests (%lu keys, %zu lines) from %zu file(s) in %.3f s",
+                    writer.GetRecordCount(), writer.GetKeyCount(), line_cnt, input_paths.size(), timer.GetDurationSec());
+    YCSB_C_LOG_INFO("%s: %.1f MB (decompressed) --> %s: %.1f MB", input_path.c_str(), input_bytes / 1e6,
+                    output_path.c_str(), output_size / 1e6);
+    if (!no_error)
+      YCSB_C_LOG_ERROR("Some lines were skipped due to invalid format");
+    return no_error ? 0 : EXIT_FAILURE;
+  }
+  input_path = input_paths[0];
+
+  int fd = open(input_path.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    YCSB_C_LOG_ERROR("Error opening trace file: %s", input_path.c_str());
+    exit(EXIT_FAILURE);
+  }
+  size_t file_size = static_cast<size_t>(st.st_size);
+  const char* data = nullptr;
+  if (file_size > 0)
+  {
+    void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+      YCSB_C_LOG_ERROR("Error mapping trace file: %s", input_path.c_str());
+      exit(EXIT_FAILURE);
+    }
+    madvise(addr, file_size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(addr);
+  }
+  close(fd);
+
+  TraceBinaryWriter writer(chunk_records);
+  if (!writer.Open(output_path))
+    exit(EXIT_FAILURE);
+
+  bool no_error = true;
+  size_t line_cnt = 0;
+  size_t pos = 0;
+  std::vector<Request> requests;
+  // 窗口内的 Key 字典，写出后即清空（Writer 另有全局字典）
+  TraceKeyDict window_keys;
+  while (pos < file_size)
+  {
+    // 窗口按换行对齐
+    size_t end = std::min(file_size, pos + kWindowBytes);
+    if (end < file_size)
+    {
+      const char* nl = static_cast<const char*>(std::memchr(data + end, '\n', file_size - end));
+      end = nl ? nl - data + 1 : file_size;
+    }
+    requests.clear();
+    window_keys.Clear();
+    line_cnt += ParseTraceBuffer(data + pos, end - pos, delimiter, requests, window_keys, line_cnt + 1, no_error);
+    for (const auto& req : requests)
+    {
+      if (!writer.Append(req))
+        exit(EXIT_FAILURE);
+    }
+    // 已转换部分不再需要
+    madvise(const_cast<char*>(data + pos), end - pos, MADV_DONTNEED);
+    pos = end;
+  }
+  if (data)
+    munmap(const_cast<char*>(data), file_size);
+  if (!writer.Close())
+    exit(EXIT_FAILURE);
+
+  struct stat out_st;
+  size_t output_size = (stat(output_path.c_str(), &out_st) == 0) ? static_cast<size_t>(out_st.st_size) : 0;
+  YCSB_C_LOG_INFO("Converted %lu requests (%lu keys, %zu lines) in %.3f s",
+                  writer.GetRecordCount(), writer.GetKeyCount(), line_cnt, timer.GetDurationSec());
+  YCSB_C_LOG_INFO("%s: %.1f MB --> %s: %.1f MB", input_path.c_str(), file_size / 1e6,
+                  output_path.c_str(), output_size / 1e6);
+  if (!no_error)
+    YCSB_C_LOG_ERROR("Some lines were skipped due to invalid format");
+  return 0;
+}
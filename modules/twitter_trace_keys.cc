@@ -0,0 +1,109 @@
+#include "twitter_trace_keys.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace module
+{
+
+uint64_t TraceKeyDict::Hash(std::string_view key)
+{
+  // 按 8 字节读入做乘法混合，短 Key 比逐字节的哈希快得多
+  static const uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+  const char* p = key.data();
+  size_t len = key.size();
+  uint64_t h = len * kMul;
+  while (len >= 8)
+  {
+    uint64_t w;
+    std::memcpy(&w, p, 8);
+    h = (h ^ w) * kMul;
+    h ^= h >> 29;
+    p += 8;
+    len -= 8;
+  }
+  if (len)
+  {
+    uint64_t w = 0;
+    std::memcpy(&w, p, len);
+    h = (h ^ w) * kMul;
+    h ^= h >> 29;
+  }
+  h *= kMul;
+  return h ^ (h >> 32);
+}
+
+std::string_view TraceKeyDict::Store(std::string_view key)
+{
+  if (!this->copy_keys_)
+    return key;
+  // 当前块放不下时使用下一个足够大的已有块，否则新分配
+  while (this->block_idx_ < this->blocks_.size() &&
+         this->blocks_[this->block_idx_].second - this->block_used_ < key.size())
+  {
+    this->block_idx_++;
+    this->block_used_ = 0;
+  }
+  if (this->block_idx_ == this->blocks_.size())
+  {
+    size_t block_bytes = std::max(kBlockBytes, key.size());
+    this->blocks_.emplace_back(std::unique_ptr<char[]>(new char[block_bytes]), block_bytes);
+    this->block_used_ = 0;
+  }
+  char* dst = this->blocks_[this->block_idx_].first.get() + this->block_used_;
+  std::memcpy(dst, key.data(), key.size());
+  this->block_used_ += key.size();
+  this->arena_bytes_ += key.size();
+  return std::string_view(dst, key.size());
+}
+
+void TraceKeyDict::Rehash(const size_t slot_count)
+{
+  this->slots_.assign(slot_count, kNoKey);
+  size_t mask = slot_count - 1;
+  for (uint32_t id = 0; id < this->keys_.size(); id++)
+  {
+    size_t slot = this->hashes_[id] & mask;
+    while (this->slots_[slot] != kNoKey)
+      slot = (slot + 1) & mask;
+    this->slots_[slot] = id;
+  }
+}
+
+uint32_t TraceKeyDict::Intern(std::string_view key, const uint64_t hash)
+{
+  if (this->slots_.empty())
+    this->Rehash(kMinSlots);
+  uint32_t h = static_cast<uint32_t>(hash);
+  size_t mask = this->slots_.size() - 1;
+  size_t slot = h & mask;
+  while (this->slots_[slot] != kNoKey)
+  {
+    uint32_t id = this->slots_[slot];
+    if (this->hashes_[id] == h && this->keys_[id] == key)
+      return id;
+    slot = (slot + 1) & mask;
+  }
+  if (this->keys_.size() == kNoKey)
+    return kNoKey;
+
+  uint32_t id = static_cast<uint32_t>(this->keys_.size());
+  this->keys_.push_back(this->Store(key));
+  this->hashes_.push_back(h);
+  this->slots_[slot] = id;
+  if (this->keys_.size() * 2 > this->slots_.size())
+    this->Rehash(this->slots_.size() * 2);
+  return id;
+}
+
+void TraceKeyDict::Clear()
+{
+  this->block_idx_ = 0;
+  this->block_used_ = 0;
+  this->arena_bytes_ = 0;
+  this->keys_.clear();
+  this->hashes_.clear();
+  std::fill(this->slots_.begin(), this->slots_.end(), kNoKey);
+}
+
+}
@@ -0,0 +1,70 @@
+#ifndef _TWITTER_TRACE_KEYS_H_
+#define _TWITTER_TRACE_KEYS_H_
+
+#include <memory>
+#include <stdint.h>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Trace Key 字典
+ * 每个不同的 Key 只在连续的 arena 中保存一份，按首次出现的顺序分配 32 位 id；
+ * Request 只保存 id 与指向 arena 的 string_view，不再各自持有 std::string
+ * （二进制 Trace 时直接指向映射的文件，流式读取时每个缓冲区一个字典随分块复用）。
+ * 查找使用开放寻址的扁平哈希表（只存 id），插入不分配节点；
+ * 并行解析时各分片先在本地分配 id，再按分片顺序合并，id 仍按首次出现的顺序分配
+ */
+
+namespace module
+{
+
+class TraceKeyDict
+{
+private:
+  // arena 按块分配，块地址不变，已返回的 string_view 始终有效
+  static constexpr size_t kBlockBytes = 1 << 20;
+  static constexpr size_t kMinSlots = 1 << 10;
+
+  // 为 false 时不拷贝 Key，string_view 直接指向调用者的缓冲区
+  bool copy_keys_;
+  std::vector<std::pair<std::unique_ptr<char[]>, size_t>> blocks_;
+  size_t block_idx_ = 0;
+  size_t block_used_ = 0;
+  size_t arena_bytes_ = 0;
+
+  std::vector<std::string_view> keys_;
+  std::vector<uint32_t> hashes_;
+  // 槽位存 id，kNoKey 表示空；负载不超过 1/2
+  std::vector<uint32_t> slots_;
+
+  std::string_view Store(std::string_view key);
+  void Rehash(const size_t slot_count);
+
+public:
+  static constexpr uint32_t kNoKey = UINT32_MAX;
+
+  explicit TraceKeyDict(const bool copy_keys = true) : copy_keys_(copy_keys) {}
+  TraceKeyDict(TraceKeyDict&&) = default;
+  TraceKeyDict& operator=(TraceKeyDict&&) = default;
+  TraceKeyDict(const TraceKeyDict&) = delete;
+  TraceKeyDict& operator=(const TraceKeyDict&) = delete;
+
+  static uint64_t Hash(std::string_view key);
+
+  // @brief 返回 Key 的 id，首次出现时拷贝到 arena；id 用尽时返回 kNoKey
+  uint32_t Intern(std::string_view key) { return this->Intern(key, Hash(key)); }
+  uint32_t Intern(std::string_view key, const uint64_t hash);
+  std::string_view Get(const uint32_t id) const { return this->keys_[id]; }
+  // @brief Key 的哈希值（低 32 位）
+  uint32_t GetHash(const uint32_t id) const { return this->hashes_[id]; }
+  size_t Size() const { return this->keys_.size(); }
+  // @brief arena 中的 Key 字节数
+  size_t GetArenaBytes() const { return this->arena_bytes_; }
+  // @brief 清空字典，保留已分配的块以便复用（之前返回的 string_view 随之失效）
+  void Clear();
+};
+
+}
+
+#endif
@@ -1,4 +1,16 @@
 #include "twitter_trace_reader.h"
+#include "twitter_trace_binary.h"
+#include "twitter_trace_stream.h"
+#include "twitter_trace_source.h"
+#include "core/timer.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <sys/stat.h>
+#include <thread>
 
 namespace module
 {
@@ -41,12 +53,18 @@ TwitterTraceReader::TwitterTraceReader(const std::string& trace_file_path,
 }
 
 TwitterTraceReader::TwitterTraceReader(const std::string& trace_file_path, const size_t thread_count, 
-                                       const size_t limit_record_count, const size_t limit_operation_count)
+                                       const size_t limit_record_count, const size_t limit_operation_count,
+                                       const size_t stream_chunk_requests, const size_t stream_buffer_count,
+                                       const bool merge_by_timestamp, const double sample_rate)
   : thread_count_(thread_count), thread_local_index_(thread_count),
-    limit_record_count_(limit_record_count), limit_operation_count_(limit_operation_count)
+    limit_record_count_(limit_record_count), limit_operation_count_(limit_operation_count),
+    stream_chunk_requests_(stream_chunk_requests), stream_buffer_count_(stream_buffer_count),
+    merge_by_timestamp_(merge_by_timestamp), sampler_(sample_rate)
 
 {
   YCSB_C_LOG_INFO("Twitter Cache-trace reader with multi-thread: %zu", thread_count_);
+  if (this->sampler_.enabled())
+    YCSB_C_LOG_INFO("Sampling trace keys by hash at rate %g", this->sampler_.rate());
 
   if (this->ReadTraceFile(trace_file_path))
     YCSB_C_LOG_INFO("Read trace file: %s completed", trace_file_path.c_str());
@@ -58,89 +76,656 @@ TwitterTraceReader::TwitterTraceReader(const std::string& trace_file_path, const
     index.store(0, std::memory_order_relaxed);
 }
 
-bool TwitterTraceReader::ReadTraceFile(const std::string& trace_file_path, const char delimiter)
+namespace
 {
-  std::ifstream trace_file(trace_file_path);
-  if (!trace_file.is_open())
-  {
-    YCSB_C_LOG_ERROR("Error opening trace file: %s", trace_file_path.c_str());
+
+// 每个解析线程至少处理的字节数，避免小文件切得过碎
+const size_t kMinChunkBytes = 1 << 20;
+
+struct ParsedChunk
+{
+  std::vector<Request> requests;
+  // 分片内的行数（含空行）
+  size_t line_count = 0;
+  // 格式错误的行：分片内行号与行内容
+  std::vector<std::pair<size_t, std::string>> errors;
+  // 分片内的 Key 字典（指向被解析的缓冲区，不拷贝），合并时收进全局字典
+  TraceKeyDict keys{false};
+};
+
+// 手写的无符号整数解析，与 std::stoul 一致：跳过前导空白，至少一位数字，忽略其后内容；
+// 超出 T 的范围时视为格式错误，而不是截断
+template <typename T>
+bool ParseUint(const char* begin, const char* end, T& value)
+{
+  while (begin < end && (*begin == ' ' || *begin == '\t'))
+    begin++;
+  if (begin == end || *begin < '0' || *begin > '9')
     return false;
+  const uint64_t max = std::numeric_limits<T>::max();
+  uint64_t v = 0;
+  for (; begin < end && *begin >= '0' && *begin <= '9'; begin++)
+  {
+    uint64_t digit = *begin - '0';
+    if (v > (max - digit) / 10)
+      return false;
+    v = v * 10 + digit;
   }
+  value = static_cast<T>(v);
+  return true;
+}
 
-  std::string line;
+// 日志中的吞吐量；耗时过短计为 0 时不做除法
+double PerSecond(double amount, double duration)
+{
+  return duration > 0 ? amount / duration : 0;
+}
+
+TwitterTraceOperation ParseOperation(const char* begin, const char* end)
+{
+  // 与 g_op_map 相同的映射，直接比较字节避免构造 std::string
+  static const std::pair<const char*, TwitterTraceOperation> kOps[] = {
+    {"get", GET}, {"gets", GETS}, {"set", SET}, {"add", ADD},
+    {"replace", REPLACE}, {"cas", CAS}, {"append", APPEND}, {"prepend", PREPEND},
+    {"delete", DELETE}, {"incr", INCR}, {"decr", DECR}
+  };
+  size_t len = end - begin;
+  for (const auto& op : kOps)
+  {
+    if (std::strlen(op.first) == len && std::memcmp(op.first, begin, len) == 0)
+      return op.second;
+  }
+  // default: SET
+  return TwitterTraceOperation::SET;
+}
+
+// 解析 [begin, end) 内的完整行；以 memchr（glibc 中为 SIMD 实现）查找换行与分隔符
+void ParseChunk(const char* begin, const char* end, const char delimiter, const utils::KeySampler* sampler,
+                ParsedChunk& chunk)
+{
+  const char* line = begin;
+  while (line < end)
+  {
+    const char* line_end = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    if (!line_end)
+      line_end = end;
+    chunk.line_count++;
+    if (line_end > line)
+    {
+      // 只需前 7 个字段
+      const char* fields[8];
+      size_t field_cnt = 0;
+      const char* field = line;
+      while (field_cnt < 7)
+      {
+        fields[field_cnt++] = field;
+        const char* next = static_cast<const char*>(std::memchr(field, delimiter, line_end - field));
+        if (!next)
+          break;
+        field = next + 1;
+      }
+      Request req;
+      bool valid = false;
+      bool sampled = true;
+      if (field_cnt == 7)
+      {
+        const char* field_end[6];
+        for (size_t i = 0; i < 6; i++)
+          field_end[i] = fields[i + 1] - 1;
+        // anonymized_key field：按 Key 哈希采样，采中的先分配分片内的 id
+        std::string_view key(fields[1], field_end[1] - fields[1]);
+        uint64_t hash = TraceKeyDict::Hash(key);
+        sampled = !sampler || sampler->Sampled(hash);
+        if (sampled)
+          req.key_id = chunk.keys.Intern(key, hash);
+        // key_size, value_size field
+        valid = sampled && ParseUint(fields[2], field_end[2], req.key_size) &&
+                ParseUint(fields[3], field_end[3], req.value_size);
+        // operation field (default: SET)
+        req.operation = ParseOperation(fields[5], field_end[5]);
+        // timestamp, client_id, ttl field（缺省为 0）
+        if (!ParseUint(fields[0], field_end[0], req.timestamp))
+          req.timestamp = 0;
+        if (!ParseUint(fields[4], field_end[4], req.client_id))
+          req.client_id = 0;
+        if (!ParseUint(fields[6], line_end, req.ttl))
+          req.ttl = 0;
+      }
+      if (valid)
+        chunk.requests.push_back(std::move(req));
+      else if (sampled)
+        chunk.errors.emplace_back(chunk.line_count, std::string(line, line_end - line));
+    }
+    line = line_end + 1;
+  }
+}
+
+}
+
+size_t ParseTraceBuffer(const char* data, const size_t size, const char delimiter,
+                        std::vector<Request>& requests, TraceKeyDict& keys,
+                        const size_t first_line, bool& no_error, const utils::KeySampler* sampler)
+{
+  // 按换行对齐切分，多线程并行解析
+  size_t chunk_num = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(),
+                                                          size / kMinChunkBytes));
+  std::vector<size_t> bounds(chunk_num + 1, size);
+  bounds[0] = 0;
+  for (size_t i = 1; i < chunk_num; i++)
+  {
+    size_t pos = std::max(bounds[i - 1], size / chunk_num * i);
+    const char* nl = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+    bounds[i] = nl ? nl - data + 1 : size;
+  }
+  std::vector<ParsedChunk> chunks(chunk_num);
+  std::vector<std::thread> parsers;
+  for (size_t i = 0; i < chunk_num; i++)
+    parsers.emplace_back(ParseChunk, data + bounds[i], data + bounds[i + 1], delimiter, sampler, std::ref(chunks[i]));
+  for (auto& parser : parsers)
+    parser.join();
+
+  // 按分片顺序合并，保持 Trace 中的请求顺序；分片内的 Key 依次收进全局字典，id 仍按首次出现的顺序分配
   size_t line_cnt = 0;
-  bool no_error = true;
-  size_t max_read_line_cnt = 0;
-  // 节约内存资源，只读取指定范围的 trace
-  if ((this->limit_record_count_ || this->limit_operation_count_))
-    max_read_line_cnt = std::max(this->limit_record_count_, this->limit_operation_count_);
-  while (std::getline(trace_file, line))
+  size_t request_cnt = 0;
+  for (const auto& chunk : chunks)
+    request_cnt += chunk.requests.size();
+  requests.reserve(requests.size() + request_cnt);
+  std::vector<uint32_t> key_map;
+  for (auto& chunk : chunks)
   {
-    if (line_cnt >= max_read_line_cnt)
-      break;
-    
-    line_cnt++;
-    if (line.empty())
-      continue;
-    // split by delimiter
-    std::vector<std::string> fields;
-    std::stringstream ss(line);
-    std::string field;
-    while (std::getline(ss, field, delimiter))
-      fields.push_back(field);
-    // parse the fields string
-    if (fields.size() < 7)
+    for (const auto& error : chunk.errors)
     {
-      YCSB_C_LOG_ERROR("Invalid line format at %zu: %s", line_cnt, line.c_str());
+      YCSB_C_LOG_ERROR("Invalid line format at %zu: %s", first_line + line_cnt + error.first - 1, error.second.c_str());
       no_error = false;
-      continue;
     }
-    try
+    line_cnt += chunk.line_count;
+
+    key_map.resize(chunk.keys.Size());
+    for (uint32_t i = 0; i < chunk.keys.Size(); i++)
+      key_map[i] = keys.Intern(chunk.keys.Get(i), chunk.keys.GetHash(i));
+    // 字典已满时只跳过新 Key 的请求，分片中已有 Key 的请求照常保留
+    size_t dropped = 0;
+    for (auto& req : chunk.requests)
     {
-      Request req;
-      // timestamp field
-      // req.timestamp = static_cast<uint64_t>(std::stoul(fields[0]));
-      // anonymized_key field
-      req.anonymized_key = fields[1];
-      // key_size field
-      req.key_size = static_cast<uint32_t>(std::stoul(fields[2]));
-      // value_size field
-      req.value_size = static_cast<uint32_t>(std::stoul(fields[3]));
-      // client_id field
-      // req.client_id = static_cast<uint32_t>(std::stoul(fields[4]));
-      // operation field (default: SET)
-      auto op_iter = g_op_map.find(fields[5]);
-      req.operation = (op_iter != g_op_map.end()) 
-          ? op_iter->second 
-          : TwitterTraceOperation::SET;
-      // ttl field
-      // req.ttl = static_cast<uint32_t>(std::stoul(fields[6]));
-      this->trace_requests_.push_back(req);
+      req.key_id = key_map[req.key_id];
+      if (req.key_id == TraceKeyDict::kNoKey)
+      {
+        dropped++;
+        continue;
+      }
+      req.anonymized_key = keys.Get(req.key_id);
+      requests.push_back(req);
     }
-    catch(const std::exception& e)
+    if (dropped)
     {
-      YCSB_C_LOG_ERROR("Parse line error: %s, at %zu: %s", e.what(), line_cnt, line.c_str());
+      YCSB_C_LOG_ERROR("Too many distinct keys in trace: %zu, skipped %zu requests", keys.Size(), dropped);
       no_error = false;
     }
-    
+    std::vector<Request>().swap(chunk.requests);
+  }
+  return line_cnt;
+}
+
+TwitterTraceReader::~TwitterTraceReader() {}
+
+bool TwitterTraceReader::ReadTraceFile(const std::string& trace_file_path, const char delimiter)
+{
+  std::vector<std::string> paths = ExpandTraceFiles(trace_file_path);
+  if (paths.empty())
+  {
+    YCSB_C_LOG_ERROR("No trace file given: %s", trace_file_path.c_str());
+    return false;
+  }
+  if (paths.size() == 1 && TraceBinaryFile::IsBinaryTrace(paths[0]))
+  {
+    if (this->stream_chunk_requests_)
+      YCSB_C_LOG_INFO("Binary trace is mapped on demand, streaming is not needed");
+    return this->ReadBinaryTraceFile(paths[0]);
+  }
+  for (const auto& path : paths)
+  {
+    if (TraceBinaryFile::IsBinaryTrace(path))
+    {
+      YCSB_C_LOG_ERROR("Binary trace %s cannot be combined with other trace files", path.c_str());
+      return false;
+    }
+  }
+  if (this->stream_chunk_requests_)
+    return this->ReadTraceStream(paths, delimiter);
+  // 单个未压缩的文件直接 mmap 并行解析
+  if (paths.size() == 1 && DetectTraceCompression(paths[0]) == TraceCompression::NONE)
+    return this->ReadPlainTraceFile(paths[0], delimiter);
+  return this->ReadTraceSource(paths, delimiter);
+}
+
+bool TwitterTraceReader::ReadPlainTraceFile(const std::string& trace_file_path, const char delimiter)
+{
+  utils::Timer timer;
+  int fd = open(trace_file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    YCSB_C_LOG_ERROR("Error opening trace file: %s", trace_file_path.c_str());
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+  {
+    YCSB_C_LOG_ERROR("Error opening trace file: %s", trace_file_path.c_str());
+    close(fd);
+    return false;
+  }
+  size_t file_size = static_cast<size_t>(st.st_size);
+  const char* data = nullptr;
+  if (file_size > 0)
+  {
+    void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+      YCSB_C_LOG_ERROR("Error mapping trace file: %s", trace_file_path.c_str());
+      close(fd);
+      return false;
+    }
+    madvise(addr, file_size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(addr);
   }
+  close(fd);
 
+  // 节约内存资源，只读取指定范围的 trace（0 表示不限制）：先定位到第 N 行末尾
+  size_t parse_size = file_size;
+  size_t max_read_line_cnt = std::max(this->limit_record_count_, this->limit_operation_count_);
+  if (max_read_line_cnt)
+  {
+    const char* pos = data;
+    const char* end = data + file_size;
+    for (size_t i = 0; i < max_read_line_cnt && pos < end; i++)
+    {
+      const char* nl = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+      pos = nl ? nl + 1 : end;
+    }
+    parse_size = pos - data;
+  }
+
+  bool no_error = true;
+  size_t request_cnt = this->trace_requests_.size();
+  size_t line_cnt = ParseTraceBuffer(data, parse_size, delimiter, this->trace_requests_, this->trace_keys_, 1, no_error,
+                                   this->GetSampler());
+  request_cnt = this->trace_requests_.size() - request_cnt;
+  if (data)
+    munmap(const_cast<char*>(data), file_size);
+
+  double duration = timer.GetDurationSec();
   YCSB_C_LOG_INFO("Read completed, total line count: %zu", line_cnt);
+  YCSB_C_LOG_INFO("Interned %zu distinct keys in %.1f MB", this->trace_keys_.Size(),
+                  this->trace_keys_.GetArenaBytes() / 1e6);
+  YCSB_C_LOG_INFO("Parsed %zu requests from %.1f MB in %.3f s: %.1f MB/s, %.0f requests/s",
+                  request_cnt, parse_size / 1e6, duration,
+                  PerSecond(parse_size / 1e6, duration), PerSecond(request_cnt, duration));
   // set iterator
   this->trace_iter_ = this->trace_requests_.begin();
   this->read_succeeded_ = no_error;
   return no_error;
 }
 
+bool TwitterTraceReader::ReadTraceSource(const std::vector<std::string>& paths, const char delimiter)
+{
+  utils::Timer timer;
+  // 只读取指定范围的 trace（0 表示不限制），与整体读入一致按采样前的请求数计
+  TraceRequestSource source(delimiter, this->merge_by_timestamp_, this->GetSampler(),
+                            std::max(this->limit_record_count_, this->limit_operation_count_));
+  if (!source.Open(paths))
+    return false;
+  YCSB_C_LOG_INFO("Reading %zu trace file(s), %s", paths.size(),
+                  this->merge_by_timestamp_ ? "merged by timestamp" : "concatenated");
+
+  size_t request_cnt = this->trace_requests_.size();
+  while (source.Read(this->trace_requests_, this->trace_keys_, TraceRequestSource::kBlockBytes / 64) != 0)
+  {
+  }
+  request_cnt = this->trace_requests_.size() - request_cnt;
+
+  double duration = timer.GetDurationSec();
+  size_t bytes = source.GetByteCount();
+  YCSB_C_LOG_INFO("Read completed, total line count: %zu", source.GetLineCount());
+  YCSB_C_LOG_INFO("Interned %zu distinct keys in %.1f MB", this->trace_keys_.Size(),
+                  this->trace_keys_.GetArenaBytes() / 1e6);
+  YCSB_C_LOG_INFO("Parsed %zu requests from %.1f MB (decompressed) in %.3f s: %.1f MB/s, %.0f requests/s",
+                  request_cnt, bytes / 1e6, duration, PerSecond(bytes / 1e6, duration),
+                  PerSecond(request_cnt, duration));
+  this->trace_iter_ = this->trace_requests_.begin();
+  this->read_succeeded_ = source.NoError();
+  return this->read_succeeded_;
+}
+
+bool TwitterTraceReader::ReadBinaryTraceFile(const std::string& trace_file_path)
+{
+  utils::Timer timer;
+  this->binary_trace_.reset(new TraceBinaryFile());
+  if (!this->binary_trace_->Open(trace_file_path))
+  {
+    this->binary_trace_.reset();
+    return false;
+  }
+  // 只使用指定范围的 trace（0 表示不限制）
+  this->binary_request_count_ = this->binary_trace_->GetRecordCount();
+  size_t max_read_line_cnt = std::max(this->limit_record_count_, this->limit_operation_count_);
+  if (max_read_line_cnt)
+    this->binary_request_count_ = std::min(this->binary_request_count_, max_read_line_cnt);
+  this->binary_slots_.resize(std::max<size_t>(this->thread_local_index_.size(), 1));
+  if (this->sampler_.enabled())
+    this->SampleBinaryRecords();
+
+  YCSB_C_LOG_INFO("Mapped binary trace: %zu requests, %lu keys, %lu chunks in %.3f s",
+                  this->binary_request_count_, this->binary_trace_->GetKeyCount(),
+                  this->binary_trace_->GetChunkCount(), timer.GetDurationSec());
+  this->trace_iter_ = this->trace_requests_.begin();
+  this->read_succeeded_ = true;
+  return true;
+}
+
+void TwitterTraceReader::SampleBinaryRecords()
+{
+  // 每个 Key 只算一次哈希，采中的记录下标按原顺序保存
+  std::vector<uint8_t> key_sampled(this->binary_trace_->GetKeyCount(), 0);
+  for (uint32_t id = 0; id < key_sampled.size(); id++)
+    key_sampled[id] = this->sampler_.Sampled(TraceKeyDict::Hash(this->binary_trace_->GetKey(id)));
+  this->binary_index_.clear();
+  for (uint64_t i = 0; i < this->binary_request_count_; i++)
+  {
+    if (key_sampled[this->binary_trace_->GetRecord(i).key_id])
+      this->binary_index_.push_back(i);
+  }
+  YCSB_C_LOG_INFO("Sampled %zu of %zu binary trace records", this->binary_index_.size(), this->binary_request_count_);
+  this->binary_request_count_ = this->binary_index_.size();
+}
+
+bool TwitterTraceReader::ReadTraceStream(const std::vector<std::string>& paths, const char delimiter)
+{
+  this->stream_.reset(new TraceStream(this->stream_chunk_requests_, this->stream_buffer_count_, delimiter,
+                                      this->GetSampler()));
+  size_t max_read_line_cnt = std::max(this->limit_record_count_, this->limit_operation_count_);
+  bool opened = (paths.size() == 1 && DetectTraceCompression(paths[0]) == TraceCompression::NONE) ?
+                this->stream_->Open(paths[0], max_read_line_cnt) :
+                this->stream_->Open(paths, this->merge_by_timestamp_, max_read_line_cnt);
+  if (!opened)
+  {
+    this->stream_.reset();
+    return false;
+  }
+  this->stream_->Start([this] { return this->GetLowWatermark(); });
+  this->trace_iter_ = this->trace_requests_.begin();
+  this->read_succeeded_ = true;
+  return true;
+}
+
+size_t TwitterTraceReader::GetLowWatermark() const
+{
+  size_t low = SIZE_MAX;
+  if (this->UsesCursors())
+  {
+    for (size_t thread_id = 0; thread_id < this->thread_count_; thread_id++)
+      low = std::min(low, this->batch_cursors_[thread_id].in_use.load(std::memory_order_acquire));
+    return low;
+  }
+  // 线程当前请求为 (index - 1) * thread_count_ + thread_id，尚未取过请求时为其第一条
+  for (size_t thread_id = 0; thread_id < this->thread_local_index_.size(); thread_id++)
+  {
+    size_t index = this->thread_local_index_[thread_id].load(std::memory_order_acquire);
+    size_t in_use = (index ? (index - 1) * this->thread_count_ : 0) + thread_id;
+    low = std::min(low, in_use);
+  }
+  return low;
+}
+
+void TwitterTraceReader::SetBatchReplay(const size_t batch_size)
+{
+  this->batch_size_ = batch_size;
+  this->batch_cursors_.reset(batch_size ? new BatchCursor[this->thread_count_] : nullptr);
+  YCSB_C_LOG_INFO("Order-preserving replay: threads claim %zu consecutive requests at a time", batch_size);
+}
+
+void TwitterTraceReader::SetPartition(const TracePartition partition)
+{
+  this->partition_ = partition;
+  if (partition == TracePartition::STRIDE)
+    return;
+  if (this->batch_size_)
+  {
+    YCSB_C_LOG_INFO("Trace partitioning replaces batched replay");
+    this->batch_size_ = 0;
+  }
+  this->batch_cursors_.reset(new BatchCursor[this->thread_count_]);
+  for (size_t thread_id = 0; thread_id < this->thread_count_; thread_id++)
+    this->batch_cursors_[thread_id].end = SIZE_MAX;
+  if (this->stream_)
+    this->stream_->SetOwner(this->thread_count_, [this](const Request& req) { return this->GetPartitionOwner(req); });
+  else
+    this->BuildPartitionIndex();
+  YCSB_C_LOG_INFO("Trace partitioned across threads by %s", partition == TracePartition::KEY ? "key hash" : "client_id");
+}
+
+size_t TwitterTraceReader::GetPartitionOwner(const Request& req) const
+{
+  if (this->partition_ == TracePartition::CLIENT)
+    return req.client_id % this->thread_count_;
+  return std::hash<std::string_view>()(req.anonymized_key) % this->thread_count_;
+}
+
+void TwitterTraceReader::BuildPartitionIndex()
+{
+  utils::Timer timer;
+  size_t count = this->GetRequestCount();
+  this->partition_owned_.assign(this->thread_count_, std::vector<size_t>());
+  for (auto& owned : this->partition_owned_)
+    owned.reserve(count / this->thread_count_ + 1);
+  for (size_t i = 0; i < count; i++)
+  {
+    // 二进制 Trace 直接读记录，与文本 Trace 的划分结果一致
+    size_t owner;
+    if (this->binary_trace_)
+    {
+      const TraceBinaryRecord& record = this->binary_trace_->GetRecord(this->BinaryRecordIndex(i));
+      owner = (this->partition_ == TracePartition::CLIENT ?
+               record.client_id % this->thread_count_ :
+               std::hash<std::string_view>()(this->binary_trace_->GetKey(record.key_id)) % this->thread_count_);
+    }
+    else
+    {
+      owner = this->GetPartitionOwner(this->trace_requests_[i]);
+    }
+    this->partition_owned_[owner].push_back(i);
+  }
+  YCSB_C_LOG_INFO("Partitioned %zu requests in %.3f s", count, timer.GetDurationSec());
+}
+
+size_t TwitterTraceReader::PeekPartitionIndex(const size_t thread_id)
+{
+  BatchCursor& cursor = this->batch_cursors_[thread_id];
+  if (cursor.next == cursor.end)
+    return cursor.next;
+  size_t limit = this->request_limit_ ? this->request_limit_ : SIZE_MAX;
+  if (!this->stream_)
+  {
+    // cursor.next 只在取走一条请求后加 1，owned_pos 每次至多前进一格
+    const std::vector<size_t>& owned = this->partition_owned_[thread_id];
+    while (cursor.owned_pos < owned.size() && owned[cursor.owned_pos] < cursor.next)
+      cursor.owned_pos++;
+    if (cursor.owned_pos < owned.size() && owned[cursor.owned_pos] < limit)
+    {
+      cursor.next = cursor.end = owned[cursor.owned_pos];
+      return cursor.next;
+    }
+    return SIZE_MAX;
+  }
+
+  size_t chunk_requests = this->stream_->GetChunkRequests();
+  while (cursor.next < limit)
+  {
+    // 越过的请求本线程不再需要，预取线程可复用其缓冲区
+    cursor.in_use.store(cursor.next, std::memory_order_release);
+    const std::vector<uint32_t>* owned = this->stream_->GetOwned(cursor.next, thread_id);
+    if (!owned)
+      break;
+    size_t chunk_begin = cursor.next - cursor.next % chunk_requests;
+    auto it = std::lower_bound(owned->begin(), owned->end(), cursor.next - chunk_begin);
+    if (it == owned->end())
+    {
+      // 本块余下的请求都不归本线程
+      cursor.next = chunk_begin + chunk_requests;
+      continue;
+    }
+    cursor.next = chunk_begin + *it;
+    if (cursor.next >= limit)
+      break;
+    cursor.end = cursor.next;
+    cursor.in_use.store(cursor.next, std::memory_order_release);
+    return cursor.next;
+  }
+  cursor.in_use.store(limit, std::memory_order_release);
+  return SIZE_MAX;
+}
+
+size_t TwitterTraceReader::PeekBatchIndex(const size_t thread_id)
+{
+  BatchCursor& cursor = this->batch_cursors_[thread_id];
+  if (cursor.next == cursor.end)
+  {
+    // 领取新批次：领取前 in_use 仍为上一条请求的下标，不大于新批次，流式读取不会提前复用其缓冲区；
+    // 领取后上一条请求不再需要，in_use 前移到新批次，等待新批次所在分块时不会阻塞预取线程
+    size_t begin = this->batch_cursor_.fetch_add(this->batch_size_, std::memory_order_relaxed);
+    size_t end = begin + this->batch_size_;
+    if (this->request_limit_)
+    {
+      begin = std::min(begin, this->request_limit_);
+      end = std::min(end, this->request_limit_);
+    }
+    cursor.next = begin;
+    cursor.end = end;
+    if (begin == end)
+    {
+      // 本阶段的请求已领完，流式读取无需再预取阶段之外的请求
+      cursor.in_use.store(this->request_limit_ ? this->request_limit_ : SIZE_MAX, std::memory_order_release);
+      return SIZE_MAX;
+    }
+    cursor.in_use.store(begin, std::memory_order_release);
+  }
+  return cursor.next;
+}
+
+bool TwitterTraceReader::HasNextByThread(size_t thread_id)
+{
+  if (!CheckThreadId(thread_id))
+    exit(EXIT_FAILURE);
+
+  if (!this->UsesCursors())
+    return true;
+  size_t index = this->PeekIndex(thread_id);
+  bool has_next = (index != SIZE_MAX) &&
+                  (this->stream_ ? this->stream_->Get(index) != nullptr : index < this->GetRequestCount());
+  if (!has_next)
+    this->batch_cursors_[thread_id].in_use.store(this->request_limit_ ? this->request_limit_ : SIZE_MAX,
+                                                 std::memory_order_release);
+  return has_next;
+}
+
+size_t TwitterTraceReader::PeekIndex(const size_t thread_id)
+{
+  if (this->partition_ != TracePartition::STRIDE)
+    return this->PeekPartitionIndex(thread_id);
+  if (this->batch_size_)
+    return this->PeekBatchIndex(thread_id);
+  // local index
+  size_t current_index = (thread_local_index_[thread_id].load(std::memory_order_relaxed));
+  return current_index * thread_count_ + thread_id;
+}
+
+bool TwitterTraceReader::GetTimestampAt(const size_t index, const size_t thread_id, uint64_t& timestamp)
+{
+  // 二进制 Trace 直接读记录，不展开 Key
+  if (this->binary_trace_)
+  {
+    if (index >= this->binary_request_count_)
+      return false;
+    timestamp = this->binary_trace_->GetRecord(this->BinaryRecordIndex(index)).timestamp;
+    return true;
+  }
+  Request* req = this->GetRequestAt(index, thread_id);
+  if (!req)
+    return false;
+  timestamp = req->timestamp;
+  return true;
+}
+
+bool TwitterTraceReader::PeekTimestampByThread(size_t thread_id, uint64_t& timestamp)
+{
+  if (!CheckThreadId(thread_id))
+    exit(EXIT_FAILURE);
+  return this->GetTimestampAt(this->PeekIndex(thread_id), thread_id, timestamp);
+}
+
+uint64_t TwitterTraceReader::GetFirstTimestamp()
+{
+  uint64_t timestamp = 0;
+  this->GetTimestampAt(0, 0, timestamp);
+  return timestamp;
+}
+
+size_t TwitterTraceReader::GetCurrentSequenceByThread(size_t thread_id)
+{
+  if (this->UsesCursors())
+    return this->batch_cursors_[thread_id].current;
+  size_t current_index = (thread_local_index_[thread_id].load(std::memory_order_relaxed));
+  return (current_index ? (current_index - 1) * thread_count_ + thread_id : SIZE_MAX);
+}
+
+void TwitterTraceReader::MaterializeRequests()
+{
+  if (!this->binary_trace_ || !this->trace_requests_.empty())
+    return;
+  this->trace_requests_.resize(this->binary_request_count_);
+  for (size_t i = 0; i < this->binary_request_count_; i++)
+    this->binary_trace_->GetRequest(this->BinaryRecordIndex(i), this->trace_requests_[i]);
+  this->trace_iter_ = this->trace_requests_.begin();
+}
+
+size_t TwitterTraceReader::GetRequestCount() const
+{
+  if (this->stream_)
+    return this->stream_->GetRequestCount();
+  return (this->binary_trace_ ? this->binary_request_count_ : this->trace_requests_.size());
+}
+
+Request* TwitterTraceReader::GetRequestAt(const size_t index, const size_t thread_id)
+{
+  if (index == SIZE_MAX)
+    return nullptr;
+  if (this->stream_)
+    return this->stream_->Get(index);
+  if (index >= this->GetRequestCount())
+    return nullptr;
+  if (!this->binary_trace_)
+    return &this->trace_requests_[index];
+  Request& slot = this->binary_slots_[thread_id];
+  this->binary_trace_->GetRequest(this->BinaryRecordIndex(index), slot);
+  return &slot;
+}
+
 bool TwitterTraceReader::GetTraceRequests(std::vector<Request>& requests)
 {
+  this->MaterializeRequests();
   requests = this->trace_requests_;
   return true;
 }
 
+size_t TwitterTraceReader::GetKeyCount() const
+{
+  if (this->binary_trace_)
+    return this->binary_trace_->GetKeyCount();
+  return (this->stream_ ? 0 : this->trace_keys_.Size());
+}
+
 size_t TwitterTraceReader::GetAllRequestsCount()
 {
-  return this->trace_requests_.size();
+  return this->GetRequestCount();
 }
 
 Request* TwitterTraceReader::JumpToFirst()
@@ -149,13 +734,23 @@ Request* TwitterTraceReader::JumpToFirst()
     index.store(0, std::memory_order_relaxed);
 
   this->trace_iter_ = this->trace_requests_.begin();
-  this->curr_request_ptr_ = &(*(this->trace_iter_));
+  // 二进制读取不展开 trace_requests_，取第 0 条记录；流式读取只保留滑动窗口，没有可返回的首条请求
+  if (this->trace_requests_.empty())
+    this->curr_request_ptr_ = (this->binary_trace_ ? this->GetRequestAt(0, 0) : nullptr);
+  else
+    this->curr_request_ptr_ = &(*(this->trace_iter_));
   return curr_request_ptr_;
 }
 
 Request* TwitterTraceReader::JumpToLast()
 {
   this->trace_iter_ = this->trace_requests_.end();
+  if (this->trace_requests_.empty())
+  {
+    size_t count = this->GetRequestCount();
+    this->curr_request_ptr_ = (this->binary_trace_ && count ? this->GetRequestAt(count - 1, 0) : nullptr);
+    return curr_request_ptr_;
+  }
   this->trace_iter_--;
   this->curr_request_ptr_ = &(*(this->trace_iter_));
   return curr_request_ptr_;
@@ -178,34 +773,45 @@ Request* TwitterTraceReader::GetNext()
 }
 
 Request* TwitterTraceReader::GetNextByThread(size_t thread_id)
+{
+  size_t index;
+  return this->NextRequest(thread_id, index);
+}
+
+Request* TwitterTraceReader::NextRequest(size_t thread_id, size_t& index)
 {
   if (!CheckThreadId(thread_id))
     exit(EXIT_FAILURE);
 
   // local index
-  size_t current_index = (thread_local_index_[thread_id].fetch_add(1, std::memory_order_relaxed));
-  size_t target_request_index = current_index * thread_count_ + thread_id;
-  // check if is valid
-  if (target_request_index >= trace_requests_.size())
-    // maybe this thread's work is done
-    return nullptr;
+  if (this->UsesCursors())
+  {
+    BatchCursor& cursor = this->batch_cursors_[thread_id];
+    index = this->PeekIndex(thread_id);
+    cursor.current = index;
+    if (index == SIZE_MAX)
+      return nullptr;
+    cursor.next++;
+    cursor.in_use.store(index, std::memory_order_release);
+    return this->GetRequestAt(index, thread_id);
+  }
 
-  return &trace_requests_[target_request_index];
+  // acq_rel: 流式读取时，对上一条请求的访问先于索引推进对预取线程可见
+  size_t current_index = (thread_local_index_[thread_id].fetch_add(1, std::memory_order_acq_rel));
+  index = current_index * thread_count_ + thread_id;
+  // maybe this thread's work is done
+  return this->GetRequestAt(index, thread_id);
 }
 
-std::string TwitterTraceReader::GetNextKey()
+std::string_view TwitterTraceReader::GetNextKey()
 {
-  std::string next_key = this->GetNext()->anonymized_key;
-  return next_key;
+  return this->GetNext()->anonymized_key;
 }
 
-std::string TwitterTraceReader::GetNextKeyByThread(size_t thread_id)
+std::string_view TwitterTraceReader::GetNextKeyByThread(size_t thread_id)
 {
   auto next_req_ptr = this->GetNextByThread(thread_id);
-  std::string next_key;
-  if (next_req_ptr)
-    next_key = next_req_ptr->anonymized_key;
-  return next_key;
+  return ((next_req_ptr) ? next_req_ptr->anonymized_key : std::string_view());
 }
 
 TwitterTraceOperation TwitterTraceReader::GetOperation()
@@ -223,13 +829,19 @@ TwitterTraceOperation TwitterTraceReader::GetOperationByThread(size_t thread_id)
   if (!CheckThreadId(thread_id))
     exit(EXIT_FAILURE);
 
-  // local index
-  size_t current_index = (thread_local_index_[thread_id].load(std::memory_order_relaxed));
-  size_t target_request_index = current_index * thread_count_ + thread_id;
-
+  size_t target_request_index = this->PeekIndex(thread_id);
   TwitterTraceOperation op = TwitterTraceOperation::GET;
-  if (target_request_index < trace_requests_.size())
-    op = trace_requests_[target_request_index].operation;
+  if (this->binary_trace_)
+  {
+    if (target_request_index < this->binary_request_count_)
+      op = static_cast<TwitterTraceOperation>(this->binary_trace_->GetRecord(this->BinaryRecordIndex(target_request_index)).operation);
+  }
+  else
+  {
+    Request* req = this->GetRequestAt(target_request_index, thread_id);
+    if (req)
+      op = req->operation;
+  }
   return op;
   // 这里缺少处理越界场景
 }
@@ -244,16 +856,8 @@ Request* TwitterTraceReader::GetCurrentByThread(size_t thread_id)
   if (!CheckThreadId(thread_id))
     exit(EXIT_FAILURE);
 
-  // local index
-  size_t current_index = (thread_local_index_[thread_id].load(std::memory_order_relaxed));
-  size_t target_request_index = (current_index - 1) * thread_count_ + thread_id;
-
-  // check if is valid
-  if (target_request_index >= trace_requests_.size())
-    // maybe this thread's work is done
-    return nullptr;
-
-  return &trace_requests_[target_request_index];
+  // maybe this thread's work is done
+  return this->GetRequestAt(this->GetCurrentSequenceByThread(thread_id), thread_id);
 }
 
 size_t TwitterTraceReader::GetCurrentValueSize()
@@ -278,15 +882,15 @@ size_t TwitterTraceReader::GetCurrentKeySizeByThread(size_t thread_id)
   return ((current_req_ptr) ? current_req_ptr->key_size : 0);
 }
 
-std::string TwitterTraceReader::GetCurrentKey()
+std::string_view TwitterTraceReader::GetCurrentKey()
 {
-  return ((this->curr_request_ptr_) ? this->curr_request_ptr_->anonymized_key : "");
+  return ((this->curr_request_ptr_) ? this->curr_request_ptr_->anonymized_key : std::string_view());
 }
 
-std::string TwitterTraceReader::GetCurrentKeyByThread(size_t thread_id)
+std::string_view TwitterTraceReader::GetCurrentKeyByThread(size_t thread_id)
 {
   auto current_req_ptr = GetCurrentByThread(thread_id);
-  return ((current_req_ptr) ? current_req_ptr->anonymized_key : "");
+  return ((current_req_ptr) ? current_req_ptr->anonymized_key : std::string_view());
 }
 
 Request* TwitterTraceReader::GetPrev()
@@ -313,27 +917,19 @@ Request* TwitterTraceReader::GetPrevByThread(size_t thread_id)
   // local index
   size_t current_index = (thread_local_index_[thread_id].fetch_sub(1, std::memory_order_relaxed));
   size_t target_request_index = current_index * thread_count_ + thread_id;
-  // check if is valid
-  if (target_request_index >= trace_requests_.size() || target_request_index < 0)
-    // maybe this thread's work is done
-    return nullptr;
-
-  return &trace_requests_[target_request_index];
+  // maybe this thread's work is done
+  return this->GetRequestAt(target_request_index, thread_id);
 }
 
-std::string TwitterTraceReader::GetPrevKey()
+std::string_view TwitterTraceReader::GetPrevKey()
 {
-  std::string prev_key = this->GetPrev()->anonymized_key;
-  return prev_key;
+  return this->GetPrev()->anonymized_key;
 }
 
-std::string TwitterTraceReader::GetPrevKeyByThread(size_t thread_id)
+std::string_view TwitterTraceReader::GetPrevKeyByThread(size_t thread_id)
 {
   auto prev_req_ptr = this->GetNextByThread(thread_id);
-  std::string prev_key;
-  if (prev_req_ptr)
-    prev_key = prev_req_ptr->anonymized_key;
-  return prev_key;
+  return ((prev_req_ptr) ? prev_req_ptr->anonymized_key : std::string_view());
 }
 
 void TwitterTraceReader::ResetIterator()
@@ -343,6 +939,23 @@ void TwitterTraceReader::ResetIterator()
 
   for (auto& index : this->thread_local_index_) 
     index.store(0, std::memory_order_relaxed);
+  if (this->UsesCursors())
+  {
+    this->batch_cursor_.store(0, std::memory_order_relaxed);
+    for (size_t thread_id = 0; thread_id < this->thread_count_; thread_id++)
+    {
+      BatchCursor& cursor = this->batch_cursors_[thread_id];
+      cursor.next = 0;
+      // 亲和划分下 end 为已确认归属本线程的下标，归位后尚未确认
+      cursor.end = (this->partition_ != TracePartition::STRIDE ? SIZE_MAX : 0);
+      cursor.current = SIZE_MAX;
+      cursor.owned_pos = 0;
+      cursor.in_use.store(0, std::memory_order_relaxed);
+    }
+  }
+  // 先归位索引，流式读取时预取线程不会再复用第 0 块所在缓冲区
+  if (this->stream_)
+    this->stream_->Rewind();
 }
 
 void TwitterTraceReader::TraverseTrace()
@@ -350,20 +963,24 @@ void TwitterTraceReader::TraverseTrace()
   if (!this->read_succeeded_)
     return;
 
+  // 流式读取只保留滑动窗口，无法从头遍历
+  if (this->stream_)
+    return;
+
   this->JumpToFirst();
-  while (this->trace_iter_ != this->trace_requests_.end())
+  // 按下标遍历，二进制读取时经线程 0 的槽位解码，不需要展开 trace_requests_
+  for (size_t i = 0; i < this->GetRequestCount(); i++)
   {
-    // std::cout << this->trace_iter_->timestamp << ", " << this->trace_iter_->anonymized_key
-    //           << ", " << this->trace_iter_->key_size << ", " << this->trace_iter_->value_size
-    //           << ", " << this->trace_iter_->client_id << ", " << this->trace_iter_->operation
-    //           << ", " << this->trace_iter_->ttl << std::endl;
-
-    std::cout << this->trace_iter_->anonymized_key
-              << ", " << this->trace_iter_->key_size << ", " << this->trace_iter_->value_size
-              << ", " << this->trace_iter_->operation
-              << std::endl;
+    const Request* req = this->GetRequestAt(i, 0);
+    // std::cout << req->timestamp << ", " << req->anonymized_key
+    //           << ", " << req->key_size << ", " << req->value_size
+    //           << ", " << req->client_id << ", " << req->operation
+    //           << ", " << req->ttl << std::endl;
 
-    this->trace_iter_++;
+    std::cout << req->anonymized_key
+              << ", " << req->key_size << ", " << req->value_size
+              << ", " << req->operation
+              << std::endl;
   }
   this->JumpToFirst();
 }
@@ -12,8 +12,12 @@
 #include <unistd.h>
 #include <sys/mman.h>
 #include <atomic>
+#include <memory>
+#include <string_view>
 
 #include "core/utils.h"
+#include "core/key_sampler.h"
+#include "twitter_trace_keys.h"
 
 namespace module
 {
@@ -33,6 +37,17 @@ enum TwitterTraceOperation
   DECR = 10
 };
 
+// Trace 在客户端线程间的划分方式
+enum TracePartition
+{
+  // 按请求下标交错划分
+  STRIDE = 0,
+  // 按 Key 哈希，同一 Key 的请求由同一线程按 Trace 顺序发出
+  KEY = 1,
+  // 按 client_id，同一客户端的请求由同一线程按 Trace 顺序发出
+  CLIENT = 2
+};
+
 // 字符串 op --> 枚举类型映射
 static const std::unordered_map<std::string, TwitterTraceOperation> g_op_map = 
 {
@@ -49,28 +64,49 @@ static const std::unordered_map<std::string, TwitterTraceOperation> g_op_map =
   {"decr", TwitterTraceOperation::DECR}
 };
 
-// 目前只需要 key、key_size、value_size、operation
+// 目前只需要 timestamp、key、key_size、value_size、client_id、operation、ttl
+// Key 收在 TraceKeyDict 中：key_id 为字典内的 id（流式读取时只在所在分块内唯一），
+// anonymized_key 指向字典 arena（二进制 Trace 时指向映射的文件）
 struct Request
 {
-  // uint64_t timestamp;
-  std::string anonymized_key;
+  uint64_t timestamp;
+  std::string_view anonymized_key;
+  uint32_t key_id;
   // key_size = len(anonymized_key)
   uint32_t key_size;
   uint32_t value_size;
-  // uint32_t client_id;
+  uint32_t client_id;
   TwitterTraceOperation operation;
-  // uint32_t ttl;
+  uint32_t ttl;
 };
 
+class TraceBinaryFile;
+class TraceStream;
+
+// @brief 并行解析内存中的文本 Trace [data, data + size)，请求按原顺序追加到 requests，Key 收进 keys；
+//        first_line 为首行行号（用于错误信息），返回行数（含空行），有格式错误的行时 no_error 置为 false；
+//        sampler 不为空时只保留 Key 哈希被采中的请求
+size_t ParseTraceBuffer(const char* data, const size_t size, const char delimiter,
+                        std::vector<Request>& requests, TraceKeyDict& keys,
+                        const size_t first_line, bool& no_error,
+                        const utils::KeySampler* sampler = nullptr);
+
 /**
  * 读取 Twitter Cache-trace
- * 采用分片读取方式，每个线程读取自己范围（交错读取）
- * 缺点是无法保序（Trace 中顺序）
+ * 默认采用分片读取方式，每个线程读取自己范围（交错读取），缺点是无法保序（Trace 中顺序）；
+ * 保序模式（SetBatchReplay）下线程从全局游标按批次领取连续的请求，
+ * 并可通过请求在 Trace 中的序号（GetCurrentSequenceByThread）恢复顺序；
+ * 亲和划分（SetPartition）下线程依次扫描 Trace，只取 Key 哈希或 client_id 归属自己的请求
+ *
+ * 文本 Trace 以 mmap 映射后按换行对齐切分、多线程解析（memchr 查找分隔符，手写整数解析），
+ * 结果与逐行解析一致并保持原有顺序，读取完成后输出 MB/s 与 requests/s；读取行数上限为 0 时读取整个文件
  */
 class TwitterTraceReader
 {
 private:
   std::vector<Request> trace_requests_;
+  // trace_requests_ 中 Key 的字典
+  TraceKeyDict trace_keys_;
 
   size_t limit_record_count_ = 0;
   size_t limit_operation_count_ = 0;
@@ -86,19 +122,118 @@ private:
   
   bool read_succeeded_ = false;
 
+  // 二进制 Trace 直接 mmap，不展开到 trace_requests_
+  std::unique_ptr<TraceBinaryFile> binary_trace_;
+  size_t binary_request_count_ = 0;
+  // 各线程当前请求的展开结果
+  std::vector<Request> binary_slots_;
+
+  // 保序重放：线程从全局游标领取 batch_size_ 条连续请求，为 0 时按线程交错划分
+  struct alignas(64) BatchCursor
+  {
+    // 线程已领取批次中下一条与批次末尾的下标；亲和划分下 next 为扫描位置，
+    // end 为已确认归属本线程的下标（避免重复计算归属）
+    size_t next = 0;
+    size_t end = 0;
+    size_t current = SIZE_MAX;
+    // 亲和划分下本线程下标列表中的位置
+    size_t owned_pos = 0;
+    // 线程可能还会访问的最小下标（流式读取据此复用缓冲区），领完后为 SIZE_MAX
+    std::atomic<size_t> in_use{0};
+  };
+  size_t batch_size_ = 0;
+  // 本阶段的请求数上限，0 表示直到 Trace 末尾
+  size_t request_limit_ = 0;
+  std::atomic<size_t> batch_cursor_{0};
+  std::unique_ptr<BatchCursor[]> batch_cursors_;
+  TracePartition partition_ = TracePartition::STRIDE;
+  // 亲和划分：整体读入的 Trace 在划分时计算一次归属，按线程记录请求下标（升序）；
+  // 流式读取由 TraceStream 按分块整理
+  std::vector<std::vector<size_t>> partition_owned_;
+
+  // 流式读取：分块请求数为 0 时整体读入内存
+  size_t stream_chunk_requests_ = 0;
+  size_t stream_buffer_count_ = 2;
+  std::unique_ptr<TraceStream> stream_;
+  // 多个文本 Trace 按时间戳归并，false 时依次拼接
+  bool merge_by_timestamp_ = false;
+  // 按 Key 哈希采样（SHARDS），只保留采中 Key 的全部请求；读取上限仍按原 Trace 的行数计
+  // （压缩或多文件 Trace 按请求数计，采样时随采样率缩放）
+  utils::KeySampler sampler_;
+  // 采样后二进制 Trace 保留的记录下标，为空时不采样
+  std::vector<uint64_t> binary_index_;
+
   bool CheckThreadId(const size_t thread_id);
+  bool ReadBinaryTraceFile(const std::string& trace_file_path);
+  void SampleBinaryRecords();
+  uint64_t BinaryRecordIndex(const size_t index) const
+  {
+    return this->binary_index_.empty() ? index : this->binary_index_[index];
+  }
+  const utils::KeySampler* GetSampler() const { return this->sampler_.enabled() ? &this->sampler_ : nullptr; }
+  bool ReadPlainTraceFile(const std::string& trace_file_path, const char delimiter);
+  // @brief 经 TraceRequestSource 读入压缩或多个文本 Trace
+  bool ReadTraceSource(const std::vector<std::string>& paths, const char delimiter);
+  bool ReadTraceStream(const std::vector<std::string>& paths, const char delimiter);
+  // @brief 各线程可能还会访问的最小请求下标
+  size_t GetLowWatermark() const;
+  // @brief 保序模式下线程的下一条请求下标（必要时领取新批次），领完时返回 SIZE_MAX
+  size_t PeekBatchIndex(const size_t thread_id);
+  // @brief 亲和划分下线程的下一条请求下标（沿本线程的下标列表前进），走完时返回 SIZE_MAX
+  size_t PeekPartitionIndex(const size_t thread_id);
+  // @brief 请求归属的线程
+  size_t GetPartitionOwner(const Request& req) const;
+  // @brief 计算整体读入的 Trace 中每条请求的归属，填充 partition_owned_
+  void BuildPartitionIndex();
+  // @brief 线程是否通过 batch_cursors_ 取请求（保序或亲和划分）
+  bool UsesCursors() const { return this->batch_size_ > 0 || this->partition_ != TracePartition::STRIDE; }
+  // @brief 线程下一条请求的下标（不推进）
+  size_t PeekIndex(const size_t thread_id);
+  bool GetTimestampAt(const size_t index, const size_t thread_id, uint64_t& timestamp);
+  size_t GetRequestCount() const;
+  // @brief 第 index 条请求；二进制 Trace 下展开到 thread_id 的槽位
+  Request* GetRequestAt(const size_t index, const size_t thread_id);
 
 public:
   TwitterTraceReader();
   TwitterTraceReader(const std::string& trace_file_path);
   TwitterTraceReader(const std::string& trace_file_path, const size_t thread_count);
   TwitterTraceReader(const std::string& trace_file_path, const size_t thread_count, 
-                      const size_t limit_record_count, const size_t limit_operation_count);
+                      const size_t limit_record_count, const size_t limit_operation_count,
+                      const size_t stream_chunk_requests = 0, const size_t stream_buffer_count = 2,
+                      const bool merge_by_timestamp = false, const double sample_rate = 1.0);
+  ~TwitterTraceReader();
 
-  // @brief 内存够大情况下直接读入内存，单线程
+  // @brief 文本 Trace 读入内存（或流式读取，见 twitter_trace_stream.h）；二进制 Trace（见 twitter_trace_binary.h）直接 mmap。
+  //        trace_file_path 可为逗号分隔的多个文件或 glob 模式，文本 Trace 可为 gzip / zstd 压缩（见 twitter_trace_source.h）
   bool ReadTraceFile(const std::string& trace_file_path, const char delimiter = ',');
   // @brief 返回请求数组
   bool GetTraceRequests(std::vector<Request>& requests);
+  // @brief 只读访问请求数组，不拷贝
+  const std::vector<Request>& GetTraceRequests() const { return this->trace_requests_; }
+  // @brief 二进制 Trace 按需展开到请求数组（单线程接口与 GetTraceRequests 需要）
+  void MaterializeRequests();
+  bool IsBinary() const { return this->binary_trace_ != nullptr; }
+  double GetSampleRate() const { return this->sampler_.rate(); }
+
+  // @brief 开启保序重放，batch_size 为每次领取的连续请求数（在任何线程取请求之前调用）
+  void SetBatchReplay(const size_t batch_size);
+  bool IsBatchReplay() const { return this->batch_size_ > 0; }
+  // @brief 按 Key 哈希或 client_id 将请求固定划分给线程（在任何线程取请求之前调用，优先于 SetBatchReplay）
+  void SetPartition(const TracePartition partition);
+  bool IsPartitioned() const { return this->partition_ != TracePartition::STRIDE; }
+  // @brief 保序或亲和划分下本阶段的请求数（0 表示直到 Trace 末尾）
+  void SetRequestLimit(const size_t request_limit) { this->request_limit_ = request_limit; }
+  // @brief 保序或亲和划分下线程是否还有请求可取
+  bool HasNextByThread(size_t thread_id);
+  // @brief 线程当前请求在 Trace 中的序号，尚无当前请求时返回 SIZE_MAX
+  size_t GetCurrentSequenceByThread(size_t thread_id);
+  // @brief 线程下一条请求的时间戳（不推进），没有请求时返回 false
+  bool PeekTimestampByThread(size_t thread_id, uint64_t& timestamp);
+  // @brief Trace 首条请求的时间戳（无请求时为 0）
+  uint64_t GetFirstTimestamp();
+  // @brief 不同 Key 的个数（流式读取时不可用，返回 0）；Request::key_id 小于该值
+  size_t GetKeyCount() const;
   // @brief 返回 Trace 中所有请求个数（操作数）
   size_t GetAllRequestsCount();
 
@@ -108,8 +243,11 @@ public:
   Request* JumpToLast();
   Request* GetNext();
   Request* GetNextByThread(size_t thread_id);
-  std::string GetNextKey();
-  std::string GetNextKeyByThread(size_t thread_id);
+  // @brief 推进线程的游标并返回下一条请求（指向 Reader 内部存储，在线程取下一条请求前有效），
+  //        index 为其在 Trace 中的序号；一次操作只需访问 Trace 一次
+  Request* NextRequest(size_t thread_id, size_t& index);
+  std::string_view GetNextKey();
+  std::string_view GetNextKeyByThread(size_t thread_id);
   
   Request* GetCurrent();
   Request* GetCurrentByThread(size_t thread_id);
@@ -117,13 +255,13 @@ public:
   size_t GetCurrentValueSizeByThread(size_t thread_id);
   size_t GetCurrentKeySize();
   size_t GetCurrentKeySizeByThread(size_t thread_id);
-  std::string GetCurrentKey();
-  std::string GetCurrentKeyByThread(size_t thread_id);
+  std::string_view GetCurrentKey();
+  std::string_view GetCurrentKeyByThread(size_t thread_id);
   
   Request* GetPrev();
   Request* GetPrevByThread(size_t thread_id);
-  std::string GetPrevKey();
-  std::string GetPrevKeyByThread(size_t thread_id);
+  std::string_view GetPrevKey();
+  std::string_view GetPrevKeyByThread(size_t thread_id);
 
   TwitterTraceOperation GetOperation();
   TwitterTraceOperation GetOperationByThread(size_t thread_id);
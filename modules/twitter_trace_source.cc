@@ -0,0 +1,476 @@
+#include "twitter_trace_source.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <glob.h>
+#include <sstream>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace module
+{
+
+// 每次从文件读取的字节数
+static const size_t kReadBytes = 1 << 20;
+
+std::vector<std::string> ExpandTraceFiles(const std::string& spec)
+{
+  std::vector<std::string> paths;
+  std::stringstream ss(spec);
+  std::string item;
+  while (std::getline(ss, item, ','))
+  {
+    if (item.empty())
+      continue;
+    if (item.find_first_of("*?[") == std::string::npos)
+    {
+      paths.push_back(item);
+      continue;
+    }
+    // glob 的匹配结果已按文件名排序
+    glob_t matches;
+    if (glob(item.c_str(), 0, nullptr, &matches) == 0)
+    {
+      for (size_t i = 0; i < matches.gl_pathc; i++)
+        paths.push_back(matches.gl_pathv[i]);
+    }
+    else
+      YCSB_C_LOG_ERROR("No trace file matches: %s", item.c_str());
+    globfree(&matches);
+  }
+  return paths;
+}
+
+TraceCompression DetectTraceCompression(const std::string& path)
+{
+  unsigned char magic[4] = {0, 0, 0, 0};
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return TraceCompression::NONE;
+  size_t n = fread(magic, 1, sizeof(magic), file);
+  fclose(file);
+  if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+    return TraceCompression::GZIP;
+  if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+    return TraceCompression::ZSTD;
+  return TraceCompression::NONE;
+}
+
+TraceFileBlocks::TraceFileBlocks(const std::string& path, const size_t block_bytes, const size_t max_blocks)
+  : path_(path), block_bytes_(block_bytes), max_blocks_(std::max<size_t>(max_blocks, 1)),
+    decompressed_bytes_(0), failed_(false), stop_(false)
+{}
+
+TraceFileBlocks::~TraceFileBlocks()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->stop_.store(true, std::memory_order_release);
+  }
+  this->cv_.notify_all();
+  if (this->worker_.joinable())
+    this->worker_.join();
+}
+
+bool TraceFileBlocks::Start()
+{
+  this->compression_ = DetectTraceCompression(this->path_);
+#ifndef HAVE_ZLIB
+  if (this->compression_ == TraceCompression::GZIP)
+  {
+    YCSB_C_LOG_ERROR("Trace %s is gzip-compressed, rebuild with zlib to read it", this->path_.c_str());
+    return false;
+  }
+#endif
+#ifndef HAVE_ZSTD
+  if (this->compression_ == TraceCompression::ZSTD)
+  {
+    YCSB_C_LOG_ERROR("Trace %s is zstd-compressed, rebuild with libzstd to read it", this->path_.c_str());
+    return false;
+  }
+#endif
+  this->worker_ = std::thread(&TraceFileBlocks::Run, this);
+  return true;
+}
+
+void TraceFileBlocks::Run()
+{
+  bool ok = false;
+  int fd = open(this->path_.c_str(), O_RDONLY);
+  if (fd < 0)
+    YCSB_C_LOG_ERROR("Error opening trace file: %s", this->path_.c_str());
+  else
+  {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    switch (this->compression_)
+    {
+      case TraceCompression::GZIP:
+        ok = this->InflateGzip(fd);
+        break;
+      case TraceCompression::ZSTD:
+        ok = this->DecompressZstd(fd);
+        break;
+      default:
+        ok = this->ReadPlain(fd);
+        break;
+    }
+    close(fd);
+  }
+  if (!ok && !this->stop_.load(std::memory_order_acquire))
+    this->failed_.store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->eof_ = true;
+  }
+  this->cv_.notify_all();
+}
+
+bool TraceFileBlocks::ReadPlain(int fd)
+{
+  std::unique_ptr<char[]> buf(new char[kReadBytes]);
+  while (true)
+  {
+    ssize_t n = read(fd, buf.get(), kReadBytes);
+    if (n < 0)
+    {
+      YCSB_C_LOG_ERROR("Error reading trace file: %s", this->path_.c_str());
+      return false;
+    }
+    if (!this->Emit(buf.get(), n, n == 0))
+      return false;
+    if (n == 0)
+      return true;
+  }
+}
+
+bool TraceFileBlocks::InflateGzip([[maybe_unused]] int fd)
+{
+#ifdef HAVE_ZLIB
+  std::unique_ptr<unsigned char[]> in(new unsigned char[kReadBytes]);
+  std::unique_ptr<char[]> out(new char[kReadBytes]);
+  z_stream strm;
+  std::memset(&strm, 0, sizeof(strm));
+  // 16 + MAX_WBITS：解析 gzip 头
+  if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK)
+    return false;
+  bool ok = true;
+  bool stream_end = true;
+  while (ok)
+  {
+    ssize_t n = read(fd, in.get(), kReadBytes);
+    if (n <= 0)
+    {
+      if (n < 0 || !stream_end)
+      {
+        YCSB_C_LOG_ERROR("Truncated or unreadable gzip trace: %s", this->path_.c_str());
+        ok = false;
+      }
+      break;
+    }
+    strm.next_in = in.get();
+    strm.avail_in = static_cast<uInt>(n);
+    while (ok && strm.avail_in > 0)
+    {
+      strm.next_out = reinterpret_cast<Bytef*>(out.get());
+      strm.avail_out = static_cast<uInt>(kReadBytes);
+      int ret = inflate(&strm, Z_NO_FLUSH);
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+      {
+        YCSB_C_LOG_ERROR("Error inflating gzip trace %s: %s", this->path_.c_str(), strm.msg ? strm.msg : "");
+        ok = false;
+        break;
+      }
+      ok = this->Emit(out.get(), kReadBytes - strm.avail_out, false);
+      stream_end = (ret == Z_STREAM_END);
+      // 多个 gzip 成员依次拼接（如 cat a.gz b.gz）
+      if (stream_end)
+        inflateReset(&strm);
+    }
+  }
+  inflateEnd(&strm);
+  return ok && this->Emit(nullptr, 0, true);
+#else
+  return false;
+#endif
+}
+
+bool TraceFileBlocks::DecompressZstd([[maybe_unused]] int fd)
+{
+#ifdef HAVE_ZSTD
+  size_t in_size = ZSTD_DStreamInSize();
+  size_t out_size = ZSTD_DStreamOutSize();
+  std::unique_ptr<char[]> in(new char[in_size]);
+  std::unique_ptr<char[]> out(new char[out_size]);
+  ZSTD_DStream* dstream = ZSTD_createDStream();
+  if (!dstream)
+    return false;
+  ZSTD_initDStream(dstream);
+  bool ok = true;
+  size_t last_ret = 0;
+  while (ok)
+  {
+    ssize_t n = read(fd, in.get(), in_size);
+    if (n < 0)
+    {
+      YCSB_C_LOG_ERROR("Unreadable zstd trace: %s", this->path_.c_str());
+      ok = false;
+      break;
+    }
+    // 输出缓冲区写满时解码器内部可能还留有数据，需继续调用直到取完；
+    // 读到末尾时若最后一帧尚未结束，再以空输入调用一次取出剩余数据
+    bool eof = (n == 0);
+    bool drain = (eof && last_ret != 0);
+    ZSTD_inBuffer input = {in.get(), static_cast<size_t>(n), 0};
+    while (ok && (input.pos < input.size || drain))
+    {
+      ZSTD_outBuffer output = {out.get(), out_size, 0};
+      last_ret = ZSTD_decompressStream(dstream, &output, &input);
+      if (ZSTD_isError(last_ret))
+      {
+        YCSB_C_LOG_ERROR("Error decompressing zstd trace %s: %s", this->path_.c_str(), ZSTD_getErrorName(last_ret));
+        ok = false;
+        break;
+      }
+      ok = this->Emit(out.get(), output.pos, false);
+      drain = (output.pos == output.size);
+    }
+    if (ok && eof)
+    {
+      // 取完后 last_ret 仍不为 0 表示最后一帧不完整
+      if (last_ret != 0)
+      {
+        YCSB_C_LOG_ERROR("Truncated zstd trace: %s", this->path_.c_str());
+        ok = false;
+      }
+      break;
+    }
+  }
+  ZSTD_freeDStream(dstream);
+  return ok && this->Emit(nullptr, 0, true);
+#else
+  return false;
+#endif
+}
+
+bool TraceFileBlocks::Emit(const char* data, const size_t size, const bool last)
+{
+  this->pending_.append(data, size);
+  this->decompressed_bytes_.fetch_add(size, std::memory_order_relaxed);
+  if (last)
+    return this->pending_.empty() || this->Push(std::move(this->pending_));
+  if (this->pending_.size() < this->block_bytes_)
+    return true;
+  // 在最后一个换行处切开，余下的不完整行留到下一块
+  size_t nl = this->pending_.rfind('\n');
+  if (nl == std::string::npos)
+    return true;
+  std::string rest(this->pending_, nl + 1);
+  this->pending_.resize(nl + 1);
+  if (!this->Push(std::move(this->pending_)))
+    return false;
+  this->pending_ = std::move(rest);
+  this->pending_.reserve(this->block_bytes_ + kReadBytes);
+  return true;
+}
+
+bool TraceFileBlocks::Push(std::string&& block)
+{
+  std::unique_lock<std::mutex> lock(this->mtx_);
+  this->cv_.wait(lock, [this] {
+    return this->blocks_.size() < this->max_blocks_ || this->stop_.load(std::memory_order_acquire);
+  });
+  if (this->stop_.load(std::memory_order_acquire))
+    return false;
+  this->blocks_.push_back(std::move(block));
+  lock.unlock();
+  this->cv_.notify_all();
+  return true;
+}
+
+bool TraceFileBlocks::Next(std::string& block)
+{
+  std::unique_lock<std::mutex> lock(this->mtx_);
+  this->cv_.wait(lock, [this] { return !this->blocks_.empty() || this->eof_; });
+  if (this->blocks_.empty())
+    return false;
+  block = std::move(this->blocks_.front());
+  this->blocks_.pop_front();
+  lock.unlock();
+  this->cv_.notify_all();
+  return true;
+}
+
+TraceRequestSource::TraceRequestSource(const char delimiter, const bool merge_by_timestamp,
+                                       const utils::KeySampler* sampler, const size_t limit_requests)
+  : delimiter_(delimiter), merge_by_timestamp_(merge_by_timestamp), sampler_(sampler),
+    limit_requests_(limit_requests)
+{}
+
+bool TraceRequestSource::OpenFile(const size_t idx)
+{
+  File& file = this->files_[idx];
+  file.blocks.reset(new TraceFileBlocks(this->paths_[idx], kBlockBytes, kMaxBlocks));
+  if (file.blocks->Start())
+    return true;
+  file.blocks.reset();
+  file.eof = true;
+  this->no_error_ = false;
+  return false;
+}
+
+bool TraceRequestSource::Open(const std::vector<std::string>& paths)
+{
+  this->paths_ = paths;
+  this->files_.clear();
+  this->files_.resize(paths.size());
+  this->current_ = 0;
+  this->heap_.clear();
+  this->closed_bytes_ = 0;
+  this->consumed_requests_ = 0;
+  this->no_error_ = true;
+  if (!this->merge_by_timestamp_)
+    return paths.empty() || this->OpenFile(0);
+
+  // 归并：所有文件同时解压，各取首条请求建堆
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    if (!this->OpenFile(i))
+      return false;
+  }
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    if (this->Refill(this->files_[i]))
+      this->heap_.push_back(i);
+  }
+  std::make_heap(this->heap_.begin(), this->heap_.end(),
+                 [this](size_t a, size_t b) { return this->HeapLess(a, b); });
+  return true;
+}
+
+bool TraceRequestSource::Refill(File& file)
+{
+  while (file.pos == file.requests.size())
+  {
+    if (file.eof)
+      return false;
+    file.requests.clear();
+    file.keys.Clear();
+    file.pos = 0;
+    if (!file.blocks->Next(file.block))
+    {
+      file.eof = true;
+      if (file.blocks->Failed())
+        this->no_error_ = false;
+      this->closed_bytes_ += file.blocks->GetDecompressedBytes();
+      file.blocks.reset();
+      std::string().swap(file.block);
+      return false;
+    }
+    // 有条数上限时上限按原始请求计，解析时不采样，取出时再采样
+    file.line_cnt += ParseTraceBuffer(file.block.data(), file.block.size(), this->delimiter_,
+                                      file.requests, file.keys, file.line_cnt + 1, this->no_error_,
+                                      this->limit_requests_ ? nullptr : this->sampler_);
+  }
+  return true;
+}
+
+bool TraceRequestSource::Append(File& file, std::vector<Request>& requests, TraceKeyDict& keys)
+{
+  Request req = file.requests[file.pos++];
+  this->consumed_requests_++;
+  if (this->limit_requests_ && this->sampler_ && !this->sampler_->Sampled(TraceKeyDict::Hash(req.anonymized_key)))
+    return false;
+  // 文件内字典只在当前块内有效，收进调用者的字典（复用已算出的哈希）
+  uint32_t key_id = keys.Intern(req.anonymized_key, file.keys.GetHash(req.key_id));
+  if (key_id == TraceKeyDict::kNoKey)
+  {
+    // 字典已满：只跳过这条请求，已有 Key 的后续请求照常读取
+    if (!this->dropped_requests_++)
+      YCSB_C_LOG_ERROR("Too many distinct keys in trace: %zu, skipping requests of new keys", keys.Size());
+    this->no_error_ = false;
+    return false;
+  }
+  req.key_id = key_id;
+  req.anonymized_key = keys.Get(key_id);
+  requests.push_back(req);
+  return true;
+}
+
+bool TraceRequestSource::HeapLess(const size_t a, const size_t b) const
+{
+  // 堆顶为时间戳最小的文件，相同时间戳先取靠前的文件
+  uint64_t ts_a = this->files_[a].requests[this->files_[a].pos].timestamp;
+  uint64_t ts_b = this->files_[b].requests[this->files_[b].pos].timestamp;
+  return ts_a > ts_b || (ts_a == ts_b && a > b);
+}
+
+size_t TraceRequestSource::Read(std::vector<Request>& requests, TraceKeyDict& keys, const size_t max_requests)
+{
+  size_t appended = 0;
+  if (!this->merge_by_timestamp_)
+  {
+    while (appended < max_requests && this->current_ < this->files_.size() && !this->LimitReached())
+    {
+      File& file = this->files_[this->current_];
+      if (!file.blocks && !file.eof && !this->OpenFile(this->current_))
+        break;
+      if (!this->Refill(file))
+      {
+        this->current_++;
+        continue;
+      }
+      size_t take = std::min(max_requests - appended, file.requests.size() - file.pos);
+      if (this->limit_requests_)
+        take = std::min(take, this->limit_requests_ - this->consumed_requests_);
+      for (size_t i = 0; i < take; i++)
+      {
+        if (this->Append(file, requests, keys))
+          appended++;
+      }
+    }
+    return appended;
+  }
+
+  auto less = [this](size_t a, size_t b) { return this->HeapLess(a, b); };
+  while (appended < max_requests && !this->heap_.empty() && !this->LimitReached())
+  {
+    std::pop_heap(this->heap_.begin(), this->heap_.end(), less);
+    size_t idx = this->heap_.back();
+    this->heap_.pop_back();
+    if (this->Append(this->files_[idx], requests, keys))
+      appended++;
+    if (this->Refill(this->files_[idx]))
+    {
+      this->heap_.push_back(idx);
+      std::push_heap(this->heap_.begin(), this->heap_.end(), less);
+    }
+  }
+  return appended;
+}
+
+size_t TraceRequestSource::GetLineCount() const
+{
+  size_t line_cnt = 0;
+  for (const auto& file : this->files_)
+    line_cnt += file.line_cnt;
+  return line_cnt;
+}
+
+size_t TraceRequestSource::GetByteCount() const
+{
+  size_t bytes = this->closed_bytes_;
+  for (const auto& file : this->files_)
+  {
+    if (file.blocks)
+      bytes += file.blocks->GetDecompressedBytes();
+  }
+  return bytes;
+}
+
+}
@@ -0,0 +1,142 @@
+#ifndef _TWITTER_TRACE_SOURCE_H_
+#define _TWITTER_TRACE_SOURCE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "twitter_trace_reader.h"
+
+/**
+ * 压缩与多文件的文本 Trace
+ * 每个文件由后台线程读取并解压（gzip 需 zlib，zstd 需 libzstd，编译时检测，找不到时读取压缩文件报错），
+ * 按换行对齐切成 8 MB 的块后放入有界队列，与解析流水线并行，不先解压到磁盘；
+ * tracemerge=concat（默认）依次拼接多个文件，tracemerge=timestamp 按时间戳归并为一个请求序列（相同时间戳时靠前的文件优先），
+ * 整体读入与流式读取均支持，twitter_trace_converter 的第 5 个参数同样可为 concat / timestamp
+ */
+
+namespace module
+{
+
+enum TraceCompression
+{
+  NONE = 0,
+  GZIP = 1,
+  ZSTD = 2
+};
+
+// @brief 展开 tracefile：逗号分隔的文件列表，每项可为 glob 模式（匹配结果按文件名排序）
+std::vector<std::string> ExpandTraceFiles(const std::string& spec);
+// @brief 按文件头魔数判断压缩格式
+TraceCompression DetectTraceCompression(const std::string& path);
+
+/**
+ * 单个 Trace 文件的字节块：后台线程读取、解压并按换行对齐切块
+ */
+class TraceFileBlocks
+{
+private:
+  const std::string path_;
+  const size_t block_bytes_;
+  const size_t max_blocks_;
+  TraceCompression compression_ = TraceCompression::NONE;
+
+  std::deque<std::string> blocks_;
+  // 尚不满一块的数据（末尾可能是不完整的行）
+  std::string pending_;
+  std::atomic<size_t> decompressed_bytes_;
+  bool eof_ = false;
+  std::atomic<bool> failed_;
+  std::atomic<bool> stop_;
+  std::thread worker_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+
+  void Run();
+  bool ReadPlain(int fd);
+  bool InflateGzip(int fd);
+  bool DecompressZstd(int fd);
+  // @brief 追加解压出的数据，凑满一块后在最后一个换行处切开并入队；队列满时等待
+  bool Emit(const char* data, const size_t size, const bool last);
+  bool Push(std::string&& block);
+
+public:
+  TraceFileBlocks(const std::string& path, const size_t block_bytes, const size_t max_blocks);
+  ~TraceFileBlocks();
+
+  bool Start();
+  // @brief 取下一块（由完整的行组成），读完或出错时返回 false
+  bool Next(std::string& block);
+  bool Failed() const { return this->failed_.load(std::memory_order_acquire); }
+  size_t GetDecompressedBytes() const { return this->decompressed_bytes_.load(std::memory_order_relaxed); }
+};
+
+/**
+ * 从一个或多个（可压缩的）文本 Trace 读取请求
+ */
+class TraceRequestSource
+{
+private:
+  struct File
+  {
+    std::unique_ptr<TraceFileBlocks> blocks;
+    // 当前块及其解析结果，Key 直接指向块内（不拷贝）
+    std::string block;
+    std::vector<Request> requests;
+    TraceKeyDict keys{false};
+    size_t pos = 0;
+    size_t line_cnt = 0;
+    bool eof = false;
+  };
+
+  const char delimiter_;
+  const bool merge_by_timestamp_;
+  const utils::KeySampler* sampler_;
+  // 读取的请求数上限（采样前的原始请求数，0 表示不限制）与已取出的原始请求数
+  const size_t limit_requests_;
+  size_t consumed_requests_ = 0;
+  std::vector<std::string> paths_;
+  std::vector<File> files_;
+  // 拼接时当前读取的文件
+  size_t current_ = 0;
+  // 归并时按 (时间戳, 文件下标) 排列的小顶堆
+  std::vector<size_t> heap_;
+  // 已读完并关闭的文件解压出的字节数
+  size_t closed_bytes_ = 0;
+  // 字典已满而跳过的请求数
+  size_t dropped_requests_ = 0;
+  bool no_error_ = true;
+
+  bool Refill(File& file);
+  bool OpenFile(const size_t idx);
+  bool Append(File& file, std::vector<Request>& requests, TraceKeyDict& keys);
+  bool HeapLess(const size_t a, const size_t b) const;
+  bool LimitReached() const { return this->limit_requests_ && this->consumed_requests_ >= this->limit_requests_; }
+
+public:
+  static const size_t kBlockBytes = 8 << 20;
+  static const size_t kMaxBlocks = 4;
+
+  // @brief sampler 不为空时只读出 Key 哈希被采中的请求；limit_requests 不为 0 时只读 Trace 的前
+  //        limit_requests 条请求（与整体读入、二进制 Trace 一致，按采样前计数），再从中采样
+  TraceRequestSource(const char delimiter, const bool merge_by_timestamp,
+                     const utils::KeySampler* sampler = nullptr, const size_t limit_requests = 0);
+
+  bool Open(const std::vector<std::string>& paths);
+  // @brief 向 requests 追加最多 max_requests 条请求，Key 收进 keys；返回追加的条数，0 表示读完
+  size_t Read(std::vector<Request>& requests, TraceKeyDict& keys, const size_t max_requests);
+  bool NoError() const { return this->no_error_; }
+  size_t GetLineCount() const;
+  // @brief 已解压（文本）的字节数
+  size_t GetByteCount() const;
+};
+
+}
+
+#endif
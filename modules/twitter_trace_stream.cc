@@ -0,0 +1,307 @@
+#include "twitter_trace_stream.h"
+#include "core/timer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace module
+{
+
+TraceStream::TraceStream(const size_t chunk_requests, const size_t buffer_count, const char delimiter,
+                         const utils::KeySampler* sampler)
+  : chunk_requests_(std::max<size_t>(chunk_requests, 1)), buffer_count_(std::max<size_t>(buffer_count, 2)),
+    delimiter_(delimiter), sampler_(sampler), buffers_(buffer_count_), buffer_keys_(buffer_count_), buffer_chunk_(new std::atomic<size_t>[buffer_count_]),
+    produced_requests_(0), total_requests_(kNoChunk), stop_(false), owned_chunk_(new std::atomic<size_t>[buffer_count_])
+{
+  for (size_t i = 0; i < this->buffer_count_; i++)
+  {
+    this->buffer_chunk_[i].store(kNoChunk, std::memory_order_relaxed);
+    this->owned_chunk_[i].store(kNoChunk, std::memory_order_relaxed);
+  }
+}
+
+TraceStream::~TraceStream()
+{
+  this->Stop();
+  if (this->data_)
+    munmap(const_cast<char*>(this->data_), this->size_);
+}
+
+bool TraceStream::Open(const std::string& trace_file_path, const size_t limit_lines)
+{
+  int fd = open(trace_file_path.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    YCSB_C_LOG_ERROR("Error opening trace file: %s", trace_file_path.c_str());
+    if (fd >= 0)
+      close(fd);
+    return false;
+  }
+  this->size_ = static_cast<size_t>(st.st_size);
+  if (this->size_ > 0)
+  {
+    void* addr = mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+      YCSB_C_LOG_ERROR("Error mapping trace file: %s", trace_file_path.c_str());
+      close(fd);
+      return false;
+    }
+    madvise(addr, this->size_, MADV_SEQUENTIAL);
+    this->data_ = static_cast<const char*>(addr);
+  }
+  close(fd);
+  this->limit_lines_ = limit_lines;
+  for (auto& buffer : this->buffers_)
+    buffer.reserve(this->chunk_requests_);
+
+  YCSB_C_LOG_INFO("Streaming trace: %zu requests per chunk, %zu buffers", this->chunk_requests_, this->buffer_count_);
+  return true;
+}
+
+bool TraceStream::OpenSource()
+{
+  this->source_.reset(new TraceRequestSource(this->delimiter_, this->merge_by_timestamp_, this->sampler_,
+                                             this->limit_lines_));
+  if (this->source_->Open(this->source_paths_))
+    return true;
+  this->source_.reset();
+  return false;
+}
+
+bool TraceStream::Open(const std::vector<std::string>& paths, const bool merge_by_timestamp, const size_t limit_requests)
+{
+  this->source_paths_ = paths;
+  this->merge_by_timestamp_ = merge_by_timestamp;
+  this->limit_lines_ = limit_requests;
+  if (!this->OpenSource())
+    return false;
+  for (auto& buffer : this->buffers_)
+    buffer.reserve(this->chunk_requests_);
+
+  YCSB_C_LOG_INFO("Streaming %zu trace file(s) %s: %zu requests per chunk, %zu buffers", paths.size(),
+                  merge_by_timestamp ? "merged by timestamp" : "concatenated", this->chunk_requests_, this->buffer_count_);
+  return true;
+}
+
+void TraceStream::Start(std::function<size_t()> low_watermark)
+{
+  this->low_watermark_ = low_watermark;
+  this->stall_sec_ = 0;
+  this->stop_.store(false, std::memory_order_relaxed);
+  this->prefetcher_ = std::thread(&TraceStream::Prefetch, this);
+}
+
+void TraceStream::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->stop_.store(true, std::memory_order_release);
+  }
+  this->ready_cv_.notify_all();
+  if (this->prefetcher_.joinable())
+    this->prefetcher_.join();
+}
+
+void TraceStream::Rewind()
+{
+  this->Stop();
+  // 第 0 块仍在缓冲区中时无需重新解析，预取线程从原位置继续
+  if (this->buffer_chunk_[0].load(std::memory_order_acquire) != 0)
+  {
+    this->pos_ = 0;
+    this->line_cnt_ = 0;
+    this->released_pos_ = 0;
+    this->next_chunk_ = 0;
+    this->carry_.clear();
+    for (size_t i = 0; i < this->buffer_count_; i++)
+    {
+      this->buffer_chunk_[i].store(kNoChunk, std::memory_order_relaxed);
+      this->owned_chunk_[i].store(kNoChunk, std::memory_order_relaxed);
+    }
+    this->produced_requests_.store(0, std::memory_order_relaxed);
+    this->total_requests_.store(kNoChunk, std::memory_order_release);
+    // 解压流不能回退，重新打开
+    if (this->source_ && !this->OpenSource())
+      this->no_error_ = false;
+  }
+  this->Start(this->low_watermark_);
+}
+
+bool TraceStream::FillChunkFromSource(std::vector<Request>& buffer, TraceKeyDict& keys)
+{
+  // 条数上限由 source_ 按采样前的请求数执行，不足一块即已读完
+  size_t want = this->chunk_requests_;
+  size_t read = this->source_ ? this->source_->Read(buffer, keys, want) : 0;
+  if (this->source_)
+  {
+    this->line_cnt_ = this->source_->GetLineCount();
+    if (!this->source_->NoError())
+      this->no_error_ = false;
+  }
+  return read == want;
+}
+
+bool TraceStream::FillChunk(std::vector<Request>& buffer, TraceKeyDict& keys)
+{
+  static const size_t kPageSize = sysconf(_SC_PAGESIZE);
+  buffer.clear();
+  keys.Clear();
+  if (!this->source_paths_.empty())
+    return this->FillChunkFromSource(buffer, keys);
+  for (const auto& carried : this->carry_)
+  {
+    buffer.push_back(carried);
+    buffer.back().key_id = keys.Intern(carried.anonymized_key);
+    buffer.back().anonymized_key = keys.Get(buffer.back().key_id);
+  }
+  this->carry_.clear();
+  while (buffer.size() < this->chunk_requests_)
+  {
+    // 找到还需的行数对应的字节范围（格式错误的行会被跳过，因此可能需要多轮）
+    size_t want = this->chunk_requests_ - buffer.size();
+    if (this->sampler_)
+      want = static_cast<size_t>(std::ceil(want / this->sampler_->rate()));
+    if (this->limit_lines_)
+      want = std::min(want, this->limit_lines_ - this->line_cnt_);
+    if (want == 0 || this->pos_ >= this->size_)
+      return false;
+    const char* begin = this->data_ + this->pos_;
+    const char* end = this->data_ + this->size_;
+    const char* pos = begin;
+    for (size_t i = 0; i < want && pos < end; i++)
+    {
+      const char* nl = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+      pos = nl ? nl + 1 : end;
+    }
+    this->line_cnt_ += ParseTraceBuffer(begin, pos - begin, this->delimiter_, buffer, keys, this->line_cnt_ + 1, this->no_error_,
+                                        this->sampler_);
+    this->pos_ += pos - begin;
+
+    // 已解析的文件页不再需要，及时释放以限制常驻内存
+    size_t release_end = this->pos_ / kPageSize * kPageSize;
+    if (release_end > this->released_pos_)
+    {
+      madvise(const_cast<char*>(this->data_ + this->released_pos_), release_end - this->released_pos_, MADV_DONTNEED);
+      this->released_pos_ = release_end;
+    }
+  }
+  if (buffer.size() > this->chunk_requests_)
+  {
+    this->carry_.assign(buffer.begin() + this->chunk_requests_, buffer.end());
+    buffer.resize(this->chunk_requests_);
+    return true;
+  }
+  return this->pos_ < this->size_ && !(this->limit_lines_ && this->line_cnt_ >= this->limit_lines_);
+}
+
+void TraceStream::Prefetch()
+{
+  utils::Timer timer;
+  while (!this->stop_.load(std::memory_order_acquire) &&
+         this->total_requests_.load(std::memory_order_acquire) == kNoChunk)
+  {
+    size_t chunk = this->next_chunk_;
+    size_t buffer_idx = chunk % this->buffer_count_;
+    // 等待所有客户端线程越过该缓冲区中的旧分块
+    if (chunk >= this->buffer_count_)
+    {
+      size_t need = (chunk - this->buffer_count_ + 1) * this->chunk_requests_;
+      utils::Timer stall_timer;
+      bool stalled = false;
+      while (!this->stop_.load(std::memory_order_acquire) && this->low_watermark_() < need)
+      {
+        stalled = true;
+        std::unique_lock<std::mutex> lock(this->mtx_);
+        this->ready_cv_.wait_for(lock, std::chrono::milliseconds(1));
+      }
+      if (stalled)
+        this->stall_sec_ += stall_timer.GetDurationSec();
+      if (this->stop_.load(std::memory_order_acquire))
+        break;
+    }
+
+    std::vector<Request>& buffer = this->buffers_[buffer_idx];
+    this->buffer_chunk_[buffer_idx].store(kNoChunk, std::memory_order_release);
+    bool has_more = this->FillChunk(buffer, this->buffer_keys_[buffer_idx]);
+    {
+      std::lock_guard<std::mutex> lock(this->mtx_);
+      size_t produced = chunk * this->chunk_requests_ + buffer.size();
+      this->buffer_chunk_[buffer_idx].store(chunk, std::memory_order_release);
+      this->produced_requests_.store(produced, std::memory_order_release);
+      if (!has_more)
+        this->total_requests_.store(produced, std::memory_order_release);
+    }
+    this->ready_cv_.notify_all();
+    this->next_chunk_++;
+
+    if (!has_more)
+      YCSB_C_LOG_INFO("Trace stream completed: %zu requests, %zu lines in %.3f s, prefetcher waited %.3f s for clients",
+                      this->total_requests_.load(std::memory_order_relaxed), this->line_cnt_,
+                      timer.GetDurationSec(), this->stall_sec_);
+  }
+}
+
+Request* TraceStream::Get(const size_t index)
+{
+  size_t chunk = index / this->chunk_requests_;
+  size_t buffer_idx = chunk % this->buffer_count_;
+  size_t offset = index - chunk * this->chunk_requests_;
+  if (this->buffer_chunk_[buffer_idx].load(std::memory_order_acquire) != chunk)
+  {
+    std::unique_lock<std::mutex> lock(this->mtx_);
+    this->ready_cv_.wait(lock, [&] {
+      return this->buffer_chunk_[buffer_idx].load(std::memory_order_acquire) == chunk ||
+             index >= this->total_requests_.load(std::memory_order_acquire) ||
+             this->stop_.load(std::memory_order_acquire);
+    });
+    if (this->buffer_chunk_[buffer_idx].load(std::memory_order_acquire) != chunk)
+      return nullptr;
+  }
+  std::vector<Request>& buffer = this->buffers_[buffer_idx];
+  return (offset < buffer.size() ? &buffer[offset] : nullptr);
+}
+
+void TraceStream::SetOwner(const size_t thread_count, std::function<size_t(const Request&)> owner)
+{
+  this->owner_ = std::move(owner);
+  this->buffer_owned_.assign(this->buffer_count_, std::vector<std::vector<uint32_t>>(thread_count));
+  for (size_t i = 0; i < this->buffer_count_; i++)
+    this->owned_chunk_[i].store(kNoChunk, std::memory_order_relaxed);
+}
+
+const std::vector<uint32_t>* TraceStream::GetOwned(const size_t index, const size_t thread_id)
+{
+  if (!this->Get(index))
+    return nullptr;
+  // 调用方持有的下标不大于 index，分块在返回的列表使用完之前不会被复用
+  size_t chunk = index / this->chunk_requests_;
+  size_t buffer_idx = chunk % this->buffer_count_;
+  if (this->owned_chunk_[buffer_idx].load(std::memory_order_acquire) != chunk)
+  {
+    std::lock_guard<std::mutex> lock(this->owner_mtx_);
+    if (this->owned_chunk_[buffer_idx].load(std::memory_order_relaxed) != chunk)
+    {
+      std::vector<std::vector<uint32_t>>& owned = this->buffer_owned_[buffer_idx];
+      for (auto& list : owned)
+        list.clear();
+      const std::vector<Request>& buffer = this->buffers_[buffer_idx];
+      for (size_t i = 0; i < buffer.size(); i++)
+        owned[this->owner_(buffer[i])].push_back(static_cast<uint32_t>(i));
+      this->owned_chunk_[buffer_idx].store(chunk, std::memory_order_release);
+    }
+  }
+  return &this->buffer_owned_[buffer_idx][thread_id];
+}
+
+size_t TraceStream::GetRequestCount() const
+{
+  size_t total = this->total_requests_.load(std::memory_order_acquire);
+  return (total != kNoChunk ? total : this->produced_requests_.load(std::memory_order_acquire));
+}
+
+}
@@ -0,0 +1,112 @@
+#ifndef _TWITTER_TRACE_STREAM_H_
+#define _TWITTER_TRACE_STREAM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "twitter_trace_reader.h"
+#include "twitter_trace_source.h"
+
+/**
+ * 流式读取文本 Trace
+ * 后台预取线程按分块提前解析，分块放入固定个数的缓冲区（默认双缓冲）轮流使用，
+ * 客户端线程按全局请求下标取用；所有线程都越过一个分块后其缓冲区才被复用，
+ * 内存占用为 分块请求数 × 缓冲区个数，与 Trace 长度无关，已解析的文件页随即释放。
+ * tracestreaming=true 时启用，tracestreamchunk 为每块请求数，tracestreambuffers 为缓冲区个数（默认 2）。
+ * 压缩或多个文件的 Trace 经 TraceRequestSource 读取（解压在各文件的后台线程中进行）
+ */
+
+namespace module
+{
+
+class TraceStream
+{
+private:
+  const size_t chunk_requests_;
+  const size_t buffer_count_;
+  const char delimiter_;
+  const utils::KeySampler* sampler_;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  size_t limit_lines_ = 0;
+  // 压缩或多文件模式：请求来自 source_，limit_lines_ 按采样前的请求数计
+  std::vector<std::string> source_paths_;
+  bool merge_by_timestamp_ = false;
+  std::unique_ptr<TraceRequestSource> source_;
+
+  // 以下由预取线程推进（Stop 后可安全读写）
+  size_t pos_ = 0;
+  size_t line_cnt_ = 0;
+  size_t released_pos_ = 0;
+  size_t next_chunk_ = 0;
+
+  std::vector<std::vector<Request>> buffers_;
+  // 采样时一次解析的行数按采样率放大，超出分块的请求留给下一块（Key 指向上一块的字典，下一块填充时仍有效）
+  std::vector<Request> carry_;
+  // 各缓冲区分块的 Key 字典，随分块一起复用
+  std::vector<TraceKeyDict> buffer_keys_;
+  // 缓冲区中当前分块的编号，kNoChunk 表示不可用
+  std::unique_ptr<std::atomic<size_t>[]> buffer_chunk_;
+  // 已解析的请求数；读到 Trace 末尾后 total_requests_ 为请求总数
+  std::atomic<size_t> produced_requests_;
+  std::atomic<size_t> total_requests_;
+  std::atomic<bool> stop_;
+  bool no_error_ = true;
+  double stall_sec_ = 0;
+
+  // 客户端线程可能还会访问的最小请求下标
+  std::function<size_t()> low_watermark_;
+  std::thread prefetcher_;
+  // 亲和划分：分块就绪后由第一个取用的客户端线程计算各请求的归属，按线程记录块内下标
+  std::function<size_t(const Request&)> owner_;
+  std::vector<std::vector<std::vector<uint32_t>>> buffer_owned_;
+  // 缓冲区中已整理归属的分块编号
+  std::unique_ptr<std::atomic<size_t>[]> owned_chunk_;
+  std::mutex owner_mtx_;
+  std::mutex mtx_;
+  std::condition_variable ready_cv_;
+
+  void Prefetch();
+  bool FillChunk(std::vector<Request>& buffer, TraceKeyDict& keys);
+  bool FillChunkFromSource(std::vector<Request>& buffer, TraceKeyDict& keys);
+  bool OpenSource();
+
+public:
+  static const size_t kNoChunk = SIZE_MAX;
+
+  TraceStream(const size_t chunk_requests, const size_t buffer_count, const char delimiter = ',',
+              const utils::KeySampler* sampler = nullptr);
+  ~TraceStream();
+
+  // @brief 映射 Trace 文件，limit_lines 为读取行数上限（0 表示不限制）
+  bool Open(const std::string& trace_file_path, const size_t limit_lines);
+  // @brief 打开压缩或多个文本 Trace（拼接或按时间戳归并），limit_requests 为读取请求数上限（采样前）
+  bool Open(const std::vector<std::string>& paths, const bool merge_by_timestamp, const size_t limit_requests);
+  void Start(std::function<size_t()> low_watermark);
+  void Stop();
+  // @brief 从头重放（客户端线程空闲时调用）
+  void Rewind();
+
+  // @brief 等待第 index 条请求就绪；超出 Trace 末尾返回 nullptr
+  Request* Get(const size_t index);
+  // @brief 目前已知的请求数（读到末尾前为已解析的请求数）
+  size_t GetRequestCount() const;
+  size_t GetChunkRequests() const { return this->chunk_requests_; }
+  // @brief 设置亲和划分的归属函数，须在客户端线程取请求前调用
+  void SetOwner(const size_t thread_count, std::function<size_t(const Request&)> owner);
+  // @brief 等待第 index 条请求所在分块就绪，返回其中归属 thread_id 的块内下标（升序）；超出末尾返回 nullptr
+  const std::vector<uint32_t>* GetOwned(const size_t index, const size_t thread_id);
+  bool NoError() const { return this->no_error_; }
+};
+
+}
+
+#endif
@@ -10,27 +10,79 @@ import matplotlib.patches as mpatches
 
 # global
 workload = ""
+# 空间采样率（见 {workload}_sampling.csv），Key 数按 1 / sample_rate 还原为全量估计
+sample_rate = 1.0
 
 def read_key_stats_file(file_name: str, col_names: list):
     df = pd.read_csv(file_name, header = None, names = col_names)
     # print(df)
     return df
 
+"""
+读取二进制列式输出（keystatsformat=binary，格式见 KeyStatsDB::SetBinaryOutput），
+各列直接 memmap，不解析文本、不复制；Key 以 _key_stats.bin 中的行号表示
+"""
+KEY_STATS_MAGIC = b"YCSBKST1"
+HOT_KEYS_MAGIC = b"YCSBHOT1"
+
+def read_key_stats_binary(file_name: str):
+    header = np.fromfile(file_name, dtype = '<u8', count = 8)
+    if header[:1].tobytes() != KEY_STATS_MAGIC:
+        raise ValueError(f"{file_name} is not a key_stats binary file")
+    rows, hot_rows = int(header[1]), int(header[2])
+    column = lambda i, dtype: np.memmap(file_name, dtype = dtype, mode = 'r', offset = 64 + 8 * rows * i, shape = (rows,))
+    counts = column(1, '<i8')
+    ranks = column(2, '<u8')
+    # 行按字典序（或 Key id）排列，按名次散布即得降序计数
+    descend = np.empty(rows, dtype = np.int64)
+    descend[ranks] = counts
+    # 真实热 Key：名次在前 hot_rows 的行
+    hot_keys = np.flatnonzero(ranks < hot_rows)
+    return counts, descend, hot_keys
+
+def read_hotkeys_binary(file_name: str):
+    header = np.fromfile(file_name, dtype = '<u8', count = 2)
+    if header[:1].tobytes() != HOT_KEYS_MAGIC:
+        raise ValueError(f"{file_name} is not a hot-key binary file")
+    rows = np.memmap(file_name, dtype = '<i8', mode = 'r', offset = 16, shape = (int(header[1]),))
+    # 不在统计中的 Key 均为 -1，换成互不相同的负数，集合运算时不合并
+    if (rows < 0).any():
+        rows = np.where(rows < 0, -1 - np.arange(len(rows)), rows)
+    return rows
+
+"""
+读取真实热 Key 与各热识别模块的热 Key：CSV 时为 Key 字符串，二进制时为行号
+"""
+def read_hotkeys(file_name: str):
+    if file_name.endswith(".bin"):
+        return read_hotkeys_binary(file_name)
+    return read_key_stats_file(file_name, ["Keys"])["Keys"].values
+
+"""
+读取采样率，未采样时没有该文件
+"""
+def read_sample_rate(file_name: str):
+    if not os.path.exists(file_name):
+        return 1.0
+    df = pd.read_csv(file_name)
+    rate = float(df["sample_rate"].values[0])
+    print(f"Sample rate: {rate}, estimated full-trace keys: {df['estimated_keys'].values[0]}, "
+          f"accesses: {df['estimated_accesses'].values[0]}")
+    return rate
+
 """
 绘制频率曲线
 """
-def plot_frequency_line(input_file_name: str, output_file_name: str, partial = False):
-    df = read_key_stats_file(input_file_name, ["Keys", "Frequencies"])
+def plot_frequency_line(frequencies, output_file_name: str, partial = False):
+    # 横轴为 Key 的序号（刻度隐藏）
+    keys = np.arange(len(frequencies))
     # 截取前 N% 数据
     if (partial):
-        total_rows = len(df)
+        total_rows = len(frequencies)
         n = int(total_rows * 0.0001)
         n = max(1, n)
-        keys = df["Keys"].values[:n]
-        frequencies = df["Frequencies"].values[:n]
-    else:
-        keys = df["Keys"].values
-        frequencies = df["Frequencies"].values
+        keys = keys[:n]
+        frequencies = frequencies[:n]
     plt.figure(figsize = (12, 6))
     plt.plot(keys, frequencies, linestyle = '-', color = 'b')
     plt.xticks([])
@@ -66,13 +118,12 @@ def plot_frequency_line(input_file_name: str, output_file_name: str, partial = F
 """
 计算召回率、准确率
 """
-def calculate_hotkeys_coverage(groundtruth_file_name: str, result_file_name: str, algo_name: str):
-    df_gt = read_key_stats_file(groundtruth_file_name, ["Keys"])
-    df_result = read_key_stats_file(result_file_name, ["Keys"])
+def calculate_hotkeys_coverage(gt_keys, result_keys, algo_name: str):
+    is_hot = np.isin(result_keys, gt_keys)
     # 覆盖率表示有多少热键能被识别
-    recall = (df_result["Keys"].isin(df_gt["Keys"]).sum() / len(df_gt)) * 100
+    recall = (is_hot.sum() / len(gt_keys)) * 100
     # 查准率表示被识别为热键的正确率
-    precision = df_result["Keys"].isin(df_gt["Keys"]).mean() * 100
+    precision = is_hot.mean() * 100
 
     print(f"{algo_name}: \n - Recall: {recall:.2f}%\n - Precision: {precision:.2f}%")
     return recall, precision
@@ -84,20 +135,20 @@ color_green = '#4CAF50'
 """
 绘制堆叠分组条形图
 """
-def plot_stacked_barchart(groundtruth_file_name: str, algorithms: list):
-    df_gt = read_key_stats_file(groundtruth_file_name, ["Keys"])
-    gt_total = len(df_gt)
+def plot_stacked_barchart(gt_keys, algorithms: list, results: dict):
+    # 采样时召回率、准确率为比值无需还原，Key 数按采样率放大为全量估计
+    scale = 1.0 / sample_rate
+    gt_total = round(len(gt_keys) * scale)
 
     data = {'hit': [], 'miss': [], 'false': [], 'Total': gt_total}
     for algo in algorithms:
-        result_file = f"./{workload}_hotkeys_{algo}.csv"
-        df_result = read_key_stats_file(result_file, ["Keys"])
+        result_keys = results[algo]
         # 正确识别的热键
-        hit = df_result["Keys"].isin(df_gt["Keys"]).sum()
+        hit = round(np.isin(result_keys, gt_keys).sum() * scale)
         # 未识别的真实热键
         miss = gt_total - hit
         # 错误识别的热键
-        false = len(df_result) - hit
+        false = round(len(result_keys) * scale) - hit
         data['hit'].append(hit)
         data['miss'].append(miss)
         data['false'].append(false)
@@ -136,7 +187,10 @@ def plot_stacked_barchart(groundtruth_file_name: str, algorithms: list):
     # 添加标题和标签
     plt.title('Stacked Comparison of Different Algorithms', fontsize = 16, pad = 20)
     # plt.xlabel('Algorithms', fontsize = 12, labelpad = 10)
-    plt.ylabel('Key Count', fontsize = 12, labelpad = 10)
+    if sample_rate < 1.0:
+        plt.ylabel(f'Key Count (estimated from {sample_rate:.2%} sample)', fontsize = 12, labelpad = 10)
+    else:
+        plt.ylabel('Key Count', fontsize = 12, labelpad = 10)
     plt.xticks(x, algorithms, fontsize = 12)
     plt.ylim(0, max([sum(values) for values in zip(data['hit'], data['miss'], data['false'])]) * 1.2)
     legend_labels = [
@@ -164,11 +218,9 @@ def plot_stacked_barchart(groundtruth_file_name: str, algorithms: list):
 """
 绘制韦恩图展示集合关系
 """
-def plot_venn_diagram(groundtruth_file: str, result_file: str, algo_name: str):
-    df_gt = read_key_stats_file(groundtruth_file, ["Keys"])
-    df_result = read_key_stats_file(result_file, ["Keys"])
-    set_gt = set(df_gt["Keys"])
-    set_result = set(df_result["Keys"])
+def plot_venn_diagram(gt_keys, result_keys, algo_name: str):
+    set_gt = set(gt_keys.tolist())
+    set_result = set(result_keys.tolist())
     plt.figure(figsize=(8, 8))
     left_color = color_yellow
     right_color = color_red
@@ -188,7 +240,33 @@ def plot_venn_diagram(groundtruth_file: str, result_file: str, algo_name: str):
     for text in venn.subset_labels:
         if text: text.set_fontsize(12)
     plt.savefig(f'{workload}_venn_{algo_name}.png', dpi=300)
-    print(f"{algo}'s Venn Figure is generated")
+    print(f"{algo_name}'s Venn Figure is generated")
+
+
+"""
+绘制容量曲线：LRU 命中率，以及各热识别模块的准确率、召回率随容量的变化（keystatscurve=true 时输出）
+"""
+def plot_capacity_curves(mrc_file_name: str, curve_file_name: str):
+    if not os.path.exists(mrc_file_name) or not os.path.exists(curve_file_name):
+        return
+    df_mrc = pd.read_csv(mrc_file_name)
+    df_curve = pd.read_csv(curve_file_name)
+    fig, axes = plt.subplots(1, 3, figsize = (18, 5))
+    axes[0].plot(df_mrc["capacity"], df_mrc["hit_ratio"], color = 'b')
+    axes[0].set_title("LRU Hit Ratio", fontsize = 14)
+    for ax, metric in zip(axes[1:], ["precision", "recall"]):
+        for name, group in df_curve.groupby("separator"):
+            ax.plot(group["capacity"], group[metric], marker = 'o', label = name)
+        ax.set_title(f"Hot Key {metric.capitalize()}", fontsize = 14)
+        ax.legend(fontsize = 10)
+    for ax in axes:
+        ax.set_xscale("log")
+        ax.set_xlabel("Capacity (keys)", fontsize = 12)
+        ax.set_ylim(0, 1.05)
+        ax.grid(True, linestyle = '--', alpha = 0.7)
+    plt.tight_layout()
+    plt.savefig(f'{workload}_capacity_curves.png', dpi = 300)
+    print("Capacity Curves are generated")
 
 
 if __name__ == '__main__':
@@ -200,24 +278,30 @@ if __name__ == '__main__':
     # 该前缀必须与 workload 相同，比如 workloada.spec --> workloada
     workload = str(sys.argv[1])
     print("Workload prefix:", workload)
+    sample_rate = read_sample_rate(f"./{workload}_sampling.csv")
 
     algorithms = ["lru", "lfu", "lruk", "window", "sketch_window", "w_tinylfu", "lirs"]
-    
+
+    # keystatsformat=binary 时读取列式输出，否则读取 CSV
+    binary_file = f"./{workload}_key_stats.bin"
+    if os.path.exists(binary_file):
+        dict_ordered, descend, gt_keys = read_key_stats_binary(binary_file)
+        suffix = "bin"
+    else:
+        dict_ordered = read_key_stats_file(f"./{workload}_key_stats_dict_ordered.csv", ["Keys", "Frequencies"])["Frequencies"].values
+        descend = read_key_stats_file(f"./{workload}_key_stats_descend.csv", ["Keys", "Frequencies"])["Frequencies"].values
+        gt_keys = read_hotkeys(f"./{workload}_key_stats_hotkeys.csv")
+        suffix = "csv"
+    results = {algo: read_hotkeys(f"./{workload}_hotkeys_{algo}.{suffix}") for algo in algorithms}
+
     for algo in algorithms:
         # 计算召回、准确率
-        recall, precision = calculate_hotkeys_coverage(
-            f"./{workload}_key_stats_hotkeys.csv", 
-            f"./{workload}_hotkeys_{algo}.csv", 
-            algo
-        )
+        recall, precision = calculate_hotkeys_coverage(gt_keys, results[algo], algo)
         # 绘制韦恩图查看交集
-        plot_venn_diagram(
-            f"./{workload}_key_stats_hotkeys.csv",
-            f"./{workload}_hotkeys_{algo}.csv",
-            algo
-        )
+        plot_venn_diagram(gt_keys, results[algo], algo)
     # 绘制堆叠条形图
-    plot_stacked_barchart(f"./{workload}_key_stats_hotkeys.csv", algorithms)
+    plot_stacked_barchart(gt_keys, algorithms, results)
     
-    plot_frequency_line(f"./{workload}_key_stats_dict_ordered.csv", f"{workload}_key_frequency.png", False)
-    plot_frequency_line(f"./{workload}_key_stats_descend.csv", f"{workload}_frequency_descend.png", False)
\ No newline at end of file
+    plot_frequency_line(dict_ordered, f"{workload}_key_frequency.png", False)
+    plot_frequency_line(descend, f"{workload}_frequency_descend.png", False)
+    plot_capacity_curves(f"./{workload}_mrc.csv", f"./{workload}_capacity_curve.csv")
\ No newline at end of file
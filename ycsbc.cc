@@ -21,6 +21,9 @@
 #include "db/db_factory.h"
 #include "db/keystats_db.h"
 #include "core/twitter_trace_workload.h"
+#include "core/trace_fitted_workload.h"
+#include "core/op_stream.h"
+#include "core/tenant_set.h"
 
 using namespace std;
 
@@ -30,13 +33,35 @@ string ParseCommandLine(int argc, const char *argv[], utils::Properties &props);
 
 static bool g_enable_hotspot = false;
 
+// 保序重放 Trace 时各线程的操作数不固定，领完本阶段的请求即结束
+inline bool HasNextOp(ycsbc::CoreWorkload *wl, const size_t i, const size_t num_ops,
+    size_t thread_id) {
+#ifdef TWITTER_TRACE
+  auto t_wl = static_cast<ycsbc::TwitterTraceWorkload*>(wl);
+  if (t_wl->ordered_replay())
+    return t_wl->HasNextRequest(thread_id);
+#endif
+  return i < num_ops;
+}
+
+// 按时间戳重放 Trace 时等到请求的计划时刻，等待不计入延迟
+inline void WaitForSchedule(ycsbc::CoreWorkload *wl, size_t thread_id) {
+#ifdef TWITTER_TRACE
+  auto t_wl = static_cast<ycsbc::TwitterTraceWorkload*>(wl);
+  if (t_wl->timed_replay())
+    t_wl->WaitForSchedule(thread_id);
+#endif
+}
+
 size_t DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const size_t num_ops,
     bool is_loading, shared_ptr<Histogram> hist, size_t thread_id) {
   db->Init();
   ycsbc::Client client(*db, wl);
   size_t oks = 0;
   utils::Timer timer;
-  for (size_t i = 0; i < num_ops; ++i) {
+  for (size_t i = 0; HasNextOp(wl, i, num_ops, thread_id); ++i) {
+    if (!is_loading)
+      WaitForSchedule(wl, thread_id);
     timer.Reset();
     if (is_loading) {
       oks += client.DoInsert(thread_id);
@@ -53,6 +78,112 @@ size_t DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const size_t num_o
   return oks;
 }
 
+#ifdef TWITTER_TRACE
+// 去重 Load 的第二遍：合并第 thread_id 个分片并插入其中的不同 Key
+size_t DelegateLoadKeysClient(ycsbc::DB *db, ycsbc::TwitterTraceWorkload *wl,
+    shared_ptr<Histogram> hist, size_t thread_id) {
+  db->Init();
+  ycsbc::Client client(*db, wl);
+  size_t oks = 0;
+  utils::Timer timer;
+  for (const auto &load_key : wl->MergeLoadKeys(thread_id)) {
+    timer.Reset();
+    oks += client.DoLoadKey(load_key);
+    hist->Add(timer.GetDurationUs());
+
+    if (oks % 100000 == 0)
+      std::cout << "oks: " << oks << std::endl;
+  }
+  return oks;
+}
+#endif
+
+size_t DelegateReplayClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl,
+    const ycsbc::OpStream *stream, ycsbc::OpStream::Phase phase,
+    shared_ptr<Histogram> hist, size_t thread_id) {
+  db->Init();
+  ycsbc::Client client(*db, wl);
+  size_t num_ops = 0;
+  const ycsbc::OpRecord *records = stream->Records(thread_id, phase, &num_ops);
+  size_t oks = 0;
+  utils::Timer timer;
+  for (size_t i = 0; i < num_ops; ++i) {
+    timer.Reset();
+    oks += client.DoRecord(records[i]);
+    double duration = timer.GetDurationUs();
+    hist->Add(duration);
+
+    if (oks % 100000 == 0)
+      std::cout << "oks: " << oks << std::endl;
+  }
+  return oks;
+}
+
+// 多租户：每个线程为每个租户持有一个 Client，按租户分别统计延迟与成功数
+size_t DelegateTenantClient(ycsbc::DB *db, ycsbc::TenantSet *tenants,
+    bool is_loading, shared_ptr<Histogram> hist,
+    vector<shared_ptr<Histogram>> tenant_hists,
+    shared_ptr<vector<size_t>> tenant_oks, size_t thread_id) {
+  db->Init();
+  vector<unique_ptr<ycsbc::Client>> clients;
+  for (size_t t = 0; t < tenants->size(); ++t)
+    clients.emplace_back(new ycsbc::Client(*db, tenants->tenant(t).workload.get()));
+  size_t oks = 0;
+  utils::Timer timer;
+  auto do_op = [&](size_t t) {
+    timer.Reset();
+    bool ok = is_loading ? clients[t]->DoInsert(thread_id)
+                         : clients[t]->DoTransaction(thread_id);
+    double duration = timer.GetDurationUs();
+    hist->Add(duration);
+    tenant_hists[t]->Add(duration);
+    (*tenant_oks)[t] += ok;
+    oks += ok;
+
+    if (oks % 100000 == 0)
+      std::cout << "oks: " << oks << std::endl;
+  };
+  if (is_loading) {
+    for (size_t t = 0; t < tenants->size(); ++t) {
+      for (uint64_t i = 0; i < tenants->LoadOperations(t); ++i)
+        do_op(t);
+    }
+  } else {
+    uint64_t num_ops = tenants->RunOperations(thread_id);
+    for (uint64_t i = 0; i < num_ops; ++i)
+      do_op(tenants->dedicated() ? tenants->ThreadTenant(thread_id)
+                                 : tenants->PickTenant());
+  }
+  return oks;
+}
+
+vector<shared_ptr<Histogram>> NewTenantHists(size_t num_tenants) {
+  vector<shared_ptr<Histogram>> hists;
+  for (size_t t = 0; t < num_tenants; ++t) {
+    hists.emplace_back(make_shared<Histogram>());
+    hists.back()->Clear();
+  }
+  return hists;
+}
+
+void ReportTenants(const ycsbc::TenantSet &tenants,
+    const vector<vector<shared_ptr<Histogram>>> &tenant_hists,
+    const vector<shared_ptr<vector<size_t>>> &tenant_oks) {
+  for (size_t t = 0; t < tenants.size(); ++t) {
+    Histogram hist;
+    hist.Clear();
+    size_t oks = 0;
+    for (size_t i = 0; i < tenant_hists.size(); ++i) {
+      hist.Merge(*tenant_hists[i][t]);
+      oks += (*tenant_oks[i])[t];
+    }
+    const auto &tenant = tenants.tenant(t);
+    cout << "# " << tenant.name << " (" << tenant.workload->key_format().prefix
+         << ", weight " << tenant.weight << ") oks: " << oks << "  "
+         << hist.Summary() << endl;
+  }
+}
+
 int main(const int argc, const char *argv[]) {
 #ifdef TWITTER_TRACE
   YCSB_C_LOG_INFO("TWITTER_TRACE mode is enabled");
@@ -73,17 +204,125 @@ int main(const int argc, const char *argv[]) {
     keystats_db->SetWorkloadFileName(file_name);
     if (g_enable_hotspot)
       keystats_db->SetHotspotEnabled(g_enable_hotspot);
+    // 按 Trace 序号在窗口内恢复请求顺序后再交给热识别模块
+    keystats_db->SetReorderWindow(std::stoull(props.GetProperty("keystatsreorderwindow", "0")));
+    // 容量曲线：LRU 命中率与各热识别模块的准确率、召回率随容量的变化
+    keystats_db->SetCapacityCurve(utils::StrToBool(props.GetProperty("keystatscurve", "false")));
+    // 统计输出格式：csv（默认）或 binary（列式，numpy 可直接 memmap）
+    const string stats_format = props.GetProperty("keystatsformat", "csv");
+    if (stats_format != "csv" && stats_format != "binary")
+    {
+      cout << "Unknown keystatsformat " << stats_format << ", expected csv or binary" << endl;
+      exit(0);
+    }
+    keystats_db->SetBinaryOutput(stats_format == "binary");
   }
 
-  const int num_threads = stoi(props.GetProperty("threadcount", "1"));
+  int num_threads = stoi(props.GetProperty("threadcount", "1"));
   
   ycsbc::CoreWorkload *wl = nullptr;
 #ifdef TWITTER_TRACE
   wl = new ycsbc::TwitterTraceWorkload((size_t)num_threads);
 #else
-  wl = new ycsbc::CoreWorkload();
+  if (props.GetProperty("workload") == ycsbc::TraceFittedWorkload::WORKLOAD_NAME)
+    wl = new ycsbc::TraceFittedWorkload();
+  else
+    wl = new ycsbc::CoreWorkload();
 #endif
   wl->Init(props);
+  // 空间采样：热识别模块的容量随采样率缩小
+  if (props["dbname"] == "keystats")
+    static_cast<ycsbc::KeyStatsDB*>(db)->SetSampleRate(wl->sampler().rate());
+#ifndef TWITTER_TRACE
+  // 拟合出的 key 空间整体加载
+  if (auto fitted = dynamic_cast<ycsbc::TraceFittedWorkload*>(wl))
+    props.SetProperty(ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY,
+                      std::to_string(fitted->key_space()));
+#endif
+  // Backends that store string keys format integer key ids the same way
+  db->SetKeyFormat(wl->key_format());
+  // 十亿级 Key：keystats 以 Key id 直接索引的紧凑数组计数，覆盖加载与预计插入的 Key
+  if (props["dbname"] == "keystats" && props.GetProperty("keystatscounting", "map") == "lean")
+  {
+    if (!wl->integer_keys())
+    {
+      cout << "Lean key counting needs keytype=integer" << endl;
+      exit(0);
+    }
+    uint64_t record_count = std::stoull(props.GetProperty(ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY));
+    uint64_t operation_count = std::stoull(props.GetProperty(ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY));
+    double insert_proportion = std::stod(props.GetProperty(ycsbc::CoreWorkload::INSERT_PROPORTION_PROPERTY,
+                                                           ycsbc::CoreWorkload::INSERT_PROPORTION_DEFAULT));
+    static_cast<ycsbc::KeyStatsDB*>(db)->SetLeanCounting(record_count + operation_count * insert_proportion);
+  }
+
+  // Multi-tenant runs: one workload per tenant spec
+  ycsbc::TenantSet tenants;
+#ifdef TWITTER_TRACE
+  const bool multi_tenant = false;
+  if (props.GetProperty(ycsbc::TenantSet::TENANT_COUNT_PROPERTY, "0") != "0") {
+    cout << "Multiple tenants are not supported in TWITTER_TRACE mode" << endl;
+    exit(0);
+  }
+#else
+  const bool multi_tenant = tenants.Init(props, num_threads);
+  if (multi_tenant)
+    db->SetTenantKeyFormats(tenants.key_formats());
+#endif
+
+  // Pre-materialized operation streams
+  const string write_ops_file = props.GetProperty(ycsbc::OpStream::WRITE_FILE_PROPERTY);
+  const string replay_ops_file = props.GetProperty(ycsbc::OpStream::REPLAY_FILE_PROPERTY);
+#ifdef TWITTER_TRACE
+  if (!write_ops_file.empty() || !replay_ops_file.empty()) {
+    cout << "Operation streams are not supported in TWITTER_TRACE mode" << endl;
+    exit(0);
+  }
+#endif
+  if (multi_tenant && (!write_ops_file.empty() || !replay_ops_file.empty())) {
+    cout << "Operation streams are not supported with multiple tenants" << endl;
+    exit(0);
+  }
+  // 热 Key 突发只叠加在主 workload 的实时取 Key 上
+  const bool bursts = wl->bursts().size() > 0;
+#ifdef TWITTER_TRACE
+  if (bursts) {
+    cout << "Bursts are not supported in TWITTER_TRACE mode" << endl;
+    exit(0);
+  }
+#endif
+  if (bursts && (multi_tenant || !write_ops_file.empty() || !replay_ops_file.empty())) {
+    cout << "Bursts are not supported with multiple tenants or operation streams" << endl;
+    exit(0);
+  }
+  if (bursts && props["dbname"] == "keystats")
+    static_cast<ycsbc::KeyStatsDB*>(db)->SetBursts(&wl->bursts());
+  if (!write_ops_file.empty()) {
+    utils::Timer write_timer;
+    if (!ycsbc::OpStream::Write(write_ops_file, *wl, num_threads,
+            wl->load_count(),
+            wl->sampler().Scale(std::stoull(props.GetProperty(ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY))))) {
+      exit(EXIT_FAILURE);
+    }
+    cout << "# Op stream written to " << write_ops_file << " for " << num_threads
+         << " threads (sec): " << write_timer.GetDurationSec() << endl;
+    delete wl;
+    delete db;
+    return 0;
+  }
+  ycsbc::OpStream op_stream;
+  const bool replay_ops = !replay_ops_file.empty();
+  if (replay_ops) {
+    if (!op_stream.Open(replay_ops_file)) {
+      exit(EXIT_FAILURE);
+    }
+    if ((size_t)num_threads != op_stream.thread_count()) {
+      cout << "Op stream is partitioned for " << op_stream.thread_count()
+           << " threads, using that instead of " << num_threads << endl;
+      num_threads = op_stream.thread_count();
+    }
+    cout << "Replaying op stream: " << replay_ops_file << endl;
+  }
 
   // print some infos
 #ifdef TWITTER_TRACE
@@ -95,6 +334,23 @@ int main(const int argc, const char *argv[]) {
   std::cout << "zero_padding: " << props.GetProperty(ycsbc::CoreWorkload::ZERO_PADDING_PROPERTY, ycsbc::CoreWorkload::ZERO_PADDING_DEFAULT) << std::endl;
   std::cout << "record_count: " << props.GetProperty(ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY) << std::endl;
   std::cout << "operation_count: " << props.GetProperty(ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY) << std::endl;
+  std::cout << "keytype: " << props.GetProperty(ycsbc::CoreWorkload::KEY_TYPE_PROPERTY, ycsbc::CoreWorkload::KEY_TYPE_DEFAULT) << std::endl;
+  if (multi_tenant) {
+    std::cout << "tenants: " << tenants.size() << " ("
+              << (tenants.dedicated() ? "dedicated" : "interleave") << " threads)" << std::endl;
+    for (size_t t = 0; t < tenants.size(); ++t) {
+      const auto &tenant = tenants.tenant(t);
+      std::cout << "  " << tenant.name << ": keyprefix " << tenant.workload->key_format().prefix
+                << ", weight " << tenant.weight << ", record_count " << tenant.record_count
+                << ", operation_count " << tenant.operation_count << std::endl;
+    }
+  }
+  for (size_t i = 0; i < wl->bursts().size(); ++i) {
+    const auto &burst = wl->bursts().burst(i);
+    std::cout << "burst " << i << ": " << ycsbc::BurstInjector::KindName(burst.kind)
+              << " key " << burst.key_num << ", start " << burst.start << ", ops " << burst.ops
+              << ", fraction " << burst.fraction << std::endl;
+  }
 #endif
 
   vector<shared_ptr<Histogram>> hists;
@@ -102,19 +358,59 @@ int main(const int argc, const char *argv[]) {
   utils::Timer timer;
   timer.Reset();
   vector<future<size_t>> actual_ops;
+  vector<vector<shared_ptr<Histogram>>> tenant_hists;
+  vector<shared_ptr<vector<size_t>>> tenant_oks;
   size_t total_ops;
 #ifdef TWITTER_TRACE
+  // 去重 Load 时第一遍取到的 Trace 请求数
+  size_t load_requests = 0;
+  bool load_dedup = false;
   total_ops = ((ycsbc::TwitterTraceWorkload*)wl)->GetRecordCount();
+  ((ycsbc::TwitterTraceWorkload*)wl)->SetPhaseRequests(total_ops);
+  load_dedup = ((ycsbc::TwitterTraceWorkload*)wl)->load_dedup();
+  if (load_dedup) {
+    // 第一遍：各线程并行取完本阶段的请求，按 Key 哈希分片收集不同 Key 及其最大 value 大小
+    vector<future<size_t>> collected;
+    for (int i = 0; i < num_threads; ++i) {
+      collected.emplace_back(async(launch::async, &ycsbc::TwitterTraceWorkload::CollectLoadKeys,
+          (ycsbc::TwitterTraceWorkload*)wl, static_cast<size_t>(i), total_ops / num_threads));
+    }
+    for (auto &n : collected)
+      load_requests += n.get();
+    cout << "# Load key collection (sec): " << timer.GetDurationSec() << endl;
+  }
 #else
-  total_ops = std::stoul(props.GetProperty(ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY));
+  total_ops = wl->load_count();
+  if (replay_ops)
+    total_ops = op_stream.TotalRecords(ycsbc::OpStream::kLoad);
+  if (multi_tenant) {
+    total_ops = 0;
+    for (size_t t = 0; t < tenants.size(); ++t)
+      total_ops += tenants.LoadOperations(t) * num_threads;
+  }
 #endif
   for (int i = 0; i < num_threads; ++i) {
     auto hist = make_shared<Histogram>();
     hist->Clear();
     hists.emplace_back(hist);
     // 传入 thread_id
-    actual_ops.emplace_back(async(launch::async,
-        DelegateClient, db, wl, total_ops / num_threads, true, hist, static_cast<size_t>(i)));
+    if (multi_tenant) {
+      tenant_hists.emplace_back(NewTenantHists(tenants.size()));
+      tenant_oks.emplace_back(make_shared<vector<size_t>>(tenants.size(), 0));
+      actual_ops.emplace_back(async(launch::async,
+          DelegateTenantClient, db, &tenants, true, hist, tenant_hists.back(), tenant_oks.back(), static_cast<size_t>(i)));
+    } else if (replay_ops) {
+      actual_ops.emplace_back(async(launch::async,
+          DelegateReplayClient, db, wl, &op_stream, ycsbc::OpStream::kLoad, hist, static_cast<size_t>(i)));
+#ifdef TWITTER_TRACE
+    } else if (load_dedup) {
+      actual_ops.emplace_back(async(launch::async,
+          DelegateLoadKeysClient, db, (ycsbc::TwitterTraceWorkload*)wl, hist, static_cast<size_t>(i)));
+#endif
+    } else {
+      actual_ops.emplace_back(async(launch::async,
+          DelegateClient, db, wl, total_ops / num_threads, true, hist, static_cast<size_t>(i)));
+    }
   }
   assert(actual_ops.size() == (size_t)num_threads);
 
@@ -131,10 +427,21 @@ int main(const int argc, const char *argv[]) {
   }
   cout << "\n" << props["dbname"] << '\t' << file_name << '\t' << num_threads << '\n';
   cout << "# Load duration (sec): " << duration / 1000.0 << endl;
+#ifdef TWITTER_TRACE
+  if (load_dedup) {
+    size_t unique_keys = ((ycsbc::TwitterTraceWorkload*)wl)->load_unique_keys();
+    cout << "# Load trace requests:\t" << load_requests << endl;
+    cout << "# Loading unique keys:\t" << unique_keys << " ("
+         << (load_requests ? 100.0 * unique_keys / load_requests : 0) << "% of requests)" << endl;
+    total_ops = unique_keys;
+  }
+#endif
   cout << "# Loading records:\t" << sum << endl;
   cout << "# Load throughput (KOPS): ";
   cout << total_ops / duration << endl;
   cout << hists[0]->ToString() << endl;
+  if (multi_tenant)
+    ReportTenants(tenants, tenant_hists, tenant_oks);
 
   // // Load 与 Run 之间停 3 秒
   std::cout << "Waiting 3s before performing transactions......" << std::endl;
@@ -145,20 +452,42 @@ int main(const int argc, const char *argv[]) {
   // Peforms transactions
   hists.clear();
   actual_ops.clear();
+  tenant_hists.clear();
+  tenant_oks.clear();
 #ifdef TWITTER_TRACE
   total_ops = ((ycsbc::TwitterTraceWorkload*)wl)->GetOperationCount();
   // 使 Reader 迭代器归位
   ((ycsbc::TwitterTraceWorkload*)wl)->ResetIterator();
+  ((ycsbc::TwitterTraceWorkload*)wl)->SetPhaseRequests(total_ops);
+  if (((ycsbc::TwitterTraceWorkload*)wl)->timed_replay())
+    ((ycsbc::TwitterTraceWorkload*)wl)->StartReplayClock();
 #else
-  total_ops = std::stoul(props.GetProperty(ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY));
+  total_ops = wl->sampler().Scale(std::stoull(props.GetProperty(ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY)));
+  if (replay_ops)
+    total_ops = op_stream.TotalRecords(ycsbc::OpStream::kRun);
+  if (multi_tenant) {
+    total_ops = 0;
+    for (int i = 0; i < num_threads; ++i)
+      total_ops += tenants.RunOperations(i);
+  }
 #endif
   timer.Reset();
   for (int i = 0; i < num_threads; ++i) {
     auto hist = make_shared<Histogram>();
     hist->Clear();
     hists.emplace_back(hist);
-    actual_ops.emplace_back(async(launch::async,
-        DelegateClient, db, wl, total_ops / num_threads, false, hist, static_cast<size_t>(i)));
+    if (multi_tenant) {
+      tenant_hists.emplace_back(NewTenantHists(tenants.size()));
+      tenant_oks.emplace_back(make_shared<vector<size_t>>(tenants.size(), 0));
+      actual_ops.emplace_back(async(launch::async,
+          DelegateTenantClient, db, &tenants, false, hist, tenant_hists.back(), tenant_oks.back(), static_cast<size_t>(i)));
+    } else if (replay_ops) {
+      actual_ops.emplace_back(async(launch::async,
+          DelegateReplayClient, db, wl, &op_stream, ycsbc::OpStream::kRun, hist, static_cast<size_t>(i)));
+    } else {
+      actual_ops.emplace_back(async(launch::async,
+          DelegateClient, db, wl, total_ops / num_threads, false, hist, static_cast<size_t>(i)));
+    }
   }
   assert(actual_ops.size() == (size_t)num_threads);
 
@@ -177,7 +506,13 @@ int main(const int argc, const char *argv[]) {
   cout << "# Run operations:\t" << sum << endl;
   cout << "# Run throughput (KOPS): ";
   cout << total_ops / duration << endl;
+#ifdef TWITTER_TRACE
+  if (((ycsbc::TwitterTraceWorkload*)wl)->timed_replay())
+    ((ycsbc::TwitterTraceWorkload*)wl)->ReportReplaySlippage(cout);
+#endif
   cout << hists[0]->ToString() << endl;
+  if (multi_tenant)
+    ReportTenants(tenants, tenant_hists, tenant_oks);
   
   // Key 统计功能、显式转换后输出到文件
   if (props["dbname"] == "keystats" && g_enable_hotspot)
@@ -268,6 +603,29 @@ string ParseCommandLine(int argc, const char *argv[], utils::Properties &props)
         props.SetProperty("operationcount", argv[argindex]);
         argindex++;
     }
+    // 写出 / 回放预生成的操作流
+    else if (strcmp(argv[argindex], "-writeops") == 0)
+    {
+        argindex++;
+        if (argindex >= argc)
+        {
+            UsageMessage(argv[0]);
+            exit(0);
+        }
+        props.SetProperty(ycsbc::OpStream::WRITE_FILE_PROPERTY, argv[argindex]);
+        argindex++;
+    }
+    else if (strcmp(argv[argindex], "-replayops") == 0)
+    {
+        argindex++;
+        if (argindex >= argc)
+        {
+            UsageMessage(argv[0]);
+            exit(0);
+        }
+        props.SetProperty(ycsbc::OpStream::REPLAY_FILE_PROPERTY, argv[argindex]);
+        argindex++;
+    }
     else if (strcmp(argv[argindex], "-host") == 0) {
       argindex++;
       if (argindex >= argc) {
@@ -334,6 +692,8 @@ void UsageMessage(const char *command) {
   cout << "  Be sure that the two following args are after the \'-P\'" << endl;
   cout << "  -fieldlength: specify the fieldlength, cover the attribute in workload file" << endl;
   cout << "  -recordcount: specify the recordcount, cover the attribute in workload file" << endl;
+  cout << "  -writeops file: write the operation stream of the workload for -threads n to file and exit" << endl;
+  cout << "  -replayops file: replay an operation stream written by -writeops instead of generating operations" << endl;
 }
 
 inline bool StrStartWith(const char *str, const char *pre) {